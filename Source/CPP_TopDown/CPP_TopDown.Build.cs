@@ -20,10 +20,11 @@ public class CPP_TopDown : ModuleRules
 			"GameplayStateTreeModule",
 			"Niagara",
 			"GameplayTasks",
-			"UMG"
+			"UMG",
+			"MassEntity"
 		});
 
-		PrivateDependencyModuleNames.AddRange(new string[] { });
+		PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore" });
 
 		PublicIncludePaths.AddRange(new string[] {
 			"CPP_TopDown",
@@ -6,4 +6,15 @@
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CPP_TopDown, "CPP_TopDown" );
 
 DEFINE_LOG_CATEGORY(LogCPP_TopDown)
- 
\ No newline at end of file
+
+DEFINE_STAT(STAT_WizardDungeon_ActiveSpells);
+DEFINE_STAT(STAT_WizardDungeon_LiveEnemies);
+DEFINE_STAT(STAT_WizardDungeon_DamageEvents);
+
+UE_TRACE_CHANNEL_DEFINE(WizardDungeonChannel);
+
+LLM_DEFINE_TAG(WizardDungeon_SpellPools);
+LLM_DEFINE_TAG(WizardDungeon_EnemyWidgets);
+LLM_DEFINE_TAG(WizardDungeon_DynamicMaterials);
+LLM_DEFINE_TAG(WizardDungeon_Perception);
+LLM_DEFINE_TAG(WizardDungeon_BehaviorTrees);
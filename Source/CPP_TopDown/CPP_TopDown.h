@@ -3,5 +3,29 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/LowLevelMemTracker.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCPP_TopDown, Log, All);
+
+/** "stat WizardDungeon": gameplay hot paths and counters. Cycle stats also show up as CPU scopes in Insights. */
+DECLARE_STATS_GROUP(TEXT("WizardDungeon"), STATGROUP_WizardDungeon, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Pooled Spells"), STAT_WizardDungeon_ActiveSpells, STATGROUP_WizardDungeon, CPP_TOPDOWN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Enemies"), STAT_WizardDungeon_LiveEnemies, STATGROUP_WizardDungeon, CPP_TOPDOWN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_WizardDungeon_DamageEvents, STATGROUP_WizardDungeon, CPP_TOPDOWN_API);
+
+/** Trace channel for the fine-grained scopes (BT nodes); enable with -trace=cpu,WizardDungeon */
+UE_TRACE_CHANNEL_EXTERN(WizardDungeonChannel, CPP_TOPDOWN_API);
+
+/** Insights-only CPU scope on WizardDungeonChannel, for code that runs too often to deserve a stat */
+#define WIZARD_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, WizardDungeonChannel)
+
+/** LLM tags ("-llm", then "stat LLMFULL" or memreport) for the gameplay systems that allocate per enemy */
+LLM_DECLARE_TAG_API(WizardDungeon_SpellPools, CPP_TOPDOWN_API);
+LLM_DECLARE_TAG_API(WizardDungeon_EnemyWidgets, CPP_TOPDOWN_API);
+LLM_DECLARE_TAG_API(WizardDungeon_DynamicMaterials, CPP_TOPDOWN_API);
+LLM_DECLARE_TAG_API(WizardDungeon_Perception, CPP_TOPDOWN_API);
+LLM_DECLARE_TAG_API(WizardDungeon_BehaviorTrees, CPP_TOPDOWN_API);
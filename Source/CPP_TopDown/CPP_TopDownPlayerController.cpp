@@ -11,7 +11,7 @@
 #include "InputActionValue.h"
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
-#include "Perception/AISense_Hearing.h"
+#include "FootstepNoiseComponent.h"
 #include "BaseMagicCharacter.h"
 #include "BasePlayerCharacter.h"
 
@@ -25,6 +25,8 @@ ACPP_TopDownPlayerController::ACPP_TopDownPlayerController()
 	DefaultMouseCursor = EMouseCursor::Default;
 	CachedDestination = FVector::ZeroVector;
 	FollowTime = 0.f;
+
+	FootstepNoise = CreateDefaultSubobject<UFootstepNoiseComponent>(TEXT("FootstepNoise"));
 }
 
 void ACPP_TopDownPlayerController::BeginPlay()
@@ -33,6 +35,11 @@ void ACPP_TopDownPlayerController::BeginPlay()
 	Super::BeginPlay();
 
 	PlayerCharacter = Cast<ABaseMagicCharacter>(GetPawn());
+
+	if (UInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<UInputReplaySubsystem>())
+	{
+		Replay->RegisterController(this);
+	}
 }
 
 void ACPP_TopDownPlayerController::Tick(float deltaTime)
@@ -40,6 +47,17 @@ void ACPP_TopDownPlayerController::Tick(float deltaTime)
 
 }
 
+void ACPP_TopDownPlayerController::PlayerTick(float DeltaTime)
+{
+	// live input is processed at the start of the player tick, recorded input follows on the same frame
+	Super::PlayerTick(DeltaTime);
+
+	if (UInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<UInputReplaySubsystem>())
+	{
+		Replay->DispatchRecordedInput();
+	}
+}
+
 void ACPP_TopDownPlayerController::SetupInputComponent()
 {
 	// set up gameplay key bindings
@@ -55,24 +73,24 @@ void ACPP_TopDownPlayerController::SetupInputComponent()
 	if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent))
 	{
 		// Movement Bindings
-		EnhancedInputComponent->BindAction(MovementInput, ETriggerEvent::Triggered, this, &ACPP_TopDownPlayerController::Move);
+		EnhancedInputComponent->BindAction(MovementInput, ETriggerEvent::Triggered, this, &ThisClass::OnRecordableInput<EReplayedInput::Move>);
 		// Spell Selection Bindings
-		EnhancedInputComponent->BindAction(SelectFirstSpellInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::SelectFirstSpell);
-		EnhancedInputComponent->BindAction(SelectSecondSpellInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::SelectSecondSpell);
+		EnhancedInputComponent->BindAction(SelectFirstSpellInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::SelectFirstSpell>);
+		EnhancedInputComponent->BindAction(SelectSecondSpellInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::SelectSecondSpell>);
 		// Spell Casting Bindings
-		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Triggered, this, &ACPP_TopDownPlayerController::FireBullet);
-		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::OnPlayerStartShooting);
-		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Completed, this, &ACPP_TopDownPlayerController::OnPlayerStopShooting);
-		EnhancedInputComponent->BindAction(FireHoldInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::OnPlayerStartArc);
-		EnhancedInputComponent->BindAction(FireHoldInput, ETriggerEvent::Completed, this, &ACPP_TopDownPlayerController::OnPlayerReleaseArc);
+		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Triggered, this, &ThisClass::OnRecordableInput<EReplayedInput::Fire>);
+		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::FireStarted>);
+		EnhancedInputComponent->BindAction(FireInput, ETriggerEvent::Completed, this, &ThisClass::OnRecordableInput<EReplayedInput::FireCompleted>);
+		EnhancedInputComponent->BindAction(FireHoldInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::ArcStarted>);
+		EnhancedInputComponent->BindAction(FireHoldInput, ETriggerEvent::Completed, this, &ThisClass::OnRecordableInput<EReplayedInput::ArcCompleted>);
 		// Melee Bindings
-		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Triggered, this, &ACPP_TopDownPlayerController::MeleeAttack);
-		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::OnPlayerStartMelee);
-		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Completed, this, &ACPP_TopDownPlayerController::OnPlayerStopMelee);
+		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Triggered, this, &ThisClass::OnRecordableInput<EReplayedInput::Melee>);
+		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::MeleeStarted>);
+		EnhancedInputComponent->BindAction(MeleeInput, ETriggerEvent::Completed, this, &ThisClass::OnRecordableInput<EReplayedInput::MeleeCompleted>);
 		// Dodge Bindings
 		//EnhancedInputComponent->BindAction(DodgeInput, ETriggerEvent::Triggered, this, &ACPP_TopDownPlayerController::Dodge);
-		EnhancedInputComponent->BindAction(DodgeInput, ETriggerEvent::Started, this, &ACPP_TopDownPlayerController::OnPlayerStartDodge);
-		EnhancedInputComponent->BindAction(DodgeInput, ETriggerEvent::Completed, this, &ACPP_TopDownPlayerController::OnPlayerStopDodge);
+		EnhancedInputComponent->BindAction(DodgeInput, ETriggerEvent::Started, this, &ThisClass::OnRecordableInput<EReplayedInput::DodgeStarted>);
+		EnhancedInputComponent->BindAction(DodgeInput, ETriggerEvent::Completed, this, &ThisClass::OnRecordableInput<EReplayedInput::DodgeCompleted>);
 	}
 	else
 	{
@@ -80,6 +98,28 @@ void ACPP_TopDownPlayerController::SetupInputComponent()
 	}
 }
 
+void ACPP_TopDownPlayerController::ApplyRecordedInput(EReplayedInput Input, const FVector2D& Value)
+{
+	const FInputActionValue value(Value);
+
+	switch (Input)
+	{
+	case EReplayedInput::Move:				Move(value); break;
+	case EReplayedInput::SelectFirstSpell:	SelectFirstSpell(value); break;
+	case EReplayedInput::SelectSecondSpell:	SelectSecondSpell(value); break;
+	case EReplayedInput::Fire:				FireBullet(value); break;
+	case EReplayedInput::FireStarted:		OnPlayerStartShooting(); break;
+	case EReplayedInput::FireCompleted:		OnPlayerStopShooting(); break;
+	case EReplayedInput::ArcStarted:		OnPlayerStartArc(value); break;
+	case EReplayedInput::ArcCompleted:		OnPlayerReleaseArc(value); break;
+	case EReplayedInput::Melee:				MeleeAttack(value); break;
+	case EReplayedInput::MeleeStarted:		OnPlayerStartMelee(); break;
+	case EReplayedInput::MeleeCompleted:	OnPlayerStopMelee(); break;
+	case EReplayedInput::DodgeStarted:		OnPlayerStartDodge(); break;
+	case EReplayedInput::DodgeCompleted:	OnPlayerStopDodge(); break;
+	}
+}
+
 void ACPP_TopDownPlayerController::OnInputStarted()
 {
 	StopMovement();
@@ -95,26 +135,10 @@ void ACPP_TopDownPlayerController::Move(const FInputActionValue& value)
 
 	GetPawn()->AddMovementInput(inputVector, speed, false);
 
-	// Hearing event
-	// ——— Report a hearing stimulus anytime we actually move ———
-	if (!inputVector.IsNearlyZero())
+	// Hearing event: the component decides when movement actually becomes a noise report
+	if (!inputVector.IsNearlyZero() && FootstepNoise)
 	{
-		APawn* Me = GetPawn();
-		UWorld* World = GetWorld();
-		if (World && Me)
-		{
-			const float Loudness = 1.0f;      // adjust how loud footsteps are
-			const float HearingRange = 500.f; // match your AI’s HearingConfig
-
-			// Report the noise  
-			UAISense_Hearing::ReportNoiseEvent(
-				World,
-				Me->GetActorLocation(),                     // who made the noise
-				Loudness,               // volume
-				Me, // where
-				HearingRange            // how far it carries
-			);
-		}
+		FootstepNoise->ReportMovement();
 	}
 }
 
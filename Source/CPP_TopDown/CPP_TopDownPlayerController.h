@@ -6,11 +6,13 @@
 #include "Templates/SubclassOf.h"
 #include "GameFramework/PlayerController.h"
 #include "InputActionValue.h"
+#include "InputReplaySubsystem.h"
 #include "CPP_TopDownPlayerController.generated.h"
 
 class UNiagaraSystem;
 class UInputMappingContext;
 class UInputAction;
+class UFootstepNoiseComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
@@ -57,6 +59,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
 	UInputAction* MovementInput;
 
+	/** Throttles and merges the footstep hearing stimuli produced by Move */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = AI, meta = (AllowPrivateAccess = "true"))
+	UFootstepNoiseComponent* FootstepNoise;
+
 	/** Saved location of the character movement destination */
 	FVector CachedDestination;
 
@@ -68,6 +74,9 @@ public:
 	/** Constructor */
 	ACPP_TopDownPlayerController();
 
+	/** Runs the handler for a recorded input (used by UInputReplaySubsystem playback) */
+	void ApplyRecordedInput(EReplayedInput Input, const FVector2D& Value);
+
 protected:
 
 	/** Initialize input bindings */
@@ -81,6 +90,9 @@ protected:
 
 	virtual void Tick(float deltaTime) override;
 
+	/** Feeds recorded input right after live input, during playback */
+	virtual void PlayerTick(float DeltaTime) override;
+
 	void Move(const FInputActionValue& value);
 
 	void SelectFirstSpell(const FInputActionValue& value);
@@ -108,6 +120,18 @@ protected:
 	void OnPlayerStartDodge();
 	void OnPlayerStopDodge();
 
+	/** Every binding goes through here so the replay subsystem can record it, or drop it while replaying */
+	template<EReplayedInput Input>
+	void OnRecordableInput(const FInputActionValue& value)
+	{
+		UInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<UInputReplaySubsystem>();
+		const FVector2D Value = value.Get<FVector2D>();
+		if (!Replay || Replay->OnLiveInput(Input, Value))
+		{
+			ApplyRecordedInput(Input, Value);
+		}
+	}
+
 };
 
 
@@ -2,9 +2,12 @@
 
 
 #include "AC_ObjectPool.h"
+#include "CPP_TopDown.h"
 #include "PooledActor.h"
 #include <Kismet/GameplayStatics.h>
 
+DECLARE_CYCLE_STAT(TEXT("Pool GetPooledActor"), STAT_WizardDungeon_GetPooledActor, STATGROUP_WizardDungeon);
+
 // Sets default values for this component's properties
 UAC_ObjectPool::UAC_ObjectPool()
 {
@@ -77,6 +80,8 @@ void UAC_ObjectPool::InitializePool()
 
 void UAC_ObjectPool::GrowPoolForClass(TSubclassOf<APooledActor> ForClass, int32 NumToAdd)
 {
+	LLM_SCOPE_BYTAG(WizardDungeon_SpellPools);
+
 	if (!GetWorld() || !ForClass) return;
 
 	UClass* Key = ForClass.Get();
@@ -125,6 +130,8 @@ void UAC_ObjectPool::TickComponent(float DeltaTime, ELevelTick TickType, FActorC
 // -- Main GetPooledActor: robust search + fallback
 APooledActor* UAC_ObjectPool::GetPooledActor(TSubclassOf<APooledActor> RequestedClass /*= nullptr*/)
 {
+	SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_GetPooledActor);
+
 	TSubclassOf<APooledActor> UseClass = RequestedClass;
 	if (!UseClass)
 	{
@@ -242,6 +249,7 @@ APooledActor* UAC_ObjectPool::GetPooledActor(TSubclassOf<APooledActor> Requested
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[Pool] No free actor for %s; growing pool by %d"), *GetNameSafe(RequestKey), GrowthSize);
 		GrowPoolForClass(UseClass, GrowthSize);
+		++NumGrowEvents;
 
 		// After growing, try again
 		TArray<APooledActor*>& PoolArray2 = PerClassPools.FindOrAdd(RequestKey);
@@ -364,3 +372,30 @@ void UAC_ObjectPool::PoolPrewarmReport()
 	UE_LOG(LogTemp, Warning, TEXT("=== End Pool Report ==="));
 }
 
+FObjectPoolStats UAC_ObjectPool::GetPoolStats() const
+{
+	FObjectPoolStats Stats;
+	Stats.NumGrowEvents = NumGrowEvents;
+
+	for (const auto& Pair : PerClassPools)
+	{
+		for (const APooledActor* A : Pair.Value)
+		{
+			if (!IsValid(A)) continue;
+			++Stats.NumPooled;
+			if (A->bInUse) ++Stats.NumInUse;
+		}
+	}
+	return Stats;
+}
+
+void UAC_ObjectPool::GetAllPooledActors(TArray<APooledActor*>& OutActors) const
+{
+	for (const auto& Pair : PerClassPools)
+	{
+		for (APooledActor* A : Pair.Value)
+		{
+			if (IsValid(A)) OutActors.Add(A);
+		}
+	}
+}
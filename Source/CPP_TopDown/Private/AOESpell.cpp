@@ -2,6 +2,7 @@
 
 
 #include "AOESpell.h"
+#include "CPP_TopDown.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/Character.h"
 #include "Engine/OverlapResult.h"
@@ -12,6 +13,8 @@
 #include "NiagaraSystem.h"
 #include "NiagaraComponent.h"
 
+DECLARE_CYCLE_STAT(TEXT("AOE Explode"), STAT_WizardDungeon_AOEExplode, STATGROUP_WizardDungeon);
+
 AAOESpell::AAOESpell()
 {
 	ExplosionRadius = 300.0f;
@@ -40,6 +43,8 @@ void AAOESpell::OnComponentHit(UPrimitiveComponent* HitComp, AActor* OtherActor,
 
 void AAOESpell::Explode()
 {
+    SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_AOEExplode);
+
     UWorld* World = GetWorld();
     if (!World) return;
 
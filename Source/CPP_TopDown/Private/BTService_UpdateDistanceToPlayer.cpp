@@ -2,20 +2,132 @@
 
 
 #include "BTService_UpdateDistanceToPlayer.h"
+#include "CPP_TopDown.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BTCompositeNode.h"
+#include "BehaviorTree/Decorators/BTDecorator_Blackboard.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "AIController.h"
+#include "EnemyDistanceSubsystem.h"
+#include "Algo/Unique.h"
+
+namespace DistanceToPlayerService
+{
+	/** Adds the threshold of a Blackboard decorator comparing KeyName, ignores any other decorator */
+	static void AddDecoratorThreshold(const UBTDecorator* Decorator, FName KeyName, TArray<float>& OutThresholds)
+	{
+		// FloatValue is protected on the engine decorator, so read it through reflection
+		static const FFloatProperty* FloatValueProperty = FindFProperty<FFloatProperty>(UBTDecorator_Blackboard::StaticClass(), TEXT("FloatValue"));
+
+		const UBTDecorator_Blackboard* BBDecorator = Cast<UBTDecorator_Blackboard>(Decorator);
+		if (FloatValueProperty && BBDecorator && BBDecorator->GetSelectedBlackboardKey() == KeyName)
+		{
+			OutThresholds.Add(FloatValueProperty->GetPropertyValue_InContainer(BBDecorator));
+		}
+	}
+}
 
 UBTService_UpdateDistanceToPlayer::UBTService_UpdateDistanceToPlayer()
 {
 	NodeName = "Update Distance to Player";
+
+	bNotifyTick = false;
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+
+	SelfActorKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_UpdateDistanceToPlayer, SelfActorKey), AActor::StaticClass());
+	Player.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_UpdateDistanceToPlayer, Player), AActor::StaticClass());
+	DistanceToPlayer.AddFloatFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_UpdateDistanceToPlayer, DistanceToPlayer));
+	DistanceBand.AddIntFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_UpdateDistanceToPlayer, DistanceBand));
+	DistanceBand.AllowNoneAsValue(true);
+}
+
+void UBTService_UpdateDistanceToPlayer::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BBAsset = GetBlackboardAsset())
+	{
+		SelfActorKey.ResolveSelectedKey(*BBAsset);
+		Player.ResolveSelectedKey(*BBAsset);
+		DistanceToPlayer.ResolveSelectedKey(*BBAsset);
+		DistanceBand.ResolveSelectedKey(*BBAsset);
+	}
+
+	ResolvedBands = DistanceBands;
+
+	if (bBandsFromDecorators)
+	{
+		// the bands have to be the decorators' own thresholds, otherwise they compare against a stale distance
+		const FName KeyName = DistanceToPlayer.SelectedKeyName;
+		for (const UBTDecorator* Decorator : Asset.RootDecorators)
+		{
+			DistanceToPlayerService::AddDecoratorThreshold(Decorator, KeyName, ResolvedBands);
+		}
+
+		CollectDecoratorThresholds(Asset.RootNode, KeyName, ResolvedBands);
+	}
+
+	ResolvedBands.Sort();
+	ResolvedBands.SetNum(Algo::Unique(ResolvedBands));
+
+	if (ResolvedBands.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[DistanceBands] %s: no decorator compares %s, it will only be refreshed every %.2fs"),
+			*Asset.GetName(), *DistanceToPlayer.SelectedKeyName.ToString(), Interval);
+	}
 }
 
-void UBTService_UpdateDistanceToPlayer::TickNode(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory, float deltaSeconds)
+void UBTService_UpdateDistanceToPlayer::CollectDecoratorThresholds(const UBTCompositeNode* Node, FName KeyName, TArray<float>& OutThresholds)
 {
-	AActor* SelfActor = Cast<AActor>(ownerComp.GetBlackboardComponent()->GetValueAsObject(SelfActorKey.SelectedKeyName));
-	AActor* PlayerActor = Cast<AActor>(ownerComp.GetBlackboardComponent()->GetValueAsObject(Player.SelectedKeyName));
+	if (!Node) return;
+
+	for (const FBTCompositeChild& Child : Node->Children)
+	{
+		for (const UBTDecorator* Decorator : Child.Decorators)
+		{
+			DistanceToPlayerService::AddDecoratorThreshold(Decorator, KeyName, OutThresholds);
+		}
+
+		CollectDecoratorThresholds(Child.ChildComposite, KeyName, OutThresholds);
+	}
+}
+
+void UBTService_UpdateDistanceToPlayer::OnBecomeRelevant(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory)
+{
+	WIZARD_TRACE_SCOPE(BTService_UpdateDistanceToPlayer_BecomeRelevant);
+
+	Super::OnBecomeRelevant(ownerComp, nodeMemory);
+
+	UBlackboardComponent* BB = ownerComp.GetBlackboardComponent();
+	UEnemyDistanceSubsystem* Distances = GetWorld() ? GetWorld()->GetSubsystem<UEnemyDistanceSubsystem>() : nullptr;
+	if (!BB || !Distances) return;
+
+	AActor* SelfActor = Cast<AActor>(BB->GetValue<UBlackboardKeyType_Object>(SelfActorKey.GetSelectedKeyID()));
+	if (!SelfActor)
+	{
+		// SelfActor is filled in by the controller, but fall back to the pawn in case the key is empty this early
+		const AAIController* AIController = ownerComp.GetAIOwner();
+		SelfActor = AIController ? AIController->GetPawn() : nullptr;
+	}
+
+	Distances->RegisterEnemy(*BB, SelfActor,
+		Player.GetSelectedKeyID(), DistanceToPlayer.GetSelectedKeyID(), DistanceBand.GetSelectedKeyID(),
+		ResolvedBands, BandHysteresis, Interval);
+}
+
+void UBTService_UpdateDistanceToPlayer::OnCeaseRelevant(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory)
+{
+	WIZARD_TRACE_SCOPE(BTService_UpdateDistanceToPlayer_CeaseRelevant);
+
+	Super::OnCeaseRelevant(ownerComp, nodeMemory);
 
-	if (SelfActor && PlayerActor) {
-		float distance = FVector::Dist(SelfActor->GetActorLocation(), PlayerActor->GetActorLocation());
-		ownerComp.GetBlackboardComponent()->SetValueAsFloat(DistanceToPlayer.SelectedKeyName, distance);
+	UBlackboardComponent* BB = ownerComp.GetBlackboardComponent();
+	UEnemyDistanceSubsystem* Distances = GetWorld() ? GetWorld()->GetSubsystem<UEnemyDistanceSubsystem>() : nullptr;
+	if (BB && Distances)
+	{
+		Distances->UnregisterEnemy(*BB);
 	}
 }
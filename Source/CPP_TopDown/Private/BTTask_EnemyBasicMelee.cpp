@@ -2,50 +2,101 @@
 
 
 #include "BTTask_EnemyBasicMelee.h"
+#include "CPP_TopDown.h"
 #include "BaseEnemyCharacter.h"
 #include "AIController.h"
-#include "TimerManager.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
 
 UBTTask_EnemyBasicMelee::UBTTask_EnemyBasicMelee()
 {
 	NodeName = "Enemy Basic Melee";
 	bNotifyTick = true;
-	bCreateNodeInstance = true;   
+	bCreateNodeInstance = false;
+}
+
+void UBTTask_EnemyBasicMelee::InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const
+{
+	InitializeNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory, InitType);
+}
+
+void UBTTask_EnemyBasicMelee::CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const
+{
+	CleanupNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory, CleanupType);
 }
 
 EBTNodeResult::Type UBTTask_EnemyBasicMelee::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	WIZARD_TRACE_SCOPE(BTTask_EnemyBasicMelee_Execute);
+
 	AAIController* controller = OwnerComp.GetAIOwner();
-	CachedEnemy = Cast<ABaseEnemyCharacter>(controller ? controller->GetPawn() : nullptr);
+	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(controller ? controller->GetPawn() : nullptr);
 
-	if (CachedEnemy)
+	// on cooldown or staggered: MeleeAttack would do nothing and we'd wait forever
+	if (!Enemy || !Enemy->CanMeleeAttack())
 	{
-		CachedOwnerComp = &OwnerComp;
-		bIsWaitingForMelee = true;
-
-		CachedEnemy->OnMeleeFinished.AddDynamic(this, &UBTTask_EnemyBasicMelee::HandleMeleeFinished);
+		return EBTNodeResult::Failed;
+	}
 
-		CachedEnemy->MeleeAttack();
+	FBTEnemyBasicMeleeMemory* Memory = CastInstanceNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory);
+	Memory->Enemy = Enemy;
+	Memory->StartTime = OwnerComp.GetWorld()->GetTimeSeconds();
 
-		UE_LOG(LogTemp, Log, TEXT("[%s] Starting BasicMeleeAttack"), *CachedEnemy->GetName());
+	// Wait until the melee cooldown is over; ResetMelee sends the message to our controller
+	WaitForMessage(OwnerComp, ABaseMagicCharacter::MeleeFinishedMessage);
 
+	Enemy->MeleeAttack();
 
-		return EBTNodeResult::InProgress; // Wait until animation finishes
-	}
+	UE_LOG(LogTemp, Verbose, TEXT("[%s] Starting BasicMeleeAttack"), *Enemy->GetName());
 
-	return EBTNodeResult::Failed;
+	return EBTNodeResult::InProgress;
 }
 
 void UBTTask_EnemyBasicMelee::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	FBTEnemyBasicMeleeMemory* Memory = CastInstanceNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory);
+	const ABaseEnemyCharacter* Enemy = Memory->Enemy.Get();
+	if (!Enemy)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	// the cooldown callback never came, don't keep the tree stuck on this task
+	const double Elapsed = OwnerComp.GetWorld()->GetTimeSeconds() - Memory->StartTime;
+	if (Elapsed > Enemy->CharacterStats.MeleeCooldown + TimeoutMargin)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[%s] BasicMeleeAttack timed out after %.2fs"), *Enemy->GetName(), Elapsed);
+
+		Memory->Enemy.Reset();
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+	}
 }
 
-void UBTTask_EnemyBasicMelee::HandleMeleeFinished(bool bIsAttacking)
+void UBTTask_EnemyBasicMelee::OnMessage(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, FName Message, int32 RequestID, bool bSuccess)
 {
-	if (!bIsAttacking && CachedOwnerComp && CachedEnemy)
+	WIZARD_TRACE_SCOPE(BTTask_EnemyBasicMelee_OnMessage);
+
+	FBTEnemyBasicMeleeMemory* Memory = CastInstanceNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory);
+	const ABaseEnemyCharacter* Enemy = Memory->Enemy.Get();
+	Memory->Enemy.Reset();
+
+	if (Enemy)
 	{
-		CachedEnemy->OnMeleeFinished.RemoveDynamic(this, &UBTTask_EnemyBasicMelee::HandleMeleeFinished);
-		FinishLatentTask(*CachedOwnerComp, EBTNodeResult::Succeeded);
+		UE_LOG(LogTemp, Verbose, TEXT("[%s] BasicMeleeAttack finished after %.2fs"),
+			*Enemy->GetName(), OwnerComp.GetWorld()->GetTimeSeconds() - Memory->StartTime);
 	}
+
+	// a message for an enemy that's gone can't count as a finished attack
+	Super::OnMessage(OwnerComp, NodeMemory, Message, RequestID, bSuccess && Enemy != nullptr);
 }
 
+EBTNodeResult::Type UBTTask_EnemyBasicMelee::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTEnemyBasicMeleeMemory* Memory = CastInstanceNodeMemory<FBTEnemyBasicMeleeMemory>(NodeMemory);
+
+	// the attack itself runs on; ResetMelee's message just finds no task waiting
+	UE_LOG(LogTemp, Verbose, TEXT("[%s] BasicMeleeAttack aborted"), *GetNameSafe(Memory->Enemy.Get()));
+	Memory->Enemy.Reset();
+
+	return EBTNodeResult::Aborted;
+}
@@ -2,17 +2,26 @@
 
 
 #include "BTTask_EnemyBasicShoot.h"
+#include "CPP_TopDown.h"
 #include "BaseEnemyCharacter.h"
 #include "AIController.h"
 #include "Kismet/GameplayStatics.h"
 
+UBTTask_EnemyBasicShoot::UBTTask_EnemyBasicShoot()
+{
+	NodeName = "Enemy Basic Shoot";
+	bCreateNodeInstance = false;
+}
+
 EBTNodeResult::Type UBTTask_EnemyBasicShoot::ExecuteTask(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory)
 {
+	WIZARD_TRACE_SCOPE(BTTask_EnemyBasicShoot_Execute);
+
 	AAIController* Controller = ownerComp.GetAIOwner();
-	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller->GetPawn());
+	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller ? Controller->GetPawn() : nullptr);
 	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(Controller, 0);
 
-	if (Enemy) {
+	if (Enemy && Player) {
 		Enemy->TryFireSpell();
 		FVector MuzzleLoc = Enemy->SpawnLocation->GetComponentLocation();
 
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BTTask_EnemyPatrol.h"
+#include "CPP_TopDown.h"
+#include "BaseEnemyCharacter.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+
+UBTTask_EnemyPatrol::UBTTask_EnemyPatrol()
+{
+	NodeName = "Enemy Patrol";
+	bNotifyTick = true;
+	bCreateNodeInstance = false;
+}
+
+EBTNodeResult::Type UBTTask_EnemyPatrol::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	WIZARD_TRACE_SCOPE(BTTask_EnemyPatrol_Execute);
+
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller ? Controller->GetPawn() : nullptr);
+	if (!Enemy) return EBTNodeResult::Failed;
+
+	// the crowd subsystem steers this enemy to its slot; a path move on top would fight it
+	if (Enemy->IsInPatrolCrowd()) return EBTNodeResult::InProgress;
+
+	const EPathFollowingRequestResult::Type Result = Controller->MoveToLocation(Enemy->GetPatrolTargetLocation(), AcceptanceRadius);
+	if (Result == EPathFollowingRequestResult::Failed) return EBTNodeResult::Failed;
+
+	if (Result == EPathFollowingRequestResult::AlreadyAtGoal)
+	{
+		Enemy->AdvancePatrol();
+		return EBTNodeResult::Succeeded;
+	}
+
+	return EBTNodeResult::InProgress;
+}
+
+void UBTTask_EnemyPatrol::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller ? Controller->GetPawn() : nullptr);
+	if (!Enemy)
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Failed);
+		return;
+	}
+
+	// nothing to wait for while the crowd is moving us
+	if (Enemy->IsInPatrolCrowd()) return;
+
+	if (Controller->GetMoveStatus() == EPathFollowingStatus::Idle)
+	{
+		Enemy->AdvancePatrol();
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+	}
+}
+
+EBTNodeResult::Type UBTTask_EnemyPatrol::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	const ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller ? Controller->GetPawn() : nullptr);
+
+	// only stop moves we issued ourselves
+	if (Enemy && !Enemy->IsInPatrolCrowd())
+	{
+		Controller->StopMovement();
+	}
+
+	return EBTNodeResult::Aborted;
+}
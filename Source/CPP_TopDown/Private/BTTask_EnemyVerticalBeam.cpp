@@ -2,15 +2,24 @@
 
 
 #include "BTTask_EnemyVerticalBeam.h"
+#include "CPP_TopDown.h"
 #include "BaseEnemyCharacter.h"
 #include "AIController.h"
 #include "Kismet/GameplayStatics.h"
 
 
+UBTTask_EnemyVerticalBeam::UBTTask_EnemyVerticalBeam()
+{
+	NodeName = "Enemy Vertical Beam";
+	bCreateNodeInstance = false;
+}
+
 EBTNodeResult::Type UBTTask_EnemyVerticalBeam::ExecuteTask(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory)
 {
+	WIZARD_TRACE_SCOPE(BTTask_EnemyVerticalBeam_Execute);
+
 	AAIController* Controller = ownerComp.GetAIOwner();
-	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller->GetPawn());
+	ABaseEnemyCharacter* Enemy = Cast<ABaseEnemyCharacter>(Controller ? Controller->GetPawn() : nullptr);
 	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(Controller, 0);
 
 	if (Enemy) {
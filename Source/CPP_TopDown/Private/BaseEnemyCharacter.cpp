@@ -2,11 +2,14 @@
 
 
     #include "BaseEnemyCharacter.h"
+    #include "CPP_TopDown.h"
     #include "BaseBullet.h"
     #include "NiagaraFunctionLibrary.h"
     #include "NiagaraComponent.h"
     #include "Components/BoxComponent.h"
     #include "Components/WidgetComponent.h"
+    #include "PatrolCrowdSubsystem.h"
+    #include "InputReplaySubsystem.h"
 
     ABaseEnemyCharacter::ABaseEnemyCharacter()
     {
@@ -31,6 +34,8 @@
     {
         Super::BeginPlay();
 
+        INC_DWORD_STAT(STAT_WizardDungeon_LiveEnemies);
+
         // --- Init the health widget (hardened & verbose) ---
         UE_LOG(LogTemp, Log, TEXT("%s::BeginPlay() - starting widget init"), *GetName());
 
@@ -89,6 +94,8 @@
             }
             else
             {
+                LLM_SCOPE_BYTAG(WizardDungeon_EnemyWidgets);
+
                 HealthWidgetComponent->SetWidgetClass(ChosenClass);
 
                 UUserWidget* RawWidget = HealthWidgetComponent->GetUserWidgetObject();
@@ -141,8 +148,36 @@
             {
                 UE_LOG(LogTemp, Error, TEXT("PatrolRouteActor %s has no SplineComponent!"), *PatrolRouteActor->GetName());
             }
+
+            PatrolCursor = PatrolRouteActor->MakeCursor(PatrolStartPoint);
+
+            if (PatrolRouteActor->IsCrowdMode())
+            {
+                if (UPatrolCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+                {
+                    CrowdSlotLocation = GetActorLocation();
+                    Crowd->JoinCrowd(PatrolRouteActor, this);
+                    bInPatrolCrowd = true;
+                }
+            }
+        }
+
+    }
+
+    void ABaseEnemyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+    {
+        DEC_DWORD_STAT(STAT_WizardDungeon_LiveEnemies);
+
+        if (bInPatrolCrowd)
+        {
+            if (UPatrolCrowdSubsystem* Crowd = GetWorld()->GetSubsystem<UPatrolCrowdSubsystem>())
+            {
+                Crowd->LeaveCrowd(this);
+            }
+            bInPatrolCrowd = false;
         }
 
+        Super::EndPlay(EndPlayReason);
     }
 
     float ABaseEnemyCharacter::TakeDamage(float DamageCount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -201,7 +236,9 @@
             BaseWeight = 0.4f;
         }
 
-        float R = FMath::FRand(); // 0..1
+        // seeded stream so recorded sessions replay the same spell choices
+        UInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<UInputReplaySubsystem>();
+        float R = Replay ? Replay->GetGameplayRandom().FRand() : FMath::FRand(); // 0..1
         TSubclassOf<ABaseBullet> ChosenClass = (R < ShardWeight && ShardSpellClass) ? ShardSpellClass : BaseSpellClass;
 
         if (ChosenClass == BaseSpellClass) SetBulletTypeByIndex(0);
@@ -232,6 +269,29 @@
         }
     }
 
+    FVector ABaseEnemyCharacter::GetPatrolTargetLocation() const
+    {
+        if (!PatrolRouteActor) return GetActorLocation();
+        if (bInPatrolCrowd) return CrowdSlotLocation;
+
+        return bUseOwnPatrolCursor ? PatrolRouteActor->GetCursorLocation(PatrolCursor) : PatrolRouteActor->GetWorldSplineLocation();
+    }
+
+    void ABaseEnemyCharacter::AdvancePatrol()
+    {
+        // crowd members follow their moving slot, there is no waypoint to advance
+        if (!PatrolRouteActor || bInPatrolCrowd) return;
+
+        if (bUseOwnPatrolCursor)
+        {
+            PatrolRouteActor->AdvanceCursor(PatrolCursor);
+        }
+        else
+        {
+            PatrolRouteActor->AdvancePatrolPoint();
+        }
+    }
+
     void ABaseEnemyCharacter::Tick(float DeltaTime)
     {
         Super::Tick(DeltaTime);
@@ -262,7 +322,7 @@
 
         // 1) Ask the route for its current target
         const FVector CurrentLocation = GetActorLocation();
-        const FVector TargetLocation = PatrolRouteActor->GetWorldSplineLocation();
+        const FVector TargetLocation = GetPatrolTargetLocation();
         const float   Radius = PatrolRouteActor->GetAcceptanceRadius();
 
         // 2) Compute move-vector toward it
@@ -2,14 +2,26 @@
 
 
 #include "BaseEnemyController.h"
+#include "CPP_TopDown.h"
 #include "BaseEnemyCharacter.h"
+#include "BrainComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Enum.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Float.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
+#include "Perception/AISense_Damage.h"
+#include "Perception/AISense_Hearing.h"
+#include "Perception/AISense_Sight.h"
 #include "Kismet/GameplayStatics.h"
+#include "PerceptionGridSubsystem.h"
 
 ABaseEnemyController::ABaseEnemyController()
 {
     //PrimaryActorTick.bCanEverTick = true;
 
+    LLM_SCOPE_BYTAG(WizardDungeon_Perception);
+
     PerceptionComp = CreateDefaultSubobject<UAIPerceptionComponent>("PerceptionComp");
 
     // Create the sight config *as a pointer*
@@ -47,74 +59,210 @@ ABaseEnemyController::ABaseEnemyController()
 void ABaseEnemyController::BeginPlay()
 {
 	Super::BeginPlay();
+	StartBehaviorTree();
+
+	if (UPerceptionGridSubsystem* Grid = GetWorld()->GetSubsystem<UPerceptionGridSubsystem>())
+	{
+		if (bUseGridSightScheduling)
+		{
+			LLM_SCOPE_BYTAG(WizardDungeon_Perception);
+			Grid->RegisterListener(this);
+			PerceptionComp->SetSenseEnabled(UAISense_Sight::StaticClass(), false);
+		}
+		else
+		{
+			// the grid doesn't know where we are, so footsteps mustn't be culled against it
+			Grid->RegisterUnscheduledListener(this);
+		}
+	}
+}
+
+void ABaseEnemyController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	// controllers spawned for an already spawned pawn (SpawnDefaultController) begin play before they possess it
+	if (HasActorBegunPlay())
+	{
+		StartBehaviorTree();
+	}
+}
+
+void ABaseEnemyController::StartBehaviorTree()
+{
+	if (IsBehaviorTreeRunning()) return;
+
 	ABaseEnemyCharacter* enemy = Cast<ABaseEnemyCharacter>(GetPawn());
 	if (enemy && enemy->BTAsset) {
+		LLM_SCOPE_BYTAG(WizardDungeon_BehaviorTrees);
+
 		RunBehaviorTree(enemy->BTAsset);
-		GetBlackboardComponent()->SetValueAsObject("Player", UGameplayStatics::GetPlayerCharacter(this, 0));
-        // Start off in Passive state
-        GetBlackboardComponent()->SetValueAsEnum(
-            TEXT("State"),
-            uint8(EEnemyStates::Passive)
-        );
+		CacheBlackboardKeys();
+
+		CachedAttackTarget = UGameplayStatics::GetPlayerCharacter(this, 0);
+		GetBlackboardComponent()->SetValue<UBlackboardKeyType_Object>(PlayerKeyId, CachedAttackTarget.Get());
+		// Start off in Passive state
+		SetEnemyState(EEnemyStates::Passive);
+	}
+
+	if (UBlackboardComponent* BB = GetBlackboardComponent())
+	{
+		const float MaxAge = SightConfig->GetMaxAge();
+		BB->SetValue<UBlackboardKeyType_Float>(LastSeenTimeKeyId, GetWorld()->GetTimeSeconds() - MaxAge - 1.0f);
+		BB->SetValue<UBlackboardKeyType_Float>(TimeSinceLastSeenKeyId, MaxAge + 1.0f);
 	}
+}
 
-    GetBlackboardComponent()->SetValueAsFloat("LastSeenTime", GetWorld()->GetTimeSeconds() - SightConfig->GetMaxAge() - 1.0f);
-	
+bool ABaseEnemyController::IsBehaviorTreeRunning() const
+{
+	return BrainComponent && BrainComponent->IsRunning();
 }
 
-void ABaseEnemyController::OnTargetPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus)  
-{  
-    if (!GetBlackboardComponent()) return;  
-
-    if (Stimulus.WasSuccessfullySensed() && Stimulus.Type == UAISense::GetSenseID<UAISense_Damage>())
-    {
-
-        if (Actor == GetPawn())
-        {
-            // Debug
-            //if (GEngine)
-            //    GEngine->AddOnScreenDebugMessage(
-            //        -1, 2.f, FColor::Red,
-            //        TEXT("[AI] Damage sense fired on me!"));
-
-            GetBlackboardComponent()->SetValueAsEnum(
-                TEXT("State"),
-                uint8(EEnemyStates::Attacking)
-            );
-		}
+void ABaseEnemyController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(TimerHandle_LostSight);
 
+	if (UPerceptionGridSubsystem* Grid = GetWorld()->GetSubsystem<UPerceptionGridSubsystem>())
+	{
+		Grid->UnregisterListener(this);
 	}
 
-    // If we’ve seen the Player and it’s alive, switch to Attacking  
-    ACharacter* Player = UGameplayStatics::GetPlayerCharacter(this, 0);  
+	Super::EndPlay(EndPlayReason);
+}
 
-    if (Actor != Player)  
-        return;
+void ABaseEnemyController::CacheBlackboardKeys()
+{
+	const UBlackboardComponent* BB = GetBlackboardComponent();
+	if (!BB) return;
 
-    float currentTime = GetWorld()->GetTimeSeconds();
-    float LastSeen = GetBlackboardComponent()->GetValueAsFloat(TEXT("LastSeenTime"));
+	StateKeyId = BB->GetKeyID(TEXT("State"));
+	PlayerKeyId = BB->GetKeyID(TEXT("Player"));
+	LastSeenTimeKeyId = BB->GetKeyID(TEXT("LastSeenTime"));
+	LastSeenLocationKeyId = BB->GetKeyID(TEXT("LastSeenLocation"));
+	TimeSinceLastSeenKeyId = BB->GetKeyID(TEXT("TimeSinceLastSeen"));
+}
 
-    if (Stimulus.WasSuccessfullySensed())
-    {
-        // record the world‐space spot you saw the player at
-        FVector PlayerLocation = Player->GetActorLocation();
+EEnemyStates ABaseEnemyController::GetEnemyState() const
+{
+	const UBlackboardComponent* BB = GetBlackboardComponent();
+	return BB ? EEnemyStates(BB->GetValue<UBlackboardKeyType_Enum>(StateKeyId)) : EEnemyStates::Passive;
+}
 
-        GetBlackboardComponent()->SetValueAsVector(
-            TEXT("LastSeenLocation"),
-            PlayerLocation
-        );
+void ABaseEnemyController::SetEnemyState(EEnemyStates NewState)
+{
+	if (UBlackboardComponent* BB = GetBlackboardComponent())
+	{
+		BB->SetValue<UBlackboardKeyType_Enum>(StateKeyId, uint8(NewState));
+	}
+}
 
-        // We’ve seen the player RIGHT NOW
-        GetBlackboardComponent()->SetValueAsFloat(
-            TEXT("LastSeenTime"),
-            currentTime
-        );
+void ABaseEnemyController::StartLostSightTimer(float Delay)
+{
+	GetWorldTimerManager().SetTimer(TimerHandle_LostSight, this, &ABaseEnemyController::OnLostSightExpired, FMath::Max(Delay, KINDA_SMALL_NUMBER), false);
+}
 
-        GetBlackboardComponent()->SetValueAsEnum(
-            TEXT("State"),
-            uint8(EEnemyStates::Attacking)
-        );
-    }
-    
+void ABaseEnemyController::ExtendLostSightTimer(float Delay)
+{
+	// a longer-lived stimulus already armed the timer, don't cut it short
+	if (GetWorldTimerManager().GetTimerRemaining(TimerHandle_LostSight) >= Delay) return;
 
+	StartLostSightTimer(Delay);
+}
+
+float ABaseEnemyController::GetSenseMaxAge(FAISenseID SenseID) const
+{
+	if (SenseID == UAISense::GetSenseID<UAISense_Sight>()) return SightConfig->GetMaxAge();
+	if (SenseID == UAISense::GetSenseID<UAISense_Hearing>()) return HearingConfig->GetMaxAge();
+	if (SenseID == UAISense::GetSenseID<UAISense_Damage>()) return DamageConfig->GetMaxAge();
+	return 0.f;
+}
+
+void ABaseEnemyController::OnLostSightExpired()
+{
+	UBlackboardComponent* BB = GetBlackboardComponent();
+	if (!BB) return;
+
+	const float LastSeen = BB->GetValue<UBlackboardKeyType_Float>(LastSeenTimeKeyId);
+	BB->SetValue<UBlackboardKeyType_Float>(TimeSinceLastSeenKeyId, GetWorld()->GetTimeSeconds() - LastSeen);
+
+	if (GetEnemyState() == EEnemyStates::Attacking)
+	{
+		// Lost sight long enough, go back to Passive
+		SetEnemyState(EEnemyStates::Passive);
+	}
+}
+
+void ABaseEnemyController::ReceiveGridSight(AActor* Target, bool bSensed)
+{
+	const APawn* MyPawn = GetPawn();
+	if (!Target || !MyPawn) return;
+
+	FAIStimulus Stimulus(*GetDefault<UAISense_Sight>(), 1.f, Target->GetActorLocation(), MyPawn->GetActorLocation(),
+		bSensed ? FAIStimulus::SensingSucceeded : FAIStimulus::SensingFailed);
+
+	OnTargetPerceptionUpdated(Target, Stimulus);
+}
+
+void ABaseEnemyController::OnTargetPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus)
+{
+	UBlackboardComponent* BB = GetBlackboardComponent();
+	if (!BB) return;
+
+	const bool bSight = Stimulus.Type == UAISense::GetSenseID<UAISense_Sight>();
+
+	if (Stimulus.WasSuccessfullySensed() && Stimulus.Type == UAISense::GetSenseID<UAISense_Damage>())
+	{
+		if (Actor == GetPawn())
+		{
+			SetEnemyState(EEnemyStates::Attacking);
+
+			// Hit without seeing anyone: give up after the damage memory runs out unless sight picks the player up
+			if (!bPlayerInSight)
+			{
+				ExtendLostSightTimer(DamageConfig->GetMaxAge());
+			}
+		}
+	}
+
+	// If we’ve seen the Player and it’s alive, switch to Attacking
+	ACharacter* Player = UGameplayStatics::GetPlayerCharacter(this, 0);
+
+	if (Actor != Player)
+		return;
+
+	if (Stimulus.WasSuccessfullySensed())
+	{
+		CachedAttackTarget = Player;
+
+		// record the world‐space spot you saw the player at
+		BB->SetValue<UBlackboardKeyType_Vector>(LastSeenLocationKeyId, Player->GetActorLocation());
+
+		// We’ve seen the player RIGHT NOW
+		BB->SetValue<UBlackboardKeyType_Float>(LastSeenTimeKeyId, GetWorld()->GetTimeSeconds());
+		BB->SetValue<UBlackboardKeyType_Float>(TimeSinceLastSeenKeyId, 0.f);
+
+		SetEnemyState(EEnemyStates::Attacking);
+
+		if (bSight)
+		{
+			// still in view, nothing to expire until sight reports the player as lost
+			bPlayerInSight = true;
+			GetWorldTimerManager().ClearTimer(TimerHandle_LostSight);
+		}
+		else if (!bPlayerInSight)
+		{
+			// heard (or otherwise sensed) but not seen: forget the player once that sense's memory runs out
+			ExtendLostSightTimer(GetSenseMaxAge(Stimulus.Type));
+		}
+	}
+	else if (bSight)
+	{
+		// Sight lost: one timer instead of re-checking the elapsed time every tick
+		bPlayerInSight = false;
+		StartLostSightTimer(SightConfig->GetMaxAge());
+	}
+	else if (Stimulus.Type == UAISense::GetSenseID<UAISense_Hearing>() && !bPlayerInSight)
+	{
+		ExtendLostSightTimer(HearingConfig->GetMaxAge());
+	}
 }
@@ -2,6 +2,7 @@
 
 
 #include "BaseMagicCharacter.h"
+#include "CPP_TopDown.h"
 #include "BaseWeapon.h"
 #include "BaseBullet.h"
 #include "GameFramework/ProjectileMovementComponent.h"
@@ -9,6 +10,13 @@
 #include "Perception/AISense_Damage.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/CapsuleComponent.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("ShootBullet"), STAT_WizardDungeon_ShootBullet, STATGROUP_WizardDungeon);
+DECLARE_CYCLE_STAT(TEXT("TakeDamage"), STAT_WizardDungeon_TakeDamage, STATGROUP_WizardDungeon);
+
+const FName ABaseMagicCharacter::MeleeFinishedMessage = TEXT("MeleeFinished");
 
 // Sets default values
 ABaseMagicCharacter::ABaseMagicCharacter()
@@ -24,6 +32,8 @@ ABaseMagicCharacter::ABaseMagicCharacter()
 
     StaggeredState = CreateDefaultSubobject<UStaggeredStateComponent>(TEXT("StaggerState"));
 
+	Dissolve = CreateDefaultSubobject<UDissolveComponent>(TEXT("Dissolve"));
+
 	BaseSpellPool = CreateDefaultSubobject<UAC_ObjectPool>(TEXT("BaseSpellPool"));
 
     CharacterStats.MaxHP = 50.f;
@@ -41,6 +51,11 @@ void ABaseMagicCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
+    if (UCooldownSubsystem* Cooldowns = GetWorld()->GetSubsystem<UCooldownSubsystem>())
+    {
+        CooldownSlot = Cooldowns->RegisterOwner();
+    }
+
     // make sure BulletToSpawn starts as the first type:
     if (AvailableBulletTypes.Num() > 0)
     {
@@ -59,6 +74,39 @@ void ABaseMagicCharacter::BeginPlay()
 	GetCharacterMovement()->MaxWalkSpeed = CharacterStats.movementSpeed;
 }
 
+void ABaseMagicCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UCooldownSubsystem* Cooldowns = GetWorld()->GetSubsystem<UCooldownSubsystem>())
+    {
+        Cooldowns->UnregisterOwner(CooldownSlot);
+    }
+    CooldownSlot = INDEX_NONE;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void ABaseMagicCharacter::StartCooldown(ECharacterCooldown Cooldown, float Duration, FSimpleDelegate OnReady)
+{
+    if (UCooldownSubsystem* Cooldowns = GetWorld()->GetSubsystem<UCooldownSubsystem>())
+    {
+        Cooldowns->StartCooldown(CooldownSlot, Cooldown, Duration, MoveTemp(OnReady));
+    }
+}
+
+void ABaseMagicCharacter::ClearCooldown(ECharacterCooldown Cooldown)
+{
+    if (UCooldownSubsystem* Cooldowns = GetWorld()->GetSubsystem<UCooldownSubsystem>())
+    {
+        Cooldowns->ClearCooldown(CooldownSlot, Cooldown);
+    }
+}
+
+bool ABaseMagicCharacter::IsCooldownReady(ECharacterCooldown Cooldown) const
+{
+    const UCooldownSubsystem* Cooldowns = GetWorld() ? GetWorld()->GetSubsystem<UCooldownSubsystem>() : nullptr;
+    return !Cooldowns || Cooldowns->IsReady(CooldownSlot, Cooldown);
+}
+
 void ABaseMagicCharacter::EnterStagger(float Duration)
 {
     if (StaggeredState)
@@ -97,10 +145,14 @@ void ABaseMagicCharacter::UnblockAllActions()
 
 float ABaseMagicCharacter::TakeDamage(float DamageCount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
+    SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_TakeDamage);
+
     // Defensive early-outs
     if (DamageCount <= 0.f) return 0.f;
     if (bIsDead) return 0.f; // you should add bIsDead bool in header and initialize it false
 
+    INC_DWORD_STAT(STAT_WizardDungeon_DamageEvents);
+
 	// Apply damage to the character's health
 	CharacterStats.HP -= DamageCount;
 
@@ -126,6 +178,11 @@ float ABaseMagicCharacter::TakeDamage(float DamageCount, FDamageEvent const& Dam
             Pawn->DisableInput(nullptr);
         }
 
+        if (bDissolveOnDeath && Dissolve)
+        {
+            Dissolve->DissolveOut(DeathDissolveDuration);
+        }
+
         // Defer actual destruction to avoid reentrancy problems (caller may still be iterating/expecting us)
         // Small delay to let the caller finish its stack (tweak delay as needed)
         SetLifeSpan(1.0f);
@@ -215,6 +272,8 @@ void ABaseMagicCharacter::Tick(float DeltaTime)
 
 AActor* ABaseMagicCharacter::ShootBullet(const FVector& Velocity)
 {
+	SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_ShootBullet);
+
 	if (IsStaggered()) return nullptr; // guard against shooting while staggered
 
     // 1) Compute the full rotation
@@ -230,8 +289,8 @@ AActor* ABaseMagicCharacter::ShootBullet(const FVector& Velocity)
 	}
 
 
-    if (!canFire) return nullptr;
-    canFire = false;
+    // canFire is the stagger block, the fire rate is just a timestamp compare
+    if (!canFire || !IsCooldownReady(ECharacterCooldown::Fire)) return nullptr;
 
     // 1) Sanity–check your spawn data:
     if (!BulletToSpawn)
@@ -250,13 +309,8 @@ AActor* ABaseMagicCharacter::ShootBullet(const FVector& Velocity)
         return nullptr;
     }
 
-    // 2) Fire‐rate timer
-    FTimerHandle TimerHandle;
-    GetWorld()->GetTimerManager().SetTimer(
-        TimerHandle,
-        FTimerDelegate::CreateUObject(this, &ABaseMagicCharacter::SetCanFire, true),
-        CharacterStats.fireRate,
-        false);
+    // 2) Fire‐rate cooldown (no callback needed, ShootBullet checks it)
+    StartCooldown(ECharacterCooldown::Fire, CharacterStats.fireRate);
 
     FRotator GeneralShootRotation = YawOnlyRot;
 
@@ -327,9 +381,6 @@ void ABaseMagicCharacter::StartHitFlash()
         if (DynamicMaterials.Num() == 0) return; // nothing to do
     }
 
-    // Clear any pending timer so repeated hits refresh the flash
-    GetWorldTimerManager().ClearTimer(TimerHandle_HitFlash);
-
     for (UMaterialInstanceDynamic* Dyn : DynamicMaterials)
     {
         if (!IsValid(Dyn)) continue;
@@ -338,8 +389,8 @@ void ABaseMagicCharacter::StartHitFlash()
         Dyn->SetScalarParameterValue(TintAmountParamName, 1.0f);
     }
 
-    // Schedule stop
-    GetWorldTimerManager().SetTimer(TimerHandle_HitFlash, this, &ABaseMagicCharacter::StopHitFlash, DamageTintDuration, false);
+    // Schedule stop; restarting the cooldown means repeated hits refresh the flash
+    StartCooldown(ECharacterCooldown::HitFlash, DamageTintDuration, FSimpleDelegate::CreateUObject(this, &ABaseMagicCharacter::StopHitFlash));
 }
 
 void ABaseMagicCharacter::StopHitFlash()
@@ -356,6 +407,8 @@ void ABaseMagicCharacter::StopHitFlash()
 
 void ABaseMagicCharacter::EnsureDynamicMaterials()
 {
+    LLM_SCOPE_BYTAG(WizardDungeon_DynamicMaterials);
+
     DynamicMaterials.Empty();
 
     // Try skeletal mesh first
@@ -387,16 +440,11 @@ void ABaseMagicCharacter::EnsureDynamicMaterials()
     }
 }
 
-void ABaseMagicCharacter::SetCanFire(bool value)
-{
-	canFire = value;
-}
-
 void ABaseMagicCharacter::MeleeAttack()
 {
 	if (IsStaggered()) return; // guard against attacking while staggered
 
-    if (!bCanMelee)
+    if (!bCanMelee || !IsCooldownReady(ECharacterCooldown::Melee))
         return;
 
     bCanMelee = false;
@@ -450,14 +498,16 @@ void ABaseMagicCharacter::MeleeAttack()
     //}
 
 
-    // Set timer to reset melee
-    GetWorld()->GetTimerManager().SetTimer(
-        MeleeTimerHandle,
-        this,
-        &ABaseMagicCharacter::ResetMelee,
-        CharacterStats.MeleeCooldown,
-        false
-    );
+    // Reset melee once the cooldown runs out
+    StartCooldown(ECharacterCooldown::Melee, CharacterStats.MeleeCooldown, FSimpleDelegate::CreateUObject(this, &ABaseMagicCharacter::ResetMelee));
+}
+
+int32 ABaseMagicCharacter::FindBulletTypeIndex(const UClass* BaseClass) const
+{
+    return AvailableBulletTypes.IndexOfByPredicate([BaseClass](const TSubclassOf<ABaseBullet>& Type)
+    {
+        return Type && Type->IsChildOf(BaseClass);
+    });
 }
 
 void ABaseMagicCharacter::SetBulletTypeByIndex(int32 NewIndex)
@@ -510,8 +560,13 @@ void ABaseMagicCharacter::ResetMelee()
     isMeleeAttacking = false;
     OnMeleeStart.Broadcast(false);
 
-    // **This is the signal your BT task is waiting on**
     OnMeleeFinished.Broadcast(false);
+
+    // **This is the signal your BT task is waiting on**
+    if (AAIController* AIController = Cast<AAIController>(GetController()))
+    {
+        FAIMessage::Send(AIController, FAIMessage(MeleeFinishedMessage, this, true));
+    }
 }
 
 FVector ABaseMagicCharacter::CalculateMovementBlending()
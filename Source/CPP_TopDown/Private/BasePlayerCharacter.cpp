@@ -2,6 +2,7 @@
 
 
 #include "BasePlayerCharacter.h"
+#include "CPP_TopDown.h"
 #include "AOESpell.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
@@ -12,6 +13,10 @@
 #include "NiagaraComponent.h"
 #include "Components/SplineMeshComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "PerceptionGridSubsystem.h"
+#include "SafeRepositionSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Player UpdateArcPreview"), STAT_WizardDungeon_UpdateArcPreview, STATGROUP_WizardDungeon);
 
 
 
@@ -105,6 +110,14 @@ void ABasePlayerCharacter::BeginPlay()
         DissolveNiagaraComp->SetAsset(DissolveNiagaraSystem);
     }
 
+    if (Dissolve)
+    {
+        Dissolve->AmountParameterName = DissolveParameterName;
+        Dissolve->ValueMin = DissolveValueMin;
+        Dissolve->ValueMax = DissolveValueMax;
+        Dissolve->OnDissolveFinished.AddDynamic(this, &ABasePlayerCharacter::OnDodgeDissolveFinished);
+    }
+
     // create full-screen HUD (only locally)
     if (Player_HUDClass && IsLocallyControlled())
     {
@@ -118,6 +131,28 @@ void ABasePlayerCharacter::BeginPlay()
             
         }
     }
+
+    // enemies look for us through the perception grid
+    if (UPerceptionGridSubsystem* Grid = GetWorld()->GetSubsystem<UPerceptionGridSubsystem>())
+    {
+        Grid->RegisterTarget(this);
+    }
+}
+
+void ABasePlayerCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UPerceptionGridSubsystem* Grid = GetWorld()->GetSubsystem<UPerceptionGridSubsystem>())
+    {
+        Grid->UnregisterTarget(this);
+    }
+
+    if (USafeRepositionSubsystem* Reposition = GetWorld()->GetSubsystem<USafeRepositionSubsystem>())
+    {
+        Reposition->CancelReposition(DodgeRepositionRequest);
+        DodgeRepositionRequest = 0;
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 float ABasePlayerCharacter::TakeDamage(float DamageCount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
@@ -206,6 +241,8 @@ void ABasePlayerCharacter::OnReleaseArcThrow()
 
 void ABasePlayerCharacter::UpdateArcPreview()
 {
+    SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_UpdateArcPreview);
+
     if (!SpawnLocation) return;
 
     FVector Start = SpawnLocation->GetComponentLocation();
@@ -331,7 +368,7 @@ void ABasePlayerCharacter::OnStopDodge()
 
 void ABasePlayerCharacter::Dodge()
 {
-    if (!bCanDodge) return;
+    if (!bCanDodge || !IsCooldownReady(ECharacterCooldown::Dodge)) return;
 
     if (!Controller) Controller = GetController(); // optional ensure
 
@@ -342,8 +379,22 @@ void ABasePlayerCharacter::Dodge()
     //PendingTeleportLocation = FinalLocation;
     bHasPendingTeleport = true;
 
-    // start dissolve material animation
-    StartDissolveOut();
+    // resolve the destination while we dissolve, so the teleport itself doesn't have to sweep
+    if (USafeRepositionSubsystem* Reposition = GetWorld()->GetSubsystem<USafeRepositionSubsystem>())
+    {
+        FVector Start, End;
+        FCollisionShape Shape;
+        GetDodgeSweep(Start, End, Shape);
+
+        Reposition->CancelReposition(DodgeRepositionRequest);
+        DodgeRepositionRequest = Reposition->RequestReposition(this, Start, End, Shape);
+    }
+
+    // start dissolve material animation; the teleport happens when it finishes
+    if (Dissolve)
+    {
+        Dissolve->DissolveOut(DissolveDuration);
+    }
 
     // start (or restart) the Niagara dissolve effect attached to mesh
     if (DissolveNiagaraComp)
@@ -365,184 +416,84 @@ void ABasePlayerCharacter::Dodge()
     bIsDodgeInvulnerable = true;
     if (DodgeInvulnerabilityTime > 0.f)
     {
-        GetWorldTimerManager().ClearTimer(TimerHandle_EndInvuln);
-        GetWorldTimerManager().SetTimer(TimerHandle_EndInvuln, this, &ABasePlayerCharacter::EndDodgeInvuln, DodgeInvulnerabilityTime, false);
+        StartCooldown(ECharacterCooldown::DodgeInvulnerability, DodgeInvulnerabilityTime, FSimpleDelegate::CreateUObject(this, &ABasePlayerCharacter::EndDodgeInvuln));
     }
 
     // Start cooldown
     bCanDodge = false;
-    GetWorldTimerManager().ClearTimer(TimerHandle_DodgeCooldown);
-    GetWorldTimerManager().SetTimer(TimerHandle_DodgeCooldown, this, &ABasePlayerCharacter::ResetDodge, DodgeCooldown, false);
+    StartCooldown(ECharacterCooldown::Dodge, DodgeCooldown, FSimpleDelegate::CreateUObject(this, &ABasePlayerCharacter::ResetDodge));
 }
 
-void ABasePlayerCharacter::InitDissolveMIDs()
+void ABasePlayerCharacter::OnDodgeDissolveFinished(bool bDissolvedOut)
 {
-    // if already inited, skip
-    if (DynamicMats.Num() > 0) return;
-
-    USkeletalMeshComponent* Skel = GetMesh();
-    if (!IsValid(Skel)) return;
-
-    int32 NumMats = Skel->GetNumMaterials();
-    DynamicMats.SetNum(NumMats);
-    OriginalMats.SetNum(NumMats);
-
-    for (int32 i = 0; i < NumMats; ++i)
+    if (bDissolvedOut)
     {
-        UMaterialInterface* Mat = Skel->GetMaterial(i);
-        OriginalMats[i] = Mat;
-
-        if (Mat)
+        // Teleport now (we are fully dissolved)
+        if (bHasPendingTeleport)
         {
-            UMaterialInstanceDynamic* MID = Skel->CreateAndSetMaterialInstanceDynamic(i);
-            DynamicMats[i] = MID;
-
-            if (MID)
-            {
-                MID->SetScalarParameterValue(DissolveParameterName, DissolveValueMin);
-            }
+            PerformTeleportNow();
+            bHasPendingTeleport = false;
         }
-    }
-}
-
-void ABasePlayerCharacter::StartDissolveOut()
-{
-    InitDissolveMIDs();
-    if (DynamicMats.Num() == 0) return;
-
-    // start timer
-    DissolveElapsed = 0.f;
-    bDissolvingOut = true;
 
-    GetWorldTimerManager().ClearTimer(TimerHandle_DissolveTick);
-    // tick frequency 60hz (approx); you can use lower rate if you prefer
-    GetWorldTimerManager().SetTimer(TimerHandle_DissolveTick, this, &ABasePlayerCharacter::UpdateDissolveTick, 1.0f / 60.0f, true);
-}
-
-void ABasePlayerCharacter::UpdateDissolveTick()
-{
-    // delta per tick
-    float Delta = 1.0f / 60.0f;
-    DissolveElapsed += Delta;
-
-    float Alpha;
-    if (bDissolvingOut)
-    {
-        if (DissolveDuration <= 0.f) Alpha = 1.f;
-        else Alpha = FMath::Clamp(DissolveElapsed / DissolveDuration, 0.f, 1.f);
-    }
-    else
-    {
-        if (ResolveDuration <= 0.f) Alpha = 0.f;
-        else Alpha = 1.f - FMath::Clamp(DissolveElapsed / ResolveDuration, 0.f, 1.f);
-    }
-
-    // map to your parameter range
-    const float MappedValue = FMath::Lerp(DissolveValueMin, DissolveValueMax, Alpha);
-
-    for (UMaterialInstanceDynamic* MID : DynamicMats)
-    {
-        if (MID) MID->SetScalarParameterValue(DissolveParameterName, MappedValue);
-    }
-
-    // finish
-    if (bDissolvingOut)
-    {
-        // finished dissolving out (fully "gone")
-        if (DissolveElapsed >= DissolveDuration)
+        // ensure Niagara doesn't keep playing while resolving
+        if (DissolveNiagaraComp && DissolveNiagaraComp->IsActive())
         {
-            // Teleport now (we were fully dissolves)
-            if (bHasPendingTeleport)
-            {
-                PerformTeleportNow();
-                bHasPendingTeleport = false;
-            }
-
-            // SWITCH to resolve phase without restarting the timer.
-            bDissolvingOut = false;
-            DissolveElapsed = 0.f;
-
-            // Optionally ensure Niagara doesn't restart when resolving:
-            if (DissolveNiagaraComp && DissolveNiagaraComp->IsActive())
-            {
-                DissolveNiagaraComp->Deactivate();
-            }
-
-            // keep the same timer running — the next ticks will handle the resolve
-            return;
+            DissolveNiagaraComp->Deactivate();
         }
+
+        Dissolve->ResolveIn(ResolveDuration);
+        return;
     }
-    else
+
+    // finished resolve (material is back to visible)
+    if (DissolveNiagaraComp && DissolveNiagaraComp->IsActive())
     {
-        // finished resolve (material is back to visible)
-        if (DissolveElapsed >= ResolveDuration)
-        {
-            // Stop the timer — we're totally done
-            GetWorldTimerManager().ClearTimer(TimerHandle_DissolveTick);
-
-            // Cleanup Niagara: stop so it won't keep playing
-            if (DissolveNiagaraComp)
-            {
-                if (DissolveNiagaraComp->IsActive())
-                {
-                    DissolveNiagaraComp->Deactivate();
-                }
-            }
-
-            // Optionally ensure invulnerability ended if you used it just for dodge
-            bIsDodgeInvulnerable = false;
-
-            // Done
-            return;
-        }
+        DissolveNiagaraComp->Deactivate();
     }
 
+    // ensure invulnerability ended if you used it just for dodge
+    bIsDodgeInvulnerable = false;
 }
 
 void ABasePlayerCharacter::OnDissolveNiagaraFinished(UNiagaraComponent* FinishedComponent)
 {
 }
 
-void ABasePlayerCharacter::PerformTeleportNow()
+void ABasePlayerCharacter::GetDodgeSweep(FVector& OutStart, FVector& OutEnd, FCollisionShape& OutShape) const
 {
-    if (!bHasPendingTeleport) return;
-
     FVector Forward = GetActorForwardVector();
     Forward.Z = 0.f;
     if (Forward.IsNearlyZero()) Forward = FVector::ForwardVector;
     Forward.Normalize();
 
-    // recompute safe final location (optional) — this reuses the capsule size logic
-    FVector Start = GetActorLocation();
-    PendingTeleportLocation = Start + Forward * DodgeDistance;
-    FVector RecomputedFinal = PendingTeleportLocation;
+    OutStart = GetActorLocation();
+    OutEnd = OutStart + Forward * DodgeDistance;
 
-    // a quick sweep to be safe (you can factor this into a helper as discussed earlier)
-    UCapsuleComponent* MyCapsule = FindComponentByClass<UCapsuleComponent>();
     float SweepRadius = DodgeSweepRadius;
     float SweepHalfHeight = DodgeSweepHalfHeight;
-    if (MyCapsule)
+    if (const UCapsuleComponent* MyCapsule = GetCapsuleComponent())
     {
         SweepRadius = FMath::Max(SweepRadius, MyCapsule->GetScaledCapsuleRadius());
         SweepHalfHeight = FMath::Max(SweepHalfHeight, MyCapsule->GetScaledCapsuleHalfHeight());
     }
+    OutShape = FCollisionShape::MakeCapsule(SweepRadius, SweepHalfHeight);
+}
+
+void ABasePlayerCharacter::PerformTeleportNow()
+{
+    if (!bHasPendingTeleport) return;
 
-    FHitResult Hit;
-    bool bHit = GetWorld()->SweepSingleByChannel(
-        Hit,
-        Start,
-        PendingTeleportLocation,
-        FQuat::Identity,
-        ECC_WorldStatic,
-        FCollisionShape::MakeCapsule(SweepRadius, SweepHalfHeight),
-        FCollisionQueryParams(SCENE_QUERY_STAT(DodgeSweep), false, this));
-
-    if (bHit && Hit.bBlockingHit)
+    // recompute from where we are now; the subsystem reuses the async result if we haven't drifted
+    FVector Start;
+    FCollisionShape Shape;
+    GetDodgeSweep(Start, PendingTeleportLocation, Shape);
+
+    FVector RecomputedFinal = PendingTeleportLocation;
+    if (USafeRepositionSubsystem* Reposition = GetWorld()->GetSubsystem<USafeRepositionSubsystem>())
     {
-        const float SafetyOffset = 10.0f;
-        FVector Dir = (PendingTeleportLocation - Start).GetSafeNormal();
-        RecomputedFinal = Hit.Location - Dir * SafetyOffset;
+        RecomputedFinal = Reposition->ResolveReposition(DodgeRepositionRequest, this, Start, PendingTeleportLocation, Shape);
     }
+    DodgeRepositionRequest = 0;
 
     // perform move with sweep so engine can resolve collisions
     FHitResult MoveHit;
@@ -0,0 +1,475 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CombatBenchmarkSubsystem.h"
+#include "AC_ObjectPool.h"
+#include "AOESpell.h"
+#include "BaseEnemyCharacter.h"
+#include "BaseEnemyController.h"
+#include "BasePlayerCharacter.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "EngineUtils.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderCore.h"
+#include "UObject/UObjectIterator.h"
+
+namespace CombatBenchmark
+{
+	static const TCHAR* ScenarioName(ECombatBenchmarkScenario Scenario)
+	{
+		switch (Scenario)
+		{
+		case ECombatBenchmarkScenario::Enemies:	return TEXT("Enemies");
+		case ECombatBenchmarkScenario::Fire:	return TEXT("Fire");
+		case ECombatBenchmarkScenario::AOE:		return TEXT("AOE");
+		}
+		return TEXT("Unknown");
+	}
+
+	/** Radius of the ring the enemies are spawned on */
+	static constexpr float SpawnRadius = 1500.f;
+
+	/** Radius of the circle the scripted player walks */
+	static constexpr float PlayerOrbitRadius = 400.f;
+}
+
+bool UCombatBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	FString Value;
+	return FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmark="), Value) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UCombatBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatBenchmarkSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	ParseCommandLine();
+	if (Scenarios.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] no valid scenarios in -CombatBenchmark, expected Enemies,Fire,AOE"));
+		return;
+	}
+
+	if (!ValidateEnemyClass())
+	{
+		FailRun(TEXT("no usable enemy class"));
+		return;
+	}
+
+	// deterministic simulation: every frame advances the same amount of game time
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FixedFPS);
+
+	Random.Initialize(Seed);
+	FMath::RandInit(Seed);
+
+	bRunning = true;
+	ScenarioIndex = 0;
+	StartScenario();
+}
+
+void UCombatBenchmarkSubsystem::Deinitialize()
+{
+	// don't destroy actors while the world tears down; it takes the spawned enemies with it,
+	// and finished runs already tore their scenarios down in FinishScenario / FailRun
+	SpawnedEnemies.Reset();
+	bRunning = false;
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatBenchmarkSubsystem::ParseCommandLine()
+{
+	const TCHAR* CmdLine = FCommandLine::Get();
+
+	FString ScenarioList;
+	FParse::Value(CmdLine, TEXT("CombatBenchmark="), ScenarioList, false);
+
+	TArray<FString> Names;
+	ScenarioList.ParseIntoArray(Names, TEXT(","));
+	for (const FString& Name : Names)
+	{
+		if (Name.Equals(TEXT("Enemies"), ESearchCase::IgnoreCase))	Scenarios.Add(ECombatBenchmarkScenario::Enemies);
+		else if (Name.Equals(TEXT("Fire"), ESearchCase::IgnoreCase))	Scenarios.Add(ECombatBenchmarkScenario::Fire);
+		else if (Name.Equals(TEXT("AOE"), ESearchCase::IgnoreCase))	Scenarios.Add(ECombatBenchmarkScenario::AOE);
+		else UE_LOG(LogTemp, Warning, TEXT("[CombatBenchmark] unknown scenario '%s'"), *Name);
+	}
+
+	FParse::Value(CmdLine, TEXT("BenchmarkEnemies="), NumEnemies);
+	FParse::Value(CmdLine, TEXT("BenchmarkFrames="), MeasuredFrames);
+	FParse::Value(CmdLine, TEXT("BenchmarkWarmup="), WarmupFrames);
+	FParse::Value(CmdLine, TEXT("BenchmarkFPS="), FixedFPS);
+	FParse::Value(CmdLine, TEXT("BenchmarkSeed="), Seed);
+	bExitWhenDone = !FParse::Param(CmdLine, TEXT("BenchmarkNoExit"));
+
+	NumEnemies = FMath::Max(NumEnemies, 0);
+	MeasuredFrames = FMath::Max(MeasuredFrames, 1);
+	WarmupFrames = FMath::Max(WarmupFrames, 0);
+	FixedFPS = FMath::Max(FixedFPS, 1.f);
+
+	FString EnemyClassPath = DefaultEnemyClass.ToString();
+	FParse::Value(CmdLine, TEXT("BenchmarkEnemyClass="), EnemyClassPath);
+
+	EnemyClass = nullptr;
+	if (!EnemyClassPath.IsEmpty())
+	{
+		EnemyClass = LoadClass<ABaseEnemyCharacter>(nullptr, *EnemyClassPath);
+		if (!EnemyClass)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] couldn't load enemy class '%s'"), *EnemyClassPath);
+		}
+	}
+}
+
+bool UCombatBenchmarkSubsystem::ValidateEnemyClass() const
+{
+	if (!EnemyClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] no enemy class; set DefaultEnemyClass in DefaultGame.ini or pass -BenchmarkEnemyClass="));
+		return false;
+	}
+
+	// the native class has no behavior tree, so only Blueprint enemies exercise the AI
+	if (!Cast<UBlueprintGeneratedClass>(EnemyClass.Get()))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] %s is not a Blueprint enemy"), *EnemyClass->GetPathName());
+		return false;
+	}
+
+	const ABaseEnemyCharacter* Defaults = EnemyClass->GetDefaultObject<ABaseEnemyCharacter>();
+	if (!Defaults->BTAsset)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] %s has no BTAsset"), *EnemyClass->GetPathName());
+		return false;
+	}
+
+	if (!Defaults->AIControllerClass || !Defaults->AIControllerClass->IsChildOf<ABaseEnemyController>())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] %s doesn't use an ABaseEnemyController"), *EnemyClass->GetPathName());
+		return false;
+	}
+
+	return true;
+}
+
+void UCombatBenchmarkSubsystem::FailRun(const FString& Reason)
+{
+	UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] run failed: %s"), *Reason);
+
+	TearDownScenario();
+	bRunning = false;
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+}
+
+ABasePlayerCharacter* UCombatBenchmarkSubsystem::GetPlayer() const
+{
+	return Cast<ABasePlayerCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
+}
+
+void UCombatBenchmarkSubsystem::StartScenario()
+{
+	const ECombatBenchmarkScenario Scenario = Scenarios[ScenarioIndex];
+	UE_LOG(LogTemp, Display, TEXT("[CombatBenchmark] starting %s: %d enemies, %d warmup + %d measured frames at %.0f fps, seed %d"),
+		CombatBenchmark::ScenarioName(Scenario), NumEnemies, WarmupFrames, MeasuredFrames, FixedFPS, Seed);
+
+	// each scenario starts from the same random state
+	Random.Initialize(Seed);
+
+	ABasePlayerCharacter* Player = GetPlayer();
+	ArenaCenter = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+	PlayerOrbitAngle = 0.f;
+
+	// the scripted player must survive the whole run
+	if (Player)
+	{
+		Player->CharacterStats.MaxHP = Player->CharacterStats.HP = 1.e9f;
+	}
+
+	if (!SpawnEnemies())
+	{
+		FailRun(FString::Printf(TEXT("%s enemies aren't running their behavior trees"), CombatBenchmark::ScenarioName(Scenario)));
+		return;
+	}
+
+	CachePools();
+
+	ScenarioFrame = 0;
+	Samples.Reset(MeasuredFrames);
+	LastFrameSeconds = FPlatformTime::Seconds();
+}
+
+void UCombatBenchmarkSubsystem::CachePools()
+{
+	Pools.Reset();
+
+	// pools are default subobjects of the characters, and no character is spawned mid-scenario
+	UWorld* World = GetWorld();
+	for (TObjectIterator<UAC_ObjectPool> It; It; ++It)
+	{
+		if (It->GetWorld() == World)
+		{
+			Pools.Add(*It);
+		}
+	}
+}
+
+bool UCombatBenchmarkSubsystem::SpawnEnemies()
+{
+	UWorld* World = GetWorld();
+	const ECombatBenchmarkScenario Scenario = Scenarios[ScenarioIndex];
+
+	FActorSpawnParameters Params;
+	Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 i = 0; i < NumEnemies; ++i)
+	{
+		const float Angle = 2.f * PI * i / FMath::Max(NumEnemies, 1);
+		const float Radius = CombatBenchmark::SpawnRadius * Random.FRandRange(0.8f, 1.f);
+		const FVector Location = ArenaCenter + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Radius;
+		const FRotator Rotation = (ArenaCenter - Location).Rotation();
+
+		ABaseEnemyCharacter* Enemy = World->SpawnActor<ABaseEnemyCharacter>(EnemyClass, Location, FRotator(0.f, Rotation.Yaw, 0.f), Params);
+		if (!Enemy) continue;
+
+		SpawnedEnemies.Add(Enemy);
+
+		if (!Enemy->GetController())
+		{
+			Enemy->SpawnDefaultController();
+		}
+
+		// anything else would measure idle pawns
+		const ABaseEnemyController* AI = Cast<ABaseEnemyController>(Enemy->GetController());
+		if (!AI || !AI->IsBehaviorTreeRunning())
+		{
+			UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] %s spawned without a running ABaseEnemyController behavior tree"), *Enemy->GetName());
+			return false;
+		}
+
+		if (Scenario != ECombatBenchmarkScenario::Enemies)
+		{
+			// fire/AOE measure the combat paths on their own; the BTs are covered by the Enemies scenario
+			AI->GetBrainComponent()->StopLogic(TEXT("CombatBenchmark"));
+
+			// AOE targets have to last the whole scenario
+			Enemy->CharacterStats.MaxHP = Enemy->CharacterStats.HP = 1.e9f;
+		}
+	}
+
+	return true;
+}
+
+void UCombatBenchmarkSubsystem::TearDownScenario()
+{
+	for (ABaseEnemyCharacter* Enemy : SpawnedEnemies)
+	{
+		if (!IsValid(Enemy)) continue;
+
+		if (AController* Controller = Enemy->GetController())
+		{
+			Controller->Destroy();
+		}
+		Enemy->Destroy();
+	}
+	SpawnedEnemies.Reset();
+	Pools.Reset();
+}
+
+void UCombatBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	if (!bRunning) return;
+
+	DriveScenario(DeltaTime);
+
+	// GGameThreadTime is written at the end of the engine tick, so right now it still holds the
+	// previous frame's time; credit it to that frame's sample
+	if (Samples.Num() > 0)
+	{
+		Samples.Last().GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	}
+
+	if (ScenarioFrame >= WarmupFrames && Samples.Num() < MeasuredFrames)
+	{
+		RecordSample();
+	}
+	else
+	{
+		LastFrameSeconds = FPlatformTime::Seconds();
+	}
+
+	// one frame past the last sample, to pick up its game thread time
+	if (++ScenarioFrame > WarmupFrames + MeasuredFrames)
+	{
+		FinishScenario();
+	}
+}
+
+void UCombatBenchmarkSubsystem::DriveScenario(float DeltaTime)
+{
+	ABasePlayerCharacter* Player = GetPlayer();
+	if (!Player) return;
+
+	const ECombatBenchmarkScenario Scenario = Scenarios[ScenarioIndex];
+	const FVector PlayerLocation = Player->GetActorLocation();
+
+	// scripted player: walk a circle around the arena centre so enemies have to chase and re-aim
+	PlayerOrbitAngle += DeltaTime * 0.5f;
+	const FVector OrbitTarget = ArenaCenter + FVector(FMath::Cos(PlayerOrbitAngle), FMath::Sin(PlayerOrbitAngle), 0.f) * CombatBenchmark::PlayerOrbitRadius;
+	Player->AddMovementInput((OrbitTarget - PlayerLocation).GetSafeNormal2D());
+
+	switch (Scenario)
+	{
+	case ECombatBenchmarkScenario::Enemies:
+		break;
+
+	case ECombatBenchmarkScenario::Fire:
+	{
+		// ShootBullet gates on the fire-rate cooldown itself, so calling it every frame is sustained fire
+		for (ABaseEnemyCharacter* Enemy : SpawnedEnemies)
+		{
+			if (!IsValid(Enemy)) continue;
+			const FVector Dir = (PlayerLocation - Enemy->GetActorLocation()).GetSafeNormal2D();
+			Enemy->ShootBullet(Dir * Enemy->CharacterStats.shootSpeed);
+		}
+
+		const FVector PlayerDir = FVector(FMath::Cos(PlayerOrbitAngle * 3.f), FMath::Sin(PlayerOrbitAngle * 3.f), 0.f);
+		Player->ShootBullet(PlayerDir * Player->CharacterStats.shootSpeed);
+		break;
+	}
+
+	case ECombatBenchmarkScenario::AOE:
+	{
+		const int32 AOEIndex = Player->FindBulletTypeIndex(AAOESpell::StaticClass());
+		if (AOEIndex == INDEX_NONE) break;
+
+		if (Player->CurrentBulletTypeIndex != AOEIndex)
+		{
+			Player->SetBulletTypeByIndex(AOEIndex);
+		}
+
+		const FVector Start = PlayerLocation + FVector(0.f, 0.f, 100.f);
+		const FVector2D Offset = FVector2D(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f)) * CombatBenchmark::SpawnRadius;
+		const FVector Target = ArenaCenter + FVector(Offset, 0.f);
+
+		FVector LaunchVelocity;
+		if (UGameplayStatics::SuggestProjectileVelocity_CustomArc(GetWorld(), LaunchVelocity, Start, Target, 0.f, 0.5f))
+		{
+			Player->ShootBullet(LaunchVelocity);
+		}
+		break;
+	}
+	}
+}
+
+void UCombatBenchmarkSubsystem::RecordSample()
+{
+	const double NowSeconds = FPlatformTime::Seconds();
+
+	FCombatBenchmarkSample& Sample = Samples.AddDefaulted_GetRef();
+	Sample.Frame = ScenarioFrame - WarmupFrames;
+	Sample.FrameMs = float((NowSeconds - LastFrameSeconds) * 1000.0);
+	Sample.NumActors = GetWorld()->GetActorCount();
+
+	LastFrameSeconds = NowSeconds;
+
+	for (const ABaseEnemyCharacter* Enemy : SpawnedEnemies)
+	{
+		if (IsValid(Enemy)) ++Sample.NumEnemies;
+	}
+
+	for (const TWeakObjectPtr<UAC_ObjectPool>& Pool : Pools)
+	{
+		if (!Pool.IsValid()) continue;
+
+		const FObjectPoolStats PoolStats = Pool->GetPoolStats();
+		Sample.PoolTotal += PoolStats.NumPooled;
+		Sample.PoolInUse += PoolStats.NumInUse;
+		Sample.PoolGrowEvents += PoolStats.NumGrowEvents;
+	}
+}
+
+void UCombatBenchmarkSubsystem::FinishScenario()
+{
+	const TCHAR* Name = CombatBenchmark::ScenarioName(Scenarios[ScenarioIndex]);
+
+	WriteCsv();
+
+	if (Samples.Num() > 0)
+	{
+		TArray<float> FrameMs;
+		double TotalFrame = 0.0, TotalGame = 0.0;
+		for (const FCombatBenchmarkSample& S : Samples)
+		{
+			FrameMs.Add(S.FrameMs);
+			TotalFrame += S.FrameMs;
+			TotalGame += S.GameThreadMs;
+		}
+		FrameMs.Sort();
+
+		UE_LOG(LogTemp, Display, TEXT("[CombatBenchmark] %s: frame avg %.2f ms, p95 %.2f ms, max %.2f ms; game thread avg %.2f ms; %d pool grow events"),
+			Name, TotalFrame / Samples.Num(), FrameMs[FMath::Min(FMath::FloorToInt(Samples.Num() * 0.95f), Samples.Num() - 1)], FrameMs.Last(),
+			TotalGame / Samples.Num(), Samples.Last().PoolGrowEvents);
+	}
+
+	TearDownScenario();
+
+	if (++ScenarioIndex < Scenarios.Num())
+	{
+		StartScenario();
+		return;
+	}
+
+	bRunning = false;
+	UE_LOG(LogTemp, Display, TEXT("[CombatBenchmark] all scenarios done"));
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UCombatBenchmarkSubsystem::WriteCsv() const
+{
+	const TCHAR* Name = CombatBenchmark::ScenarioName(Scenarios[ScenarioIndex]);
+
+	FString Csv = TEXT("Frame,FrameMs,GameThreadMs,Actors,Enemies,PoolTotal,PoolInUse,PoolGrowEvents\n");
+	for (const FCombatBenchmarkSample& S : Samples)
+	{
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%d,%d,%d,%d,%d\n"),
+			S.Frame, S.FrameMs, S.GameThreadMs, S.NumActors, S.NumEnemies, S.PoolTotal, S.PoolInUse, S.PoolGrowEvents);
+	}
+
+	const FString Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"),
+		FString::Printf(TEXT("CombatBenchmark_%s_%s.csv"), Name, *FDateTime::Now().ToString()));
+
+	if (FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogTemp, Display, TEXT("[CombatBenchmark] wrote %d samples to %s"), Samples.Num(), *Path);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("[CombatBenchmark] failed to write %s"), *Path);
+	}
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CooldownSubsystem.h"
+#include "Engine/World.h"
+
+bool UCooldownSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	// editor preview worlds don't need a table; their characters fall back to "always ready"
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCooldownSubsystem::Deinitialize()
+{
+	ReadyAt.Empty();
+	Callbacks.Empty();
+	PendingPos.Empty();
+	Pending.Empty();
+	FreeSlots.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UCooldownSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCooldownSubsystem, STATGROUP_Tickables);
+}
+
+double UCooldownSubsystem::Now() const
+{
+	const UWorld* World = GetWorld();
+	return World ? World->GetTimeSeconds() : 0.0;
+}
+
+int32 UCooldownSubsystem::RegisterOwner()
+{
+	if (FreeSlots.Num() > 0)
+	{
+		return FreeSlots.Pop(EAllowShrinking::No);
+	}
+
+	const int32 Slot = ReadyAt.Num() / NumCooldowns;
+	ReadyAt.AddZeroed(NumCooldowns);
+	Callbacks.AddDefaulted(NumCooldowns);
+	for (int32 c = 0; c < NumCooldowns; ++c)
+	{
+		PendingPos.Add(INDEX_NONE);
+	}
+	return Slot;
+}
+
+void UCooldownSubsystem::UnregisterOwner(int32 Slot)
+{
+	if (Slot < 0 || ToIndex(Slot, ECharacterCooldown(0)) >= ReadyAt.Num()) return;
+
+	for (int32 c = 0; c < NumCooldowns; ++c)
+	{
+		const int32 Index = ToIndex(Slot, ECharacterCooldown(c));
+		Disarm(Index);
+		ReadyAt[Index] = 0.0;
+		Callbacks[Index].Unbind();
+	}
+
+	FreeSlots.Add(Slot);
+}
+
+void UCooldownSubsystem::StartCooldown(int32 Slot, ECharacterCooldown Cooldown, float Duration, FSimpleDelegate OnReady)
+{
+	const int32 Index = ToIndex(Slot, Cooldown);
+	if (Slot < 0 || !ReadyAt.IsValidIndex(Index)) return;
+
+	ReadyAt[Index] = Now() + FMath::Max(Duration, 0.f);
+	Callbacks[Index] = MoveTemp(OnReady);
+
+	if (Callbacks[Index].IsBound())
+	{
+		if (PendingPos[Index] == INDEX_NONE)
+		{
+			PendingPos[Index] = Pending.Add(Index);
+		}
+	}
+	else
+	{
+		Disarm(Index);
+	}
+}
+
+void UCooldownSubsystem::ClearCooldown(int32 Slot, ECharacterCooldown Cooldown)
+{
+	const int32 Index = ToIndex(Slot, Cooldown);
+	if (Slot < 0 || !ReadyAt.IsValidIndex(Index)) return;
+
+	Disarm(Index);
+	ReadyAt[Index] = 0.0;
+	Callbacks[Index].Unbind();
+}
+
+bool UCooldownSubsystem::IsReady(int32 Slot, ECharacterCooldown Cooldown) const
+{
+	const int32 Index = ToIndex(Slot, Cooldown);
+	return Slot < 0 || !ReadyAt.IsValidIndex(Index) || ReadyAt[Index] <= Now();
+}
+
+float UCooldownSubsystem::GetRemaining(int32 Slot, ECharacterCooldown Cooldown) const
+{
+	const int32 Index = ToIndex(Slot, Cooldown);
+	return (Slot >= 0 && ReadyAt.IsValidIndex(Index)) ? FMath::Max(0.f, float(ReadyAt[Index] - Now())) : 0.f;
+}
+
+void UCooldownSubsystem::Disarm(int32 Index)
+{
+	const int32 Pos = PendingPos[Index];
+	if (Pos == INDEX_NONE) return;
+
+	Pending.RemoveAtSwap(Pos, EAllowShrinking::No);
+	if (Pending.IsValidIndex(Pos))
+	{
+		PendingPos[Pending[Pos]] = Pos;
+	}
+	PendingPos[Index] = INDEX_NONE;
+}
+
+void UCooldownSubsystem::Tick(float DeltaTime)
+{
+	if (Pending.Num() == 0) return;
+
+	const double Time = Now();
+
+	// 1) sweep: pull everything that expired out of the pending list
+	Expired.Reset();
+	for (int32 Pos = Pending.Num() - 1; Pos >= 0; --Pos)
+	{
+		const int32 Index = Pending[Pos];
+		if (ReadyAt[Index] > Time) continue;
+
+		Expired.Add(MoveTemp(Callbacks[Index]));
+		Callbacks[Index].Unbind();
+		Disarm(Index);
+	}
+
+	// 2) fire them; a callback starting a new cooldown only touches the table, not this list
+	for (FSimpleDelegate& Callback : Expired)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
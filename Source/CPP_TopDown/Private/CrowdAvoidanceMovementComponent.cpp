@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrowdAvoidanceMovementComponent.h"
+#include "CrowdAvoidanceSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+
+UCrowdAvoidanceMovementComponent::UCrowdAvoidanceMovementComponent()
+{
+	// the shared solve replaces the engine's per-component RVO
+	bUseRVOAvoidance = false;
+}
+
+void UCrowdAvoidanceMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bUseCrowdAvoidance)
+	{
+		if (UCrowdAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UCrowdAvoidanceSubsystem>())
+		{
+			Avoidance->RegisterAgent(this);
+		}
+	}
+}
+
+void UCrowdAvoidanceMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCrowdAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UCrowdAvoidanceSubsystem>())
+	{
+		Avoidance->UnregisterAgent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+float UCrowdAvoidanceMovementComponent::GetCrowdAvoidanceRadius() const
+{
+	if (CrowdAvoidanceRadius > 0.f || !CharacterOwner)
+	{
+		return CrowdAvoidanceRadius;
+	}
+
+	return CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius();
+}
+
+void UCrowdAvoidanceMovementComponent::SetAvoidanceVelocity(const FVector2D& Velocity, uint64 Frame)
+{
+	AvoidanceVelocity = Velocity;
+	AvoidanceFrame = Frame;
+}
+
+bool UCrowdAvoidanceMovementComponent::GetAvoidanceVelocity(FVector2D& OutVelocity) const
+{
+	if (AvoidanceFrame == 0 || GFrameCounter - AvoidanceFrame > UCrowdAvoidanceSubsystem::GetResultLifetimeFrames())
+	{
+		return false;
+	}
+
+	OutVelocity = AvoidanceVelocity;
+	return true;
+}
+
+void UCrowdAvoidanceMovementComponent::RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed)
+{
+	// path following tells us where it wants to go, the solve tells us how to get there without bumping into anyone
+	PreferredVelocity = FVector2D(bForceMaxSpeed ? MoveVelocity.GetSafeNormal() * GetMaxSpeed() : MoveVelocity);
+	bDirectMoveRequested = true;
+
+	FVector2D Avoided;
+	if (bUseCrowdAvoidance && GetAvoidanceVelocity(Avoided))
+	{
+		Super::RequestDirectMove(FVector(Avoided, MoveVelocity.Z), false);
+		return;
+	}
+
+	Super::RequestDirectMove(MoveVelocity, bForceMaxSpeed);
+}
+
+void UCrowdAvoidanceMovementComponent::StopActiveMovement()
+{
+	Super::StopActiveMovement();
+
+	PreferredVelocity = FVector2D::ZeroVector;
+	AvoidanceFrame = 0;
+}
+
+FVector UCrowdAvoidanceMovementComponent::ConsumeInputVector()
+{
+	FVector Input = Super::ConsumeInputVector();
+
+	// input driven movement (flow fields, scripted steering) when path following isn't driving us
+	if (!bDirectMoveRequested)
+	{
+		const float MaxSpeed = GetMaxSpeed();
+		PreferredVelocity = FVector2D(Input.GetClampedToMaxSize(1.f)) * MaxSpeed;
+
+		FVector2D Avoided;
+		if (bUseCrowdAvoidance && MaxSpeed > 0.f && !Input.IsNearlyZero() && GetAvoidanceVelocity(Avoided))
+		{
+			Input = FVector(Avoided / MaxSpeed, Input.Z);
+		}
+	}
+
+	bDirectMoveRequested = false;
+
+	return Input;
+}
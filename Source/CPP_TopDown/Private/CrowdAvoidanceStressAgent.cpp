@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrowdAvoidanceStressAgent.h"
+#include "CrowdAvoidanceMovementComponent.h"
+#include "AIController.h"
+#include "Components/CapsuleComponent.h"
+
+ACrowdAvoidanceStressAgent::ACrowdAvoidanceStressAgent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+	AIControllerClass = AAIController::StaticClass();
+
+	// the capsule is all there is to see
+	GetCapsuleComponent()->InitCapsuleSize(34.f, 88.f);
+	GetCapsuleComponent()->SetHiddenInGame(false);
+
+	bUseControllerRotationYaw = false;
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->MaxWalkSpeed = 300.f;
+	Movement->bOrientRotationToMovement = true;
+	Movement->RotationRate = FRotator(0.f, 640.f, 0.f);
+	Movement->AvoidanceConsiderationRadius = 250.f;
+	Movement->bConstrainToPlane = true;
+	Movement->bSnapToPlaneAtStart = true;
+}
@@ -0,0 +1,500 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CrowdAvoidanceSubsystem.h"
+#include "CrowdAvoidanceMovementComponent.h"
+#include "CrowdAvoidanceStressAgent.h"
+#include "AIController.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+
+namespace CrowdAvoidance
+{
+	static int32 MaxAgentsPerFrame = 1024;
+	static FAutoConsoleVariableRef CVarMaxAgentsPerFrame(
+		TEXT("ai.Avoidance.MaxAgentsPerFrame"),
+		MaxAgentsPerFrame,
+		TEXT("Agents whose avoidance is solved per frame (round-robin); 0 solves all of them every frame"));
+
+	static float TimeHorizon = 1.f;
+	static FAutoConsoleVariableRef CVarTimeHorizon(
+		TEXT("ai.Avoidance.TimeHorizon"),
+		TimeHorizon,
+		TEXT("Seconds ahead agents avoid collisions with each other. Longer is smoother but more conservative"));
+
+	static int32 MaxNeighbours = 10;
+	static FAutoConsoleVariableRef CVarMaxNeighbours(
+		TEXT("ai.Avoidance.MaxNeighbours"),
+		MaxNeighbours,
+		TEXT("Nearest neighbours each agent takes into account"));
+
+	static int32 ResultLifetimeFrames = 4;
+	static FAutoConsoleVariableRef CVarResultLifetimeFrames(
+		TEXT("ai.Avoidance.ResultLifetimeFrames"),
+		ResultLifetimeFrames,
+		TEXT("Frames an agent keeps using its last avoidance velocity when the budget skips it"));
+
+	/** One ORCA half-plane: velocities to the left of Direction through Point are allowed */
+	struct FLine
+	{
+		FVector2D Point;
+		FVector2D Direction;
+	};
+
+	static constexpr double Epsilon = 1.e-5;
+
+	static double Det(const FVector2D& A, const FVector2D& B)
+	{
+		return A.X * B.Y - A.Y * B.X;
+	}
+
+	/** Solves the 1D program along line LineNo, constrained by the lines before it and the speed circle */
+	static bool LinearProgram1(TConstArrayView<FLine> Lines, int32 LineNo, double Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		const FLine& Line = Lines[LineNo];
+		const double Dot = Line.Point | Line.Direction;
+		const double Discriminant = Dot * Dot + Radius * Radius - Line.Point.SizeSquared();
+
+		// the speed circle doesn't reach the line
+		if (Discriminant < 0.0)
+		{
+			return false;
+		}
+
+		const double SqrtDiscriminant = FMath::Sqrt(Discriminant);
+		double TLeft = -Dot - SqrtDiscriminant;
+		double TRight = -Dot + SqrtDiscriminant;
+
+		for (int32 i = 0; i < LineNo; ++i)
+		{
+			const double Denominator = Det(Line.Direction, Lines[i].Direction);
+			const double Numerator = Det(Lines[i].Direction, Line.Point - Lines[i].Point);
+
+			// parallel lines
+			if (FMath::Abs(Denominator) <= Epsilon)
+			{
+				if (Numerator < 0.0)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			const double T = Numerator / Denominator;
+
+			if (Denominator >= 0.0)
+			{
+				TRight = FMath::Min(TRight, T);
+			}
+			else
+			{
+				TLeft = FMath::Max(TLeft, T);
+			}
+
+			if (TLeft > TRight)
+			{
+				return false;
+			}
+		}
+
+		if (bDirectionOpt)
+		{
+			Result = Line.Point + ((OptVelocity | Line.Direction) > 0.0 ? TRight : TLeft) * Line.Direction;
+		}
+		else
+		{
+			const double T = FMath::Clamp(Line.Direction | (OptVelocity - Line.Point), TLeft, TRight);
+			Result = Line.Point + T * Line.Direction;
+		}
+
+		return true;
+	}
+
+	/** Finds the velocity closest to OptVelocity satisfying all lines. Returns the index of the first line that fails, or Lines.Num() */
+	static int32 LinearProgram2(TConstArrayView<FLine> Lines, double Radius, const FVector2D& OptVelocity, bool bDirectionOpt, FVector2D& Result)
+	{
+		if (bDirectionOpt)
+		{
+			Result = OptVelocity * Radius;
+		}
+		else if (OptVelocity.SizeSquared() > Radius * Radius)
+		{
+			Result = OptVelocity.GetSafeNormal() * Radius;
+		}
+		else
+		{
+			Result = OptVelocity;
+		}
+
+		for (int32 i = 0; i < Lines.Num(); ++i)
+		{
+			// the result violates this line, move it onto the line
+			if (Det(Lines[i].Direction, Lines[i].Point - Result) > 0.0)
+			{
+				const FVector2D PreviousResult = Result;
+
+				if (!LinearProgram1(Lines, i, Radius, OptVelocity, bDirectionOpt, Result))
+				{
+					Result = PreviousResult;
+					return i;
+				}
+			}
+		}
+
+		return Lines.Num();
+	}
+
+	/** The program is infeasible: find the velocity that violates the lines from BeginLine on the least */
+	static void LinearProgram3(TConstArrayView<FLine> Lines, int32 BeginLine, double Radius, FVector2D& Result)
+	{
+		double Distance = 0.0;
+
+		TArray<FLine, TInlineAllocator<16>> ProjectedLines;
+
+		for (int32 i = BeginLine; i < Lines.Num(); ++i)
+		{
+			if (Det(Lines[i].Direction, Lines[i].Point - Result) <= Distance)
+			{
+				continue;
+			}
+
+			ProjectedLines.Reset();
+
+			for (int32 j = 0; j < i; ++j)
+			{
+				FLine Line;
+				const double Determinant = Det(Lines[i].Direction, Lines[j].Direction);
+
+				if (FMath::Abs(Determinant) <= Epsilon)
+				{
+					// same direction, the earlier line is redundant
+					if ((Lines[i].Direction | Lines[j].Direction) > 0.0)
+					{
+						continue;
+					}
+
+					Line.Point = 0.5 * (Lines[i].Point + Lines[j].Point);
+				}
+				else
+				{
+					Line.Point = Lines[i].Point + (Det(Lines[j].Direction, Lines[i].Point - Lines[j].Point) / Determinant) * Lines[i].Direction;
+				}
+
+				Line.Direction = (Lines[j].Direction - Lines[i].Direction).GetSafeNormal();
+				ProjectedLines.Add(Line);
+			}
+
+			const FVector2D PreviousResult = Result;
+
+			// this should in principle never fail; if it does, keep the previous result
+			if (LinearProgram2(ProjectedLines, Radius, FVector2D(-Lines[i].Direction.Y, Lines[i].Direction.X), true, Result) < ProjectedLines.Num())
+			{
+				Result = PreviousResult;
+			}
+
+			Distance = Det(Lines[i].Direction, Lines[i].Point - Result);
+		}
+	}
+
+	/** ORCA velocity for one agent against its neighbours (van den Berg et al., without static obstacles: the navmesh handles those) */
+	static FVector2D ComputeNewVelocity(const FCrowdAvoidanceAgent& Agent, TConstArrayView<TPair<double, int32>> Neighbours, TConstArrayView<FCrowdAvoidanceAgent> Snapshots, double DeltaTime)
+	{
+		const double InvTimeHorizon = 1.0 / FMath::Max<double>(TimeHorizon, 0.01);
+		const double InvTimeStep = 1.0 / DeltaTime;
+
+		TArray<FLine, TInlineAllocator<16>> Lines;
+
+		for (const TPair<double, int32>& Neighbour : Neighbours)
+		{
+			const FCrowdAvoidanceAgent& Other = Snapshots[Neighbour.Value];
+
+			const FVector2D RelativePosition = Other.Position - Agent.Position;
+			const FVector2D RelativeVelocity = Agent.Velocity - Other.Velocity;
+			const double DistSq = RelativePosition.SizeSquared();
+			const double CombinedRadius = Agent.Radius + Other.Radius;
+			const double CombinedRadiusSq = CombinedRadius * CombinedRadius;
+
+			FLine Line;
+			FVector2D U;
+
+			if (DistSq > CombinedRadiusSq)
+			{
+				// no collision yet. W is the vector from the cutoff circle's center to the relative velocity
+				const FVector2D W = RelativeVelocity - InvTimeHorizon * RelativePosition;
+				const double WLengthSq = W.SizeSquared();
+				const double Dot = W | RelativePosition;
+
+				if (Dot < 0.0 && Dot * Dot > CombinedRadiusSq * WLengthSq)
+				{
+					// project on the cutoff circle
+					const double WLength = FMath::Sqrt(WLengthSq);
+					const FVector2D UnitW = W / WLength;
+
+					Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+					U = (CombinedRadius * InvTimeHorizon - WLength) * UnitW;
+				}
+				else
+				{
+					// project on the closer leg of the velocity obstacle cone
+					const double Leg = FMath::Sqrt(DistSq - CombinedRadiusSq);
+
+					if (Det(RelativePosition, W) > 0.0)
+					{
+						Line.Direction = FVector2D(RelativePosition.X * Leg - RelativePosition.Y * CombinedRadius, RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+					}
+					else
+					{
+						Line.Direction = -FVector2D(RelativePosition.X * Leg + RelativePosition.Y * CombinedRadius, -RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSq;
+					}
+
+					U = (RelativeVelocity | Line.Direction) * Line.Direction - RelativeVelocity;
+				}
+			}
+			else
+			{
+				// already overlapping: get apart within this frame
+				const FVector2D W = RelativeVelocity - InvTimeStep * RelativePosition;
+				const double WLength = W.Size();
+				const FVector2D UnitW = WLength > Epsilon ? W / WLength : FVector2D(1.0, 0.0);
+
+				Line.Direction = FVector2D(UnitW.Y, -UnitW.X);
+				U = (CombinedRadius * InvTimeStep - WLength) * UnitW;
+			}
+
+			// each agent takes half of the responsibility
+			Line.Point = Agent.Velocity + 0.5 * U;
+			Lines.Add(Line);
+		}
+
+		FVector2D Result;
+		const int32 FailedLine = LinearProgram2(Lines, Agent.MaxSpeed, Agent.PreferredVelocity, false, Result);
+
+		if (FailedLine < Lines.Num())
+		{
+			LinearProgram3(Lines, FailedLine, Agent.MaxSpeed, Result);
+		}
+
+		return Result;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs StressCommand(
+		TEXT("ai.Avoidance.Stress"),
+		TEXT("Usage: ai.Avoidance.Stress [Count] [Spacing] | clear. Spawns Count (default 1000) crowd avoidance agents packed Spacing (default 80) apart around the player and sends each to the opposite side of the pack."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UCrowdAvoidanceSubsystem* Avoidance = World ? World->GetSubsystem<UCrowdAvoidanceSubsystem>() : nullptr;
+			if (!Avoidance) return;
+
+			if (Args.Num() > 0 && Args[0] == TEXT("clear"))
+			{
+				for (TActorIterator<ACrowdAvoidanceStressAgent> It(World); It; ++It)
+				{
+					It->Destroy();
+				}
+				return;
+			}
+
+			const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+			const float Spacing = Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 80.f;
+
+			const APlayerController* PC = World->GetFirstPlayerController();
+			const APawn* Player = PC ? PC->GetPawn() : nullptr;
+			const FVector Center = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+
+			const int32 Side = FMath::CeilToInt32(FMath::Sqrt(float(Count)));
+			const float HalfExtent = 0.5f * (Side - 1) * Spacing;
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			int32 Spawned = 0;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				const FVector Offset((i % Side) * Spacing - HalfExtent, (i / Side) * Spacing - HalfExtent, 0.f);
+
+				ACrowdAvoidanceStressAgent* Agent = World->SpawnActor<ACrowdAvoidanceStressAgent>(Center + Offset, FRotator::ZeroRotator, SpawnParams);
+				if (!Agent) continue;
+
+				// everyone crosses through the middle of the pack
+				if (AAIController* AI = Cast<AAIController>(Agent->GetController()))
+				{
+					AI->MoveToLocation(Center - Offset, 50.f, true, true, true, false);
+				}
+
+				++Spawned;
+			}
+
+			Avoidance->ResetStats();
+			UE_LOG(LogTemp, Display, TEXT("[Avoidance] spawned %d agents %.0f apart, %d agents registered"), Spawned, Spacing, Avoidance->GetNumAgents());
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("ai.Avoidance.Stats"),
+		TEXT("Prints crowd avoidance solve counters. Pass 'reset' to clear them."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UCrowdAvoidanceSubsystem* Avoidance = World ? World->GetSubsystem<UCrowdAvoidanceSubsystem>() : nullptr;
+			if (!Avoidance) return;
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				Avoidance->ResetStats();
+				return;
+			}
+
+			const FCrowdAvoidanceStats& S = Avoidance->GetStats();
+			const double Frames = FMath::Max<double>(S.Frames, 1);
+			UE_LOG(LogTemp, Display, TEXT("[Avoidance] %llu frames, %d agents (peak %d)"), S.Frames, Avoidance->GetNumAgents(), S.PeakAgents);
+			UE_LOG(LogTemp, Display, TEXT("[Avoidance] solved/frame %.1f (budget %d), %.3f ms/frame"), S.AgentsSolved / Frames, MaxAgentsPerFrame, S.SolveSeconds * 1000.0 / Frames);
+		}));
+}
+
+bool UCrowdAvoidanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCrowdAvoidanceSubsystem::Deinitialize()
+{
+	Agents.Empty();
+	Snapshots.Empty();
+	SliceIndices.Empty();
+	SliceResults.Empty();
+	AgentGrid.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UCrowdAvoidanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCrowdAvoidanceSubsystem, STATGROUP_Tickables);
+}
+
+uint64 UCrowdAvoidanceSubsystem::GetResultLifetimeFrames()
+{
+	return uint64(FMath::Max(CrowdAvoidance::ResultLifetimeFrames, 1));
+}
+
+void UCrowdAvoidanceSubsystem::RegisterAgent(UCrowdAvoidanceMovementComponent* Agent)
+{
+	if (!Agent || Agent->CrowdIndex != INDEX_NONE) return;
+
+	Agent->CrowdIndex = Agents.Add(Agent);
+	Stats.PeakAgents = FMath::Max(Stats.PeakAgents, Agents.Num());
+}
+
+void UCrowdAvoidanceSubsystem::UnregisterAgent(UCrowdAvoidanceMovementComponent* Agent)
+{
+	if (!Agent || !Agents.IsValidIndex(Agent->CrowdIndex) || Agents[Agent->CrowdIndex] != Agent) return;
+
+	const int32 Index = Agent->CrowdIndex;
+	Agent->CrowdIndex = INDEX_NONE;
+
+	Agents.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	if (Agents.IsValidIndex(Index))
+	{
+		Agents[Index]->CrowdIndex = Index;
+	}
+}
+
+void UCrowdAvoidanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const int32 NumAgents = Agents.Num();
+	if (NumAgents == 0 || DeltaTime <= 0.f) return;
+
+	const double Start = FPlatformTime::Seconds();
+
+	// snapshot everyone, the solve needs every neighbour's position and velocity from the same frame
+	Snapshots.SetNumUninitialized(NumAgents);
+	float MaxConsiderationRadius = 0.f;
+
+	for (int32 i = 0; i < NumAgents; ++i)
+	{
+		const UCrowdAvoidanceMovementComponent* Agent = Agents[i];
+		FCrowdAvoidanceAgent& Snapshot = Snapshots[i];
+
+		Snapshot.Position = FVector2D(Agent->GetActorFeetLocation());
+		Snapshot.Velocity = FVector2D(Agent->Velocity);
+		Snapshot.PreferredVelocity = Agent->GetPreferredVelocity();
+		Snapshot.Radius = Agent->GetCrowdAvoidanceRadius();
+		Snapshot.MaxSpeed = Agent->GetMaxSpeed();
+		Snapshot.ConsiderationRadius = Agent->AvoidanceConsiderationRadius;
+
+		MaxConsiderationRadius = FMath::Max(MaxConsiderationRadius, Snapshot.ConsiderationRadius);
+	}
+
+	// cells about the size of the largest query keep the neighbourhood to a 3x3 block
+	if (MaxConsiderationRadius > 0.f && !FMath::IsNearlyEqual(AgentGrid.GetCellSize(), MaxConsiderationRadius))
+	{
+		AgentGrid.SetCellSize(MaxConsiderationRadius);
+	}
+
+	AgentGrid.Reset();
+	for (int32 i = 0; i < NumAgents; ++i)
+	{
+		AgentGrid.Add(i, FVector(Snapshots[i].Position, 0.f));
+	}
+	AgentGrid.Build();
+
+	// this frame's round-robin slice
+	const int32 Budget = CrowdAvoidance::MaxAgentsPerFrame > 0 ? FMath::Min(CrowdAvoidance::MaxAgentsPerFrame, NumAgents) : NumAgents;
+
+	if (NextAgent >= NumAgents)
+	{
+		NextAgent = 0;
+	}
+
+	SliceIndices.Reset(Budget);
+	for (int32 i = 0; i < Budget; ++i)
+	{
+		SliceIndices.Add((NextAgent + i) % NumAgents);
+	}
+	NextAgent = (NextAgent + Budget) % NumAgents;
+
+	SliceResults.SetNumUninitialized(Budget);
+
+	const int32 MaxNeighbours = FMath::Max(CrowdAvoidance::MaxNeighbours, 1);
+	const float TimeStep = FMath::Max(DeltaTime, 1.f / 120.f);
+
+	// the snapshots and the grid are read-only from here on, so every agent can solve independently
+	ParallelFor(Budget, [this, MaxNeighbours, TimeStep](int32 SliceIndex)
+	{
+		const int32 AgentIndex = SliceIndices[SliceIndex];
+		const FCrowdAvoidanceAgent& Agent = Snapshots[AgentIndex];
+
+		TArray<TPair<double, int32>, TInlineAllocator<32>> Neighbours;
+
+		AgentGrid.ForEachInRadius(FVector(Agent.Position, 0.f), Agent.ConsiderationRadius, [&](int32 Id, const FVector2D& Location)
+		{
+			if (Id != AgentIndex)
+			{
+				Neighbours.Emplace(FVector2D::DistSquared(Location, Agent.Position), Id);
+			}
+		});
+
+		// keep the closest ones only
+		if (Neighbours.Num() > MaxNeighbours)
+		{
+			Neighbours.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key < B.Key; });
+			Neighbours.SetNum(MaxNeighbours, EAllowShrinking::No);
+		}
+
+		SliceResults[SliceIndex] = CrowdAvoidance::ComputeNewVelocity(Agent, Neighbours, Snapshots, TimeStep);
+	});
+
+	// hand the results back; components apply them to their next requested velocity or input
+	for (int32 i = 0; i < Budget; ++i)
+	{
+		Agents[SliceIndices[i]]->SetAvoidanceVelocity(SliceResults[i], GFrameCounter);
+	}
+
+	++Stats.Frames;
+	Stats.AgentsSolved += Budget;
+	Stats.SolveSeconds += FPlatformTime::Seconds() - Start;
+}
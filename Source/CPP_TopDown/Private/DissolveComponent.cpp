@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DissolveComponent.h"
+#include "CPP_TopDown.h"
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "TimerManager.h"
+
+// Sets default values for this component's properties
+UDissolveComponent::UDissolveComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UDissolveComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(TimerHandle_PhaseEnd);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UDissolveComponent::DissolveOut(float Duration)
+{
+	StartPhase(ValueMin, ValueMax, Duration, true);
+}
+
+void UDissolveComponent::ResolveIn(float Duration)
+{
+	StartPhase(ValueMax, ValueMin, Duration, false);
+}
+
+void UDissolveComponent::EnsureMIDs()
+{
+	if (DynamicMats.Num() > 0) return;
+
+	LLM_SCOPE_BYTAG(WizardDungeon_DynamicMaterials);
+
+	const ACharacter* Character = Cast<ACharacter>(GetOwner());
+	USkeletalMeshComponent* Mesh = Character ? Character->GetMesh() : GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+	if (!IsValid(Mesh)) return;
+
+	for (int32 i = 0; i < Mesh->GetNumMaterials(); ++i)
+	{
+		if (!Mesh->GetMaterial(i)) continue;
+
+		// returns the existing MID if the slot already has one (e.g. from the hit flash)
+		if (UMaterialInstanceDynamic* MID = Mesh->CreateAndSetMaterialInstanceDynamic(i))
+		{
+			DynamicMats.Add(MID);
+		}
+	}
+
+	// the material drives itself only if it actually has the start time input
+	bMaterialDriven = false;
+	for (UMaterialInstanceDynamic* MID : DynamicMats)
+	{
+		float Unused = 0.f;
+		if (MID->GetScalarParameterValue(FHashedMaterialParameterInfo(StartTimeParameterName), Unused))
+		{
+			bMaterialDriven = true;
+			break;
+		}
+	}
+
+	if (!bMaterialDriven && DynamicMats.Num() > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Dissolve] %s: materials have no %s parameter, falling back to writing %s every frame"),
+			*GetNameSafe(GetOwner()), *StartTimeParameterName.ToString(), *AmountParameterName.ToString());
+	}
+}
+
+void UDissolveComponent::StartPhase(float From, float To, float Duration, bool bOut)
+{
+	EnsureMIDs();
+
+	UWorld* World = GetWorld();
+	World->GetTimerManager().ClearTimer(TimerHandle_PhaseEnd);
+
+	bPhaseActive = true;
+	bPhaseOut = bOut;
+	PhaseFrom = From;
+	PhaseTo = To;
+	PhaseDuration = FMath::Max(Duration, 0.f);
+	PhaseElapsed = 0.f;
+
+	if (PhaseDuration <= 0.f)
+	{
+		WriteAmount(To);
+		FinishPhase();
+		return;
+	}
+
+	if (bMaterialDriven)
+	{
+		// written once; the material computes the amount from its Time node every frame
+		const float StartTime = World->GetTimeSeconds();
+		for (UMaterialInstanceDynamic* MID : DynamicMats)
+		{
+			if (!IsValid(MID)) continue;
+			MID->SetScalarParameterValue(FromParameterName, From);
+			MID->SetScalarParameterValue(ToParameterName, To);
+			MID->SetScalarParameterValue(DurationParameterName, PhaseDuration);
+			MID->SetScalarParameterValue(StartTimeParameterName, StartTime);
+		}
+
+		World->GetTimerManager().SetTimer(TimerHandle_PhaseEnd, this, &UDissolveComponent::FinishPhase, PhaseDuration, false);
+	}
+	else
+	{
+		WriteAmount(From);
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UDissolveComponent::FinishPhase()
+{
+	SetComponentTickEnabled(false);
+	bPhaseActive = false;
+
+	// leave the materials parked on the final value
+	if (bMaterialDriven)
+	{
+		for (UMaterialInstanceDynamic* MID : DynamicMats)
+		{
+			if (!IsValid(MID)) continue;
+			MID->SetScalarParameterValue(FromParameterName, PhaseTo);
+			MID->SetScalarParameterValue(ToParameterName, PhaseTo);
+		}
+	}
+
+	OnDissolveFinished.Broadcast(bPhaseOut);
+}
+
+void UDissolveComponent::WriteAmount(float Value)
+{
+	for (UMaterialInstanceDynamic* MID : DynamicMats)
+	{
+		if (IsValid(MID)) MID->SetScalarParameterValue(AmountParameterName, Value);
+	}
+}
+
+void UDissolveComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bPhaseActive)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	// real frame delta, so a slow frame doesn't slow the dissolve down
+	PhaseElapsed += DeltaTime;
+	const float Alpha = FMath::Clamp(PhaseElapsed / PhaseDuration, 0.f, 1.f);
+	WriteAmount(FMath::Lerp(PhaseFrom, PhaseTo, Alpha));
+
+	if (Alpha >= 1.f)
+	{
+		FinishPhase();
+	}
+}
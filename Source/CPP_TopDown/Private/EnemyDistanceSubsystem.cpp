@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EnemyDistanceSubsystem.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Float.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Int.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+bool UEnemyDistanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UEnemyDistanceSubsystem::Deinitialize()
+{
+	for (FEnemyDistanceEntry& Entry : Entries)
+	{
+		if (UBlackboardComponent* BB = Entry.Blackboard.Get())
+		{
+			BB->UnregisterObserversFrom(this);
+		}
+	}
+
+	Entries.Empty();
+	EntryIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UEnemyDistanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyDistanceSubsystem, STATGROUP_Tickables);
+}
+
+void UEnemyDistanceSubsystem::RegisterEnemy(UBlackboardComponent& Blackboard, AActor* Self,
+	FBlackboard::FKey TargetKey, FBlackboard::FKey DistanceKey, FBlackboard::FKey BandKey,
+	const TArray<float>& Bands, float Hysteresis, float RefreshInterval)
+{
+	UnregisterEnemy(Blackboard);
+
+	if (!Self || DistanceKey == FBlackboard::InvalidKey)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[DistanceBands] %s: missing self actor or distance key, not tracking"), *GetNameSafe(Blackboard.GetOwner()));
+		return;
+	}
+
+	FEnemyDistanceEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Blackboard = &Blackboard;
+	Entry.BlackboardKey = &Blackboard;
+	Entry.Self = Self;
+	Entry.TargetKey = TargetKey;
+	Entry.DistanceKey = DistanceKey;
+	Entry.BandKey = BandKey;
+	Entry.Hysteresis = FMath::Max(0.f, Hysteresis);
+	Entry.RefreshInterval = FMath::Max(0.f, RefreshInterval);
+	Entry.Bands.Append(Bands);
+	Entry.Bands.Sort();
+
+	if (TargetKey != FBlackboard::InvalidKey)
+	{
+		Entry.Target = Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(TargetKey));
+
+		// the target only changes when perception/BeginPlay writes the key, so listen instead of re-reading it every frame
+		Blackboard.RegisterObserver(TargetKey, this,
+			FOnBlackboardChangeNotification::CreateUObject(this, &UEnemyDistanceSubsystem::OnTargetKeyChanged));
+	}
+
+	EntryIndices.Add(&Blackboard, Entries.Num() - 1);
+}
+
+void UEnemyDistanceSubsystem::UnregisterEnemy(UBlackboardComponent& Blackboard)
+{
+	if (const int32* Index = EntryIndices.Find(&Blackboard))
+	{
+		Blackboard.UnregisterObserversFrom(this);
+		RemoveEntryAt(*Index);
+	}
+}
+
+void UEnemyDistanceSubsystem::RemoveEntryAt(int32 Index)
+{
+	EntryIndices.Remove(Entries[Index].BlackboardKey);
+
+	Entries.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	// fix up the index of the entry that was swapped into this slot
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].BlackboardKey, Index);
+	}
+}
+
+EBlackboardNotificationResult UEnemyDistanceSubsystem::OnTargetKeyChanged(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKey)
+{
+	const int32* Index = EntryIndices.Find(&Blackboard);
+	if (!Index)
+	{
+		return EBlackboardNotificationResult::RemoveObserver;
+	}
+
+	FEnemyDistanceEntry& Entry = Entries[*Index];
+	Entry.Target = Cast<AActor>(Blackboard.GetValue<UBlackboardKeyType_Object>(ChangedKey));
+
+	// force a write on the next pass so the new target's distance lands on the blackboard
+	Entry.CurrentBand = INDEX_NONE;
+
+	return EBlackboardNotificationResult::ContinueObserving;
+}
+
+void UEnemyDistanceSubsystem::Tick(float DeltaTime)
+{
+	if (Entries.Num() == 0) return;
+
+	// 1) drop entries whose owner is gone, then gather positions into flat arrays
+	for (int32 i = Entries.Num() - 1; i >= 0; --i)
+	{
+		if (!Entries[i].Self.IsValid() || !Entries[i].Blackboard.IsValid())
+		{
+			RemoveEntryAt(i);
+		}
+	}
+
+	const int32 NumValid = Entries.Num();
+	SelfLocations.SetNumUninitialized(NumValid, EAllowShrinking::No);
+	TargetLocations.SetNumUninitialized(NumValid, EAllowShrinking::No);
+	DistancesSquared.SetNumUninitialized(NumValid, EAllowShrinking::No);
+
+	for (int32 i = 0; i < NumValid; ++i)
+	{
+		const AActor* Target = Entries[i].Target.Get();
+		SelfLocations[i] = Entries[i].Self->GetActorLocation();
+		TargetLocations[i] = Target ? Target->GetActorLocation() : SelfLocations[i];
+	}
+
+	// 2) one tight loop over contiguous data, which the compiler can vectorize
+	for (int32 i = 0; i < NumValid; ++i)
+	{
+		DistancesSquared[i] = FVector::DistSquared(SelfLocations[i], TargetLocations[i]);
+	}
+
+	// 3) only touch the blackboard of enemies that changed band or are due a refresh
+	for (int32 i = 0; i < NumValid; ++i)
+	{
+		FEnemyDistanceEntry& Entry = Entries[i];
+		if (!Entry.Target.IsValid()) continue;
+
+		Entry.TimeSinceWrite += DeltaTime;
+
+		const float Distance = FMath::Sqrt(DistancesSquared[i]);
+		const int32 NewBand = ComputeBand(Entry, Distance);
+
+		if (NewBand != Entry.CurrentBand || (Entry.RefreshInterval > 0.f && Entry.TimeSinceWrite >= Entry.RefreshInterval))
+		{
+			WriteBand(Entry, Distance, NewBand);
+		}
+	}
+}
+
+int32 UEnemyDistanceSubsystem::ComputeBand(const FEnemyDistanceEntry& Entry, float Distance)
+{
+	// raw band = number of thresholds we are beyond
+	int32 RawBand = 0;
+	while (RawBand < Entry.Bands.Num() && Distance >= Entry.Bands[RawBand])
+	{
+		++RawBand;
+	}
+
+	// moving outwards has to clear the threshold by the hysteresis margin; moving inwards is immediate
+	if (Entry.CurrentBand != INDEX_NONE && RawBand > Entry.CurrentBand)
+	{
+		const float CrossedThreshold = Entry.Bands[RawBand - 1];
+		if (Distance < CrossedThreshold + Entry.Hysteresis)
+		{
+			return RawBand - 1 > Entry.CurrentBand ? RawBand - 1 : Entry.CurrentBand;
+		}
+	}
+
+	return RawBand;
+}
+
+void UEnemyDistanceSubsystem::WriteBand(FEnemyDistanceEntry& Entry, float Distance, int32 NewBand)
+{
+	UBlackboardComponent* BB = Entry.Blackboard.Get();
+	if (!BB) return;
+
+	Entry.CurrentBand = NewBand;
+	Entry.TimeSinceWrite = 0.f;
+
+	BB->SetValue<UBlackboardKeyType_Float>(Entry.DistanceKey, Distance);
+
+	if (Entry.BandKey != FBlackboard::InvalidKey)
+	{
+		BB->SetValue<UBlackboardKeyType_Int>(Entry.BandKey, NewBand);
+	}
+}
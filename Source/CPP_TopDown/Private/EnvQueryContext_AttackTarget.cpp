@@ -2,43 +2,136 @@
 
 
 #include "EnvQueryContext_AttackTarget.h"
-#include "AIController.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
+#include "BaseEnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/Character.h"
+#include "EngineUtils.h"
+
+void UEnvQueryContext_AttackTarget::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
+{
+    AActor* Target = nullptr;
+    ProvideSingleActor(QueryInstance.Owner.Get(), Target);
+
+    if (Target)
+    {
+        UEnvQueryItemType_Actor::SetContextHelper(ContextData, Target);
+    }
+}
 
 void UEnvQueryContext_AttackTarget::ProvideSingleActor(UObject* QuerierObject, AActor*& ResultingActor) const
 {
     ResultingActor = nullptr;
     if (!QuerierObject) return;
 
-    // 1) If Querier is an AIController, read its blackboard
-    if (const AAIController* AICon = Cast<AAIController>(QuerierObject))
+    // 1) The enemy controller keeps the target it last perceived
+    const ABaseEnemyController* EnemyController = Cast<ABaseEnemyController>(QuerierObject);
+    if (!EnemyController)
     {
-        if (const UBlackboardComponent* BB = AICon->GetBlackboardComponent())
-        {
-            UObject* Obj = BB->GetValueAsObject(TEXT("Player"));
-            ResultingActor = Cast<AActor>(Obj);
-            if (ResultingActor) return;
-        }
-        // fallback: the controlled pawn might expose the target variable
-        if (APawn* Pawn = AICon->GetPawn())
+        // queries run from the behavior tree use the pawn as querier
+        if (const APawn* PawnQuerier = Cast<APawn>(QuerierObject))
         {
-            // e.g. ABCustomEnemy* E = Cast<ABCustomEnemy>(Pawn); if has variable, use it
+            EnemyController = Cast<ABaseEnemyController>(PawnQuerier->GetController());
         }
     }
 
-    // 2) If Querier is a Pawn/Character directly, try to read stored variable
-    if (APawn* PawnQuerier = Cast<APawn>(QuerierObject))
+    if (EnemyController)
     {
-        // If your Pawn has a stored TargetActor property:
-        // ResultingActor = PawnQuerier->FindComponentByClass<...> or cast and read a variable
+        ResultingActor = EnemyController->GetAttackTarget();
+        if (ResultingActor) return;
     }
 
-    // 3) As ultimate fallback, return the player
-    if (!ResultingActor && GetWorld())
+    // 2) As ultimate fallback, return the player
+    if (GetWorld())
     {
-        ACharacter* PlayerChar = UGameplayStatics::GetPlayerCharacter(GetWorld(), 0);
-        ResultingActor = PlayerChar; // implicit upcast ACharacter* -> AActor*
+        ResultingActor = UGameplayStatics::GetPlayerCharacter(GetWorld(), 0);
     }
 }
+
+namespace AttackTargetContext
+{
+    /** The lookup this context did before the target was cached on the controller */
+    static AActor* ResolveFromBlackboard(const AAIController& Controller)
+    {
+        if (const UBlackboardComponent* BB = Controller.GetBlackboardComponent())
+        {
+            if (AActor* Target = Cast<AActor>(BB->GetValueAsObject(TEXT("Player"))))
+            {
+                return Target;
+            }
+        }
+        return UGameplayStatics::GetPlayerCharacter(&Controller, 0);
+    }
+
+    static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+        TEXT("ai.EQS.BenchmarkAttackTarget"),
+        TEXT("Usage: ai.EQS.BenchmarkAttackTarget [Rounds] [/Game/Path/To/Query.Query]. Resolves the attack target context for every enemy Rounds times (cached vs. blackboard), then optionally runs the query for every enemy in the same frame."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+        {
+            if (!World) return;
+
+            const int32 Rounds = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+
+            TArray<ABaseEnemyController*> Enemies;
+            for (TActorIterator<ABaseEnemyController> It(World); It; ++It)
+            {
+                if (It->GetPawn()) Enemies.Add(*It);
+            }
+
+            if (Enemies.Num() == 0)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("[EQSBench] no possessed enemy controllers in the world"));
+                return;
+            }
+
+            const UEnvQueryContext_AttackTarget* Context = GetDefault<UEnvQueryContext_AttackTarget>();
+            int32 Resolved = 0;
+
+            double Start = FPlatformTime::Seconds();
+            for (int32 Round = 0; Round < Rounds; ++Round)
+            {
+                for (ABaseEnemyController* Enemy : Enemies)
+                {
+                    AActor* Target = nullptr;
+                    Context->ProvideSingleActor(Enemy->GetPawn(), Target);
+                    Resolved += Target != nullptr;
+                }
+            }
+            const double CachedMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+            Start = FPlatformTime::Seconds();
+            for (int32 Round = 0; Round < Rounds; ++Round)
+            {
+                for (ABaseEnemyController* Enemy : Enemies)
+                {
+                    Resolved += ResolveFromBlackboard(*Enemy) != nullptr;
+                }
+            }
+            const double BlackboardMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+            const int32 Lookups = Rounds * Enemies.Num();
+            UE_LOG(LogTemp, Display, TEXT("[EQSBench] %d enemies x %d rounds: cached %.3f ms (%.1f ns/lookup), blackboard %.3f ms (%.1f ns/lookup), %d resolved"),
+                Enemies.Num(), Rounds, CachedMs, CachedMs * 1e6 / Lookups, BlackboardMs, BlackboardMs * 1e6 / Lookups, Resolved);
+
+            // full queries: every enemy asks at once, like a wave of BT RunEQSQuery tasks would
+            UEnvQuery* Query = Args.Num() > 1 ? LoadObject<UEnvQuery>(nullptr, *Args[1]) : nullptr;
+            UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(World);
+            if (!Query || !QueryManager) return;
+
+            int32 WithResult = 0;
+            Start = FPlatformTime::Seconds();
+            for (ABaseEnemyController* Enemy : Enemies)
+            {
+                FEnvQueryRequest Request(Query, Enemy->GetPawn());
+                TSharedPtr<FEnvQueryResult> Result = QueryManager->RunInstantQuery(Request, EEnvQueryRunMode::SingleResult);
+                WithResult += (Result.IsValid() && Result->IsSuccessful()) ? 1 : 0;
+            }
+            const double QueryMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+            UE_LOG(LogTemp, Display, TEXT("[EQSBench] %s for %d enemies: %.3f ms total, %.3f ms/query, %d with a result"),
+                *Query->GetName(), Enemies.Num(), QueryMs, QueryMs / Enemies.Num(), WithResult);
+        }));
+}
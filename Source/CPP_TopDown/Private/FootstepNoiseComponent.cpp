@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FootstepNoiseComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Perception/AISense_Hearing.h"
+#include "PerceptionGridSubsystem.h"
+#include "EngineUtils.h"
+
+namespace FootstepNoise
+{
+	static FAutoConsoleCommandWithWorld StatsCommand(
+		TEXT("ai.Footsteps.Stats"),
+		TEXT("Prints how many movement inputs turned into footstep noise events"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			for (TActorIterator<AController> It(World); It; ++It)
+			{
+				if (const UFootstepNoiseComponent* Footsteps = It->FindComponentByClass<UFootstepNoiseComponent>())
+				{
+					UE_LOG(LogTemp, Display, TEXT("[Footsteps] %s: %d movement inputs, %d noise events, %d skipped (no listener in range)"),
+						*It->GetName(), Footsteps->NumMovementInputs, Footsteps->NumReported, Footsteps->NumSkippedNoListener);
+				}
+			}
+		}));
+}
+
+// Sets default values for this component's properties
+UFootstepNoiseComponent::UFootstepNoiseComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UFootstepNoiseComponent::ReportMovement(float LoudnessScale)
+{
+	const AController* Controller = Cast<AController>(GetOwner());
+	APawn* Pawn = Controller ? Controller->GetPawn() : Cast<APawn>(GetOwner());
+	if (!Pawn) return;
+
+	++NumMovementInputs;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const bool bFirstStep = (Now - LastMovementTime) > StillnessResetTime;
+	LastMovementTime = Now;
+
+	PendingLoudness = FMath::Max(PendingLoudness, Loudness * LoudnessScale);
+
+	// keep merging until we've covered a stride (or just started moving)
+	const FVector Location = Pawn->GetActorLocation();
+	if (!bFirstStep && FVector::DistSquared2D(Location, LastReportLocation) < FMath::Square(StrideDistance))
+	{
+		return;
+	}
+
+	LastReportLocation = Location;
+	EmitNoise(*Pawn, PendingLoudness);
+	PendingLoudness = 0.f;
+}
+
+void UFootstepNoiseComponent::EmitNoise(APawn& Pawn, float MergedLoudness)
+{
+	const FVector Location = Pawn.GetActorLocation();
+
+	// nobody close enough to hear it: don't wake the perception system at all.
+	// Only the grid's listeners are known, so with enemies on stock sight the noise is always reported
+	const UPerceptionGridSubsystem* Grid = GetWorld()->GetSubsystem<UPerceptionGridSubsystem>();
+	if (Grid && Grid->CanCullNoise() && !Grid->HasListenerWithinRadius(Location, NoiseRange))
+	{
+		++NumSkippedNoListener;
+		return;
+	}
+
+	UAISense_Hearing::ReportNoiseEvent(GetWorld(), Location, MergedLoudness, &Pawn, NoiseRange);
+	++NumReported;
+}
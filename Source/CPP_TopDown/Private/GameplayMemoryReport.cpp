@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// "game.MemReport": per-enemy and total memory footprint of the gameplay systems tagged for LLM
+// (spell pools, HP widgets, dynamic materials, perception, behavior trees). LLM gives exact totals
+// per tag; this report attributes the same systems to individual enemies so budgets can be set.
+
+#include "CoreMinimal.h"
+#include "CPP_TopDown.h"
+#include "AC_ObjectPool.h"
+#include "PooledActor.h"
+#include "BaseEnemyCharacter.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Blueprint/UserWidget.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+namespace GameplayMemoryReport
+{
+	struct FFootprint
+	{
+		int64 Bytes = 0;
+		int32 Objects = 0;
+
+		FFootprint& operator+=(const FFootprint& Other)
+		{
+			Bytes += Other.Bytes;
+			Objects += Other.Objects;
+			return *this;
+		}
+	};
+
+	enum ECategory
+	{
+		SpellPools,
+		EnemyWidgets,
+		DynamicMaterials,
+		Perception,
+		BehaviorTrees,
+		NumCategories
+	};
+
+	static const TCHAR* CategoryNames[NumCategories] = { TEXT("Pools"), TEXT("Widgets"), TEXT("MIDs"), TEXT("Perception"), TEXT("BT") };
+
+	/** UObject memory (same counter as "obj list") plus resources it owns */
+	static FFootprint MeasureObject(UObject* Object)
+	{
+		FFootprint Result;
+		if (!IsValid(Object)) return Result;
+
+		FArchiveCountMem Count(Object);
+		Result.Bytes = int64(Count.GetMax()) + int64(Object->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal));
+		Result.Objects = 1;
+		return Result;
+	}
+
+	/** Object plus everything outered to it (widget trees, blackboard data, ...) */
+	static FFootprint MeasureObjectTree(UObject* Object)
+	{
+		FFootprint Result = MeasureObject(Object);
+		if (!IsValid(Object)) return Result;
+
+		TArray<UObject*> Inner;
+		GetObjectsWithOuter(Object, Inner, true);
+		for (UObject* Child : Inner)
+		{
+			Result += MeasureObject(Child);
+		}
+		return Result;
+	}
+
+	static FFootprint MeasureActor(AActor* Actor)
+	{
+		FFootprint Result = MeasureObject(Actor);
+		if (!IsValid(Actor)) return Result;
+
+		for (UActorComponent* Component : Actor->GetComponents())
+		{
+			Result += MeasureObject(Component);
+		}
+		return Result;
+	}
+
+	static FFootprint MeasurePool(UAC_ObjectPool* Pool)
+	{
+		FFootprint Result = MeasureObject(Pool);
+		if (!Pool) return Result;
+
+		TArray<APooledActor*> Actors;
+		Pool->GetAllPooledActors(Actors);
+		for (APooledActor* Actor : Actors)
+		{
+			Result += MeasureActor(Actor);
+		}
+		return Result;
+	}
+
+	static void MeasureEnemy(ABaseEnemyCharacter* Enemy, FFootprint (&Out)[NumCategories])
+	{
+		TArray<UAC_ObjectPool*> Pools;
+		Enemy->GetComponents<UAC_ObjectPool>(Pools);
+		for (UAC_ObjectPool* Pool : Pools)
+		{
+			Out[SpellPools] += MeasurePool(Pool);
+		}
+
+		TArray<UWidgetComponent*> Widgets;
+		Enemy->GetComponents<UWidgetComponent>(Widgets);
+		for (UWidgetComponent* Widget : Widgets)
+		{
+			Out[EnemyWidgets] += MeasureObject(Widget);
+			Out[EnemyWidgets] += MeasureObjectTree(Widget->GetUserWidgetObject());
+		}
+
+		// hit flash and dissolve MIDs both end up on the mesh slots
+		TArray<UMeshComponent*> Meshes;
+		Enemy->GetComponents<UMeshComponent>(Meshes);
+		for (UMeshComponent* Mesh : Meshes)
+		{
+			for (int32 i = 0; i < Mesh->GetNumMaterials(); ++i)
+			{
+				if (UMaterialInstanceDynamic* MID = Cast<UMaterialInstanceDynamic>(Mesh->GetMaterial(i)))
+				{
+					Out[DynamicMaterials] += MeasureObject(MID);
+				}
+			}
+		}
+
+		if (AAIController* AI = Cast<AAIController>(Enemy->GetController()))
+		{
+			Out[Perception] += MeasureObjectTree(AI->GetPerceptionComponent());
+			Out[BehaviorTrees] += MeasureObjectTree(AI->GetBrainComponent());
+			Out[BehaviorTrees] += MeasureObjectTree(AI->GetBlackboardComponent());
+		}
+	}
+
+	static FString FormatKB(int64 Bytes)
+	{
+		return FString::Printf(TEXT("%8.1f KB"), Bytes / 1024.0);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs ReportCommand(
+		TEXT("game.MemReport"),
+		TEXT("Prints per-enemy and total memory for spell pools, HP widgets, MIDs, perception and behavior trees. Pass 'all' to list every enemy."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (!World) return;
+
+			const bool bListAll = Args.Num() > 0 && Args[0] == TEXT("all");
+
+			FFootprint Totals[NumCategories];
+			int32 NumEnemies = 0;
+
+			for (TActorIterator<ABaseEnemyCharacter> It(World); It; ++It)
+			{
+				FFootprint PerEnemy[NumCategories];
+				MeasureEnemy(*It, PerEnemy);
+
+				int64 EnemyTotal = 0;
+				FString Line;
+				for (int32 c = 0; c < NumCategories; ++c)
+				{
+					Totals[c] += PerEnemy[c];
+					EnemyTotal += PerEnemy[c].Bytes;
+					Line += FString::Printf(TEXT("  %s %s"), CategoryNames[c], *FormatKB(PerEnemy[c].Bytes));
+				}
+
+				if (bListAll)
+				{
+					UE_LOG(LogTemp, Display, TEXT("[MemReport] %-32s%s  total %s"), *It->GetName(), *Line, *FormatKB(EnemyTotal));
+				}
+				++NumEnemies;
+			}
+
+			// pools on anything that isn't an enemy (the player, spawners)
+			FFootprint OtherPools;
+			for (TObjectIterator<UAC_ObjectPool> It; It; ++It)
+			{
+				if (It->GetWorld() == World && !Cast<ABaseEnemyCharacter>(It->GetOwner()))
+				{
+					OtherPools += MeasurePool(*It);
+				}
+			}
+
+			int64 GrandTotal = 0;
+			UE_LOG(LogTemp, Display, TEXT("[MemReport] %d enemies"), NumEnemies);
+			for (int32 c = 0; c < NumCategories; ++c)
+			{
+				GrandTotal += Totals[c].Bytes;
+				UE_LOG(LogTemp, Display, TEXT("[MemReport]   %-10s total %s  per enemy %s  (%d objects)"),
+					CategoryNames[c], *FormatKB(Totals[c].Bytes), *FormatKB(NumEnemies > 0 ? Totals[c].Bytes / NumEnemies : 0), Totals[c].Objects);
+			}
+			UE_LOG(LogTemp, Display, TEXT("[MemReport]   enemies    total %s  per enemy %s"),
+				*FormatKB(GrandTotal), *FormatKB(NumEnemies > 0 ? GrandTotal / NumEnemies : 0));
+			UE_LOG(LogTemp, Display, TEXT("[MemReport]   other pools     %s  (%d objects)"), *FormatKB(OtherPools.Bytes), OtherPools.Objects);
+		}));
+}
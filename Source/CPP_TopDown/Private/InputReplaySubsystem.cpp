@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InputReplaySubsystem.h"
+#include "CPP_TopDownPlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+
+namespace InputReplay
+{
+	static constexpr uint32 FileMagic = 0x57445250; // "WDRP"
+	static constexpr int32 FileVersion = 1;
+
+	static UInputReplaySubsystem* Get(UWorld* World)
+	{
+		return World ? World->GetSubsystem<UInputReplaySubsystem>() : nullptr;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordCommand(
+		TEXT("replay.Record"),
+		TEXT("Starts recording player input. Args: [Seed=0] [FPS=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UInputReplaySubsystem* Replay = Get(World))
+			{
+				const int32 Seed = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 0;
+				const float FPS = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 60.f;
+				Replay->StartRecording(Seed, FPS);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StopCommand(
+		TEXT("replay.Stop"),
+		TEXT("Stops recording (saving to Saved/InputReplays/<Name>.replay) or playback. Args: [Name=Last]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UInputReplaySubsystem* Replay = Get(World))
+			{
+				if (Replay->IsRecording())
+				{
+					Replay->StopRecording(Args.Num() > 0 ? Args[0] : TEXT("Last"));
+				}
+				else
+				{
+					Replay->StopPlayback();
+				}
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs PlayCommand(
+		TEXT("replay.Play"),
+		TEXT("Plays back a recording from Saved/InputReplays. Args: [Name=Last]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UInputReplaySubsystem* Replay = Get(World))
+			{
+				Replay->StartPlayback(Args.Num() > 0 ? Args[0] : TEXT("Last"));
+			}
+		}));
+}
+
+void UInputReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// outside of a session the stream still gets a fixed seed, so test runs are repeatable by default
+	int32 Seed = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("ReplaySeed="), Seed);
+	GameplayRandom.Initialize(Seed);
+}
+
+bool UInputReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UInputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const TCHAR* CmdLine = FCommandLine::Get();
+
+	FString Name;
+	if (FParse::Value(CmdLine, TEXT("InputReplay="), Name))
+	{
+		bExitAfterPlayback = FParse::Param(CmdLine, TEXT("ReplayExit"));
+		StartPlayback(Name);
+	}
+	else if (FParse::Value(CmdLine, TEXT("InputRecord="), AutoRecordName))
+	{
+		int32 Seed = 0;
+		float FPS = 60.f;
+		FParse::Value(CmdLine, TEXT("ReplaySeed="), Seed);
+		FParse::Value(CmdLine, TEXT("ReplayFPS="), FPS);
+		StartRecording(Seed, FPS);
+	}
+}
+
+void UInputReplaySubsystem::Deinitialize()
+{
+	if (bRecording && !AutoRecordName.IsEmpty())
+	{
+		StopRecording(AutoRecordName);
+	}
+
+	EndSession();
+	Events.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UInputReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputReplaySubsystem, STATGROUP_Tickables);
+}
+
+void UInputReplaySubsystem::RegisterController(ACPP_TopDownPlayerController* InController)
+{
+	Controller = InController;
+}
+
+FString UInputReplaySubsystem::GetReplayPath(const FString& Name)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputReplays"), Name + TEXT(".replay"));
+}
+
+bool UInputReplaySubsystem::BeginSession(int32 Seed, float FPS)
+{
+	if (!Session.Begin(Seed, FPS)) return false;
+
+	SessionFrame = 0;
+	PlaybackCursor = 0;
+	GameplayRandom.Initialize(Seed);
+	return true;
+}
+
+void UInputReplaySubsystem::EndSession()
+{
+	if (!bRecording && !bPlayingBack) return;
+
+	bRecording = false;
+	bPlayingBack = false;
+
+	Session.End();
+}
+
+bool UInputReplaySubsystem::StartRecording(int32 Seed, float FPS)
+{
+	EndSession();
+
+	if (!BeginSession(Seed, FPS)) return false;
+
+	Events.Reset();
+	bRecording = true;
+
+	UE_LOG(LogTemp, Display, TEXT("[InputReplay] recording, seed %d at %.0f fps"), Session.GetSeed(), Session.GetFPS());
+	return true;
+}
+
+bool UInputReplaySubsystem::StopRecording(const FString& Name)
+{
+	if (!bRecording) return false;
+
+	FReplayFileHeader Header;
+	Header.Magic = InputReplay::FileMagic;
+	Header.Version = InputReplay::FileVersion;
+	Header.Seed = Session.GetSeed();
+	Header.FPS = Session.GetFPS();
+	Header.Frames = SessionFrame;
+
+	EndSession();
+
+	const FString Path = GetReplayPath(Name);
+	const int32 Bytes = Session.Save(Path, Header, [this](FArchive& Ar) { Ar << Events; });
+	if (Bytes == INDEX_NONE) return false;
+
+	UE_LOG(LogTemp, Display, TEXT("[InputReplay] saved %d events over %d frames to %s"), Events.Num(), Header.Frames, *Path);
+	return true;
+}
+
+bool UInputReplaySubsystem::StartPlayback(const FString& Name)
+{
+	EndSession();
+
+	const FString Path = GetReplayPath(Name);
+
+	FReplayFileHeader Header;
+	if (!Session.Load(Path, InputReplay::FileMagic, InputReplay::FileVersion, Header, [this](FArchive& Ar) { Ar << Events; }))
+	{
+		Events.Reset();
+		return false;
+	}
+
+	if (!BeginSession(Header.Seed, Header.FPS))
+	{
+		Events.Reset();
+		return false;
+	}
+
+	PlaybackFrames = Header.Frames;
+	FrameMismatches = 0;
+	bPlayingBack = true;
+
+	UE_LOG(LogTemp, Display, TEXT("[InputReplay] playing %d events over %d frames from %s (seed %d, %.0f fps)"),
+		Events.Num(), Header.Frames, *Path, Header.Seed, Session.GetFPS());
+	return true;
+}
+
+void UInputReplaySubsystem::StopPlayback()
+{
+	if (!bPlayingBack) return;
+
+	EndSession();
+
+	// round trip check: every event has to run on the frame it was recorded on, and none may be left over
+	FrameMismatches += Events.Num() - PlaybackCursor;
+	if (FrameMismatches > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[InputReplay] playback finished after %d frames, %d of %d events didn't run on their recorded frame"),
+			SessionFrame, FrameMismatches, Events.Num());
+	}
+	else
+	{
+		UE_LOG(LogTemp, Display, TEXT("[InputReplay] playback finished after %d frames, all %d events on their recorded frame"), SessionFrame, Events.Num());
+	}
+
+	if (bExitAfterPlayback)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, FrameMismatches > 0 ? 1 : 0);
+	}
+}
+
+bool UInputReplaySubsystem::OnLiveInput(EReplayedInput Input, const FVector2D& Value)
+{
+	if (bPlayingBack) return false;
+
+	if (bRecording)
+	{
+		FRecordedInputEvent& Event = Events.AddDefaulted_GetRef();
+		Event.Frame = SessionFrame;
+		Event.Input = Input;
+		Event.Value = Value;
+	}
+	return true;
+}
+
+void UInputReplaySubsystem::DispatchRecordedInput()
+{
+	if (!bPlayingBack) return;
+
+	ACPP_TopDownPlayerController* PC = Controller.Get();
+	while (PlaybackCursor < Events.Num() && Events[PlaybackCursor].Frame <= SessionFrame)
+	{
+		const FRecordedInputEvent& Event = Events[PlaybackCursor++];
+		if (Event.Frame != SessionFrame)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[InputReplay] event %d recorded on frame %d ran on frame %d"), PlaybackCursor - 1, Event.Frame, SessionFrame);
+			++FrameMismatches;
+		}
+
+		if (PC)
+		{
+			PC->ApplyRecordedInput(Event.Input, Event.Value);
+		}
+	}
+}
+
+void UInputReplaySubsystem::Tick(float DeltaTime)
+{
+	if (!bRecording && !bPlayingBack) return;
+
+	// tickables run after the actors, so this is the boundary between frame N and N+1.
+	// Playback events were already dispatched by the controller this frame, exactly where they were recorded
+	++SessionFrame;
+
+	// keep running until the recorded session length; past it, anything still queued can't run on its frame anymore
+	if (bPlayingBack && SessionFrame >= PlaybackFrames && (PlaybackCursor >= Events.Num() || SessionFrame > PlaybackFrames))
+	{
+		StopPlayback();
+	}
+}
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PatrolCrowdSubsystem.h"
+#include "PatrolRoute.h"
+#include "BaseEnemyCharacter.h"
+#include "BaseEnemyController.h"
+
+bool UPatrolCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPatrolCrowdSubsystem::Deinitialize()
+{
+	Groups.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UPatrolCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPatrolCrowdSubsystem, STATGROUP_Tickables);
+}
+
+int32 UPatrolCrowdSubsystem::GetNumMembers() const
+{
+	int32 Num = 0;
+	for (const FPatrolCrowdGroup& Group : Groups)
+	{
+		Num += Group.Members.Num();
+	}
+	return Num;
+}
+
+void UPatrolCrowdSubsystem::JoinCrowd(APatrolRoute* Route, ABaseEnemyCharacter* Enemy)
+{
+	if (!Route || !Enemy) return;
+
+	LeaveCrowd(Enemy);
+
+	FPatrolCrowdGroup* Group = Groups.FindByPredicate([Route](const FPatrolCrowdGroup& G) { return G.Route.Get() == Route; });
+	if (!Group)
+	{
+		Group = &Groups.AddDefaulted_GetRef();
+		Group->Route = Route;
+	}
+
+	Group->Members.Add(Enemy);
+	RestaggerGroup(*Group);
+}
+
+void UPatrolCrowdSubsystem::LeaveCrowd(ABaseEnemyCharacter* Enemy)
+{
+	for (int32 GroupIndex = Groups.Num() - 1; GroupIndex >= 0; --GroupIndex)
+	{
+		FPatrolCrowdGroup& Group = Groups[GroupIndex];
+		if (Group.Members.Remove(Enemy) == 0) continue;
+
+		if (Group.Members.Num() == 0)
+		{
+			Groups.RemoveAtSwap(GroupIndex);
+		}
+		else
+		{
+			RestaggerGroup(Group);
+		}
+		return;
+	}
+}
+
+void UPatrolCrowdSubsystem::RestaggerGroup(FPatrolCrowdGroup& Group)
+{
+	const APatrolRoute* Route = Group.Route.Get();
+	const int32 NumMembers = Group.Members.Num();
+
+	Group.Offsets.SetNumZeroed(NumMembers);
+	Group.SlotLocations.SetNumZeroed(NumMembers);
+	if (!Route || NumMembers == 0) return;
+
+	// the route may not have baked yet if members joined during BeginPlay; Tick retries once it has
+	const float Cycle = Route->GetPatrolCycleLength();
+	Group.StaggeredCycle = Cycle;
+	if (Cycle <= 0.f) return;
+
+	const float MinSpacing = Route->GetCrowdMinSpacing();
+	float Spacing = 0.f;
+
+	if (Route->IsClosedLoop())
+	{
+		Spacing = FMath::Max(Cycle / NumMembers, MinSpacing);
+
+		if (Spacing * NumMembers > Cycle + KINDA_SMALL_NUMBER)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[PatrolCrowd] %s: %d members don't fit %.0f apart on a %.0f loop, some will overlap"),
+				*Route->GetName(), NumMembers, MinSpacing, Cycle);
+		}
+	}
+	else
+	{
+		// open routes are walked there and back. Offsets spread over the round trip would put members heading
+		// opposite ways on the same stretch, so the group walks as one column packed MinSpacing apart that turns
+		// around together; the shorter the column, the more of the route its rear gets to patrol
+		const float RouteLength = Route->GetRouteLength();
+		Spacing = MinSpacing;
+
+		if (NumMembers > 1 && Spacing * (NumMembers - 1) > RouteLength)
+		{
+			Spacing = RouteLength / (NumMembers - 1);
+
+			UE_LOG(LogTemp, Warning, TEXT("[PatrolCrowd] %s: %d members don't fit %.0f apart on a %.0f route, squeezing them to %.0f"),
+				*Route->GetName(), NumMembers, MinSpacing, RouteLength, Spacing);
+		}
+	}
+
+	for (int32 i = 0; i < NumMembers; ++i)
+	{
+		Group.Offsets[i] = i * Spacing;
+	}
+}
+
+void UPatrolCrowdSubsystem::Tick(float DeltaTime)
+{
+	for (int32 GroupIndex = Groups.Num() - 1; GroupIndex >= 0; --GroupIndex)
+	{
+		FPatrolCrowdGroup& Group = Groups[GroupIndex];
+
+		// drop destroyed members / routes
+		bool bChanged = false;
+		for (int32 i = Group.Members.Num() - 1; i >= 0; --i)
+		{
+			if (!Group.Members[i].IsValid())
+			{
+				Group.Members.RemoveAt(i);
+				bChanged = true;
+			}
+		}
+
+		if (!Group.Route.IsValid() || Group.Members.Num() == 0)
+		{
+			Groups.RemoveAtSwap(GroupIndex);
+			continue;
+		}
+
+		if (bChanged || Group.StaggeredCycle != Group.Route->GetPatrolCycleLength())
+		{
+			RestaggerGroup(Group);
+		}
+
+		EvaluateGroup(Group, DeltaTime);
+	}
+}
+
+void UPatrolCrowdSubsystem::EvaluateGroup(FPatrolCrowdGroup& Group, float DeltaTime)
+{
+	const APatrolRoute* Route = Group.Route.Get();
+	const float Cycle = Route->GetPatrolCycleLength();
+	if (Cycle <= 0.f) return;
+
+	// 1) all slots in one pass over the baked samples
+	const int32 NumMembers = Group.Members.Num();
+	const float Step = Route->GetCrowdSpeed() * DeltaTime;
+
+	if (Route->IsClosedLoop())
+	{
+		Group.Phase = FMath::Fmod(Group.Phase + Step, Cycle);
+
+		for (int32 i = 0; i < NumMembers; ++i)
+		{
+			Group.SlotLocations[i] = Route->GetLocationAtCycleDistance(Group.Phase + Group.Offsets[i]);
+		}
+	}
+	else
+	{
+		// the column's rear walks whatever part of the route the column doesn't cover, then everyone turns around together
+		const float Travel = FMath::Max(Route->GetRouteLength() - Group.Offsets.Last(), 0.f);
+		Group.Phase = Travel > 0.f ? FMath::Fmod(Group.Phase + Step, 2.f * Travel) : 0.f;
+
+		const float Rear = Group.Phase <= Travel ? Group.Phase : 2.f * Travel - Group.Phase;
+		for (int32 i = 0; i < NumMembers; ++i)
+		{
+			Group.SlotLocations[i] = Route->GetLocationAtDistance(Rear + Group.Offsets[i]);
+		}
+	}
+
+	// 2) hand the slots to the members; only patrolling members get steered (their BT patrol task stands by), the rest keep their BT
+	const float AcceptanceRadiusSq = FMath::Square(Route->GetAcceptanceRadius());
+	for (int32 i = 0; i < NumMembers; ++i)
+	{
+		ABaseEnemyCharacter* Enemy = Group.Members[i].Get();
+		Enemy->SetCrowdSlotLocation(Group.SlotLocations[i]);
+
+		const ABaseEnemyController* Controller = Cast<ABaseEnemyController>(Enemy->GetController());
+		if (Controller && Controller->GetEnemyState() != EEnemyStates::Passive) continue;
+
+		const FVector ToSlot = FVector(Group.SlotLocations[i] - Enemy->GetActorLocation()) * FVector(1.f, 1.f, 0.f);
+		if (ToSlot.SizeSquared() > AcceptanceRadiusSq)
+		{
+			Enemy->AddMovementInput(ToSlot.GetSafeNormal());
+		}
+	}
+}
@@ -7,8 +7,8 @@
 APatrolRoute::APatrolRoute()
 {
 	Spline = CreateDefaultSubobject<USplineComponent>(TEXT("PatrolRoute"));
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Everything is baked at BeginPlay, nothing to do per frame
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
@@ -16,43 +16,103 @@ APatrolRoute::APatrolRoute()
 void APatrolRoute::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	BakeRoute();
+	DefaultCursor = MakeCursor(0);
 }
 
-// Called every frame
-void APatrolRoute::Tick(float DeltaTime)
+void APatrolRoute::BakeRoute()
 {
-	Super::Tick(DeltaTime);
+	Waypoints.Reset();
+	Samples.Reset();
+	RouteLength = 0.f;
 
-    const int32 NumPoints = Spline->GetNumberOfSplinePoints();
-    if (NumPoints < 2) return;
+	if (!Spline) return;
 
-    // compute next index and flip at ends
-    NextPoint = CurrentPatrolPoint + PatrolDirection;
-    if (NextPoint >= NumPoints)
-    {
-        PatrolDirection = -1;
-        NextPoint = CurrentPatrolPoint + PatrolDirection;
-    }
-    else if (NextPoint < 0)
-    {
-        PatrolDirection = 1;
-        NextPoint = CurrentPatrolPoint + PatrolDirection;
-    }
+	const int32 NumPoints = Spline->GetNumberOfSplinePoints();
+	Waypoints.Reserve(NumPoints);
+	for (int32 i = 0; i < NumPoints; ++i)
+	{
+		Waypoints.Add(Spline->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World));
+	}
 
-    // 2) Ask the spline for its world location at that point
-    TargetLocation = Spline->GetLocationAtSplinePoint(NextPoint, ESplineCoordinateSpace::World);
+	// even arc-length samples, so distance -> location is an index + lerp
+	RouteLength = Spline->GetSplineLength();
+	bClosedLoop = Spline->IsClosedLoop();
+	const int32 NumSamples = FMath::Max(2, FMath::CeilToInt32(RouteLength / SampleSpacing) + 1);
+	SampleStep = RouteLength / (NumSamples - 1);
+	Samples.Reserve(NumSamples);
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Samples.Add(Spline->GetLocationAtDistanceAlongSpline(i * SampleStep, ESplineCoordinateSpace::World));
+	}
 }
 
-// Returns whatever was most recently computed in Tick()
-FVector APatrolRoute::GetWorldSplineLocation() const
+FPatrolCursor APatrolRoute::MakeCursor(int32 StartPoint) const
 {
-    return TargetLocation;
+	FPatrolCursor Cursor;
+	// read the count from the spline so cursors can be made before this route has baked
+	const int32 NumPoints = Spline ? Spline->GetNumberOfSplinePoints() : Waypoints.Num();
+	if (NumPoints < 2) return Cursor;
+
+	Cursor.CurrentPoint = FMath::Clamp(StartPoint, 0, NumPoints - 1);
+	Cursor.Direction = Cursor.CurrentPoint == NumPoints - 1 ? -1 : 1;
+	Cursor.NextPoint = Cursor.CurrentPoint + Cursor.Direction;
+	return Cursor;
 }
 
-void APatrolRoute::AdvancePatrolPoint()
+FVector APatrolRoute::GetCursorLocation(const FPatrolCursor& Cursor) const
+{
+	return Waypoints.IsValidIndex(Cursor.NextPoint) ? Waypoints[Cursor.NextPoint] : GetActorLocation();
+}
+
+void APatrolRoute::AdvanceCursor(FPatrolCursor& Cursor) const
+{
+	const int32 NumPoints = Waypoints.Num();
+	if (NumPoints < 2) return;
+
+	Cursor.CurrentPoint = Cursor.NextPoint;
+
+	// compute next index and flip at ends
+	Cursor.NextPoint = Cursor.CurrentPoint + Cursor.Direction;
+	if (Cursor.NextPoint >= NumPoints || Cursor.NextPoint < 0)
+	{
+		Cursor.Direction = -Cursor.Direction;
+		Cursor.NextPoint = Cursor.CurrentPoint + Cursor.Direction;
+	}
+}
+
+FVector APatrolRoute::GetLocationAtDistance(float Distance) const
 {
-    CurrentPatrolPoint = NextPoint;
+	if (Samples.Num() < 2 || SampleStep <= 0.f) return Samples.Num() > 0 ? Samples[0] : GetActorLocation();
+
+	const float SampleIndex = FMath::Clamp(Distance, 0.f, RouteLength) / SampleStep;
+	const int32 Index = FMath::Min(FMath::FloorToInt32(SampleIndex), Samples.Num() - 2);
+	return FMath::Lerp(Samples[Index], Samples[Index + 1], SampleIndex - Index);
+}
+
+FVector APatrolRoute::GetLocationAtCycleDistance(float CycleDistance) const
+{
+	const float Cycle = GetPatrolCycleLength();
+	if (Cycle <= 0.f) return GetLocationAtDistance(0.f);
+
+	float Distance = FMath::Fmod(CycleDistance, Cycle);
+	if (Distance < 0.f) Distance += Cycle;
+
+	// second half of an open route's cycle is the walk back
+	if (!bClosedLoop && Distance > RouteLength)
+	{
+		Distance = Cycle - Distance;
+	}
+	return GetLocationAtDistance(Distance);
 }
 
+FVector APatrolRoute::GetWorldSplineLocation() const
+{
+    return GetCursorLocation(DefaultCursor);
+}
 
+void APatrolRoute::AdvancePatrolPoint()
+{
+    AdvanceCursor(DefaultCursor);
+}
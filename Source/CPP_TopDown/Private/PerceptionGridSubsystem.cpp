@@ -0,0 +1,282 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PerceptionGridSubsystem.h"
+#include "BaseEnemyController.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+namespace PerceptionGrid
+{
+	static int32 MaxTracesPerFrame = 16;
+	static FAutoConsoleVariableRef CVarMaxTracesPerFrame(
+		TEXT("ai.PerceptionGrid.MaxTracesPerFrame"),
+		MaxTracesPerFrame,
+		TEXT("Line of sight traces the perception grid may issue per frame"));
+
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("ai.PerceptionGrid.Stats"),
+		TEXT("Prints grid sight counters vs. what stock sight would do. Pass 'reset' to clear them."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UPerceptionGridSubsystem* Grid = World ? World->GetSubsystem<UPerceptionGridSubsystem>() : nullptr;
+			if (!Grid) return;
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				Grid->ResetStats();
+				return;
+			}
+
+			const FPerceptionGridStats& S = Grid->GetStats();
+			const double Frames = FMath::Max<double>(S.Frames, 1);
+			UE_LOG(LogTemp, Display, TEXT("[PerceptionGrid] %llu frames, %d listeners (peak %d)"), S.Frames, Grid->GetNumListeners(), S.PeakListeners);
+			UE_LOG(LogTemp, Display, TEXT("[PerceptionGrid] pair checks/frame: stock %.1f, grid %.1f"), S.StockPairChecks / Frames, S.GridPairChecks / Frames);
+			UE_LOG(LogTemp, Display, TEXT("[PerceptionGrid] LOS traces/frame: requested %.1f, issued %.1f (budget %d)"), S.TracesRequested / Frames, S.TracesIssued / Frames, MaxTracesPerFrame);
+		}));
+}
+
+bool UPerceptionGridSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPerceptionGridSubsystem::Deinitialize()
+{
+	Listeners.Empty();
+	Targets.Empty();
+	UnscheduledListeners.Empty();
+	ListenerGrid.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UPerceptionGridSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPerceptionGridSubsystem, STATGROUP_Tickables);
+}
+
+void UPerceptionGridSubsystem::RegisterListener(ABaseEnemyController* Controller)
+{
+	if (!Controller || !Controller->SightConfig) return;
+
+	UnregisterListener(Controller);
+
+	const UAISenseConfig_Sight* Sight = Controller->SightConfig;
+
+	FListener& Listener = Listeners.AddDefaulted_GetRef();
+	Listener.Controller = Controller;
+	Listener.SightRadiusSq = FMath::Square(Sight->SightRadius);
+	Listener.LoseSightRadiusSq = FMath::Square(FMath::Max(Sight->LoseSightRadius, Sight->SightRadius));
+	Listener.CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(Sight->PeripheralVisionAngleDegrees));
+
+	MaxQueryRadius = FMath::Max(MaxQueryRadius, FMath::Max(Sight->LoseSightRadius, Sight->SightRadius));
+
+	// cells about the size of the query keep the neighbourhood to a 3x3 block
+	if (!FMath::IsNearlyEqual(ListenerGrid.GetCellSize(), MaxQueryRadius))
+	{
+		ListenerGrid.SetCellSize(MaxQueryRadius);
+	}
+
+	Stats.PeakListeners = FMath::Max(Stats.PeakListeners, Listeners.Num());
+}
+
+void UPerceptionGridSubsystem::UnregisterListener(ABaseEnemyController* Controller)
+{
+	const int32 Index = Listeners.IndexOfByPredicate([Controller](const FListener& L) { return L.Controller.Get() == Controller; });
+	if (Index != INDEX_NONE)
+	{
+		Listeners.RemoveAtSwap(Index, EAllowShrinking::No);
+	}
+
+	UnscheduledListeners.RemoveSwap(Controller, EAllowShrinking::No);
+}
+
+void UPerceptionGridSubsystem::RegisterUnscheduledListener(ABaseEnemyController* Controller)
+{
+	if (Controller)
+	{
+		UnscheduledListeners.AddUnique(Controller);
+	}
+}
+
+void UPerceptionGridSubsystem::RegisterTarget(AActor* Target)
+{
+	if (Target)
+	{
+		Targets.AddUnique(Target);
+	}
+}
+
+void UPerceptionGridSubsystem::UnregisterTarget(AActor* Target)
+{
+	Targets.Remove(Target);
+}
+
+bool UPerceptionGridSubsystem::HasListenerWithinRadius(const FVector& Location, float Radius) const
+{
+	return ListenerGrid.AnyInRadius(Location, Radius);
+}
+
+void UPerceptionGridSubsystem::Tick(float DeltaTime)
+{
+	++FrameCounter;
+
+	Targets.RemoveAllSwap([](const TWeakObjectPtr<AActor>& T) { return !T.IsValid(); }, EAllowShrinking::No);
+
+	RebuildListenerGrid();
+
+	if (Listeners.Num() > 0 && Targets.Num() > 0)
+	{
+		++Stats.Frames;
+		Stats.StockPairChecks += uint64(Listeners.Num()) * Targets.Num();
+
+		GatherCandidates();
+		RunTraces();
+	}
+
+	// also runs without targets, so listeners lose sight of the last one when it unregisters
+	ExpireOutOfRangeTargets();
+}
+
+void UPerceptionGridSubsystem::RebuildListenerGrid()
+{
+	ListenerGrid.Reset();
+
+	for (int32 i = Listeners.Num() - 1; i >= 0; --i)
+	{
+		if (!Listeners[i].Controller.IsValid())
+		{
+			Listeners.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+
+	for (int32 i = 0; i < Listeners.Num(); ++i)
+	{
+		// unpossessed controllers stay registered but can't see anything
+		if (const APawn* Pawn = Listeners[i].Controller->GetPawn())
+		{
+			ListenerGrid.Add(i, Pawn->GetActorLocation());
+		}
+	}
+
+	ListenerGrid.Build();
+}
+
+void UPerceptionGridSubsystem::GatherCandidates()
+{
+	Candidates.Reset();
+
+	for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+	{
+		AActor* Target = Targets[TargetIndex].Get();
+		const FVector TargetLocation = Target->GetActorLocation();
+
+		ListenerGrid.ForEachInRadius(TargetLocation, MaxQueryRadius, [&](int32 ListenerIndex, const FVector2D&)
+		{
+			++Stats.GridPairChecks;
+
+			FListener& Listener = Listeners[ListenerIndex];
+			const APawn* Pawn = Listener.Controller->GetPawn();
+			if (!Pawn || Pawn == Target) return;
+
+			FSeenTarget* Seen = Listener.SeenTargets.FindByPredicate([Target](const FSeenTarget& S) { return S.Target.Get() == Target; });
+
+			// same rules as stock sight: sight radius to acquire, lose-sight radius to keep
+			const FVector ToTarget = TargetLocation - Pawn->GetActorLocation();
+			const float DistSq = ToTarget.SizeSquared();
+			if (DistSq > (Seen ? Listener.LoseSightRadiusSq : Listener.SightRadiusSq)) return;
+
+			const FVector Dir = DistSq > KINDA_SMALL_NUMBER ? ToTarget * FMath::InvSqrt(DistSq) : Pawn->GetActorForwardVector();
+			if (FVector::DotProduct(Dir, Pawn->GetActorForwardVector()) < Listener.CosHalfAngle) return;
+
+			if (Seen)
+			{
+				Seen->LastInRangeFrame = FrameCounter;
+			}
+
+			FSightCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+			Candidate.ListenerIndex = ListenerIndex;
+			Candidate.TargetIndex = TargetIndex;
+			Candidate.bCurrentlySeen = Seen != nullptr;
+		});
+	}
+
+	Stats.TracesRequested += Candidates.Num();
+}
+
+void UPerceptionGridSubsystem::RunTraces()
+{
+	const int32 NumCandidates = Candidates.Num();
+	if (NumCandidates == 0) return;
+
+	const int32 NumTraces = FMath::Min(NumCandidates, FMath::Max(PerceptionGrid::MaxTracesPerFrame, 1));
+	const int32 Start = int32(TraceCursor % uint32(NumCandidates));
+
+	for (int32 k = 0; k < NumTraces; ++k)
+	{
+		const FSightCandidate& Candidate = Candidates[(Start + k) % NumCandidates];
+		FListener& Listener = Listeners[Candidate.ListenerIndex];
+		AActor* Target = Targets[Candidate.TargetIndex].Get();
+		const APawn* Pawn = Listener.Controller->GetPawn();
+
+		const bool bVisible = HasLineOfSight(*Pawn, *Target);
+		if (bVisible != Candidate.bCurrentlySeen)
+		{
+			SetSeen(Listener, *Target, bVisible);
+		}
+	}
+
+	TraceCursor += NumTraces;
+	Stats.TracesIssued += NumTraces;
+}
+
+void UPerceptionGridSubsystem::ExpireOutOfRangeTargets()
+{
+	for (FListener& Listener : Listeners)
+	{
+		for (int32 i = Listener.SeenTargets.Num() - 1; i >= 0; --i)
+		{
+			const FSeenTarget& Seen = Listener.SeenTargets[i];
+			if (Seen.LastInRangeFrame == FrameCounter) continue;
+
+			// left the lose-sight radius or the cone: no trace needed to know it's gone
+			if (AActor* Target = Seen.Target.Get())
+			{
+				SetSeen(Listener, *Target, false);
+			}
+			else
+			{
+				Listener.SeenTargets.RemoveAtSwap(i);
+			}
+		}
+	}
+}
+
+bool UPerceptionGridSubsystem::HasLineOfSight(const APawn& ListenerPawn, const AActor& Target) const
+{
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(PerceptionGridSight), true, &ListenerPawn);
+	Params.AddIgnoredActor(&Target);
+
+	return !GetWorld()->LineTraceTestByChannel(ListenerPawn.GetPawnViewLocation(), Target.GetActorLocation(), ECC_Visibility, Params);
+}
+
+void UPerceptionGridSubsystem::SetSeen(FListener& Listener, AActor& Target, bool bSeen)
+{
+	if (bSeen)
+	{
+		FSeenTarget& Seen = Listener.SeenTargets.AddDefaulted_GetRef();
+		Seen.Target = &Target;
+		Seen.LastInRangeFrame = FrameCounter;
+	}
+	else
+	{
+		Listener.SeenTargets.RemoveAllSwap([&Target](const FSeenTarget& S) { return S.Target.Get() == &Target; });
+	}
+
+	if (ABaseEnemyController* Controller = Listener.Controller.Get())
+	{
+		Controller->ReceiveGridSight(&Target, bSeen);
+	}
+}
@@ -3,6 +3,7 @@
 
 #include "PooledActor.h"
 #include "AC_ObjectPool.h"
+#include "CPP_TopDown.h"
 
 // Sets default values
 APooledActor::APooledActor()
@@ -49,6 +50,8 @@ void APooledActor::SetInUse(bool bActive)
 
     if (bInUse)
     {
+        INC_DWORD_STAT(STAT_WizardDungeon_ActiveSpells);
+
         SetActorHiddenInGame(false);
         SetActorEnableCollision(true);
         SetActorTickEnabled(true);
@@ -64,7 +67,7 @@ void APooledActor::SetInUse(bool bActive)
     }
     else
     {
-
+        DEC_DWORD_STAT(STAT_WizardDungeon_ActiveSpells);
         SetActorHiddenInGame(true);
         SetActorEnableCollision(false);
         SetActorTickEnabled(false);
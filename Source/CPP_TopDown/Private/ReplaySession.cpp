@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ReplaySession.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FReplaySession* FReplaySession::ActiveSession = nullptr;
+
+bool FReplaySession::Begin(int32 InSeed, float InFPS)
+{
+	if (ActiveSession && ActiveSession != this)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[%s] can't start while a %s session is running"), LogTag, ActiveSession->LogTag);
+		return false;
+	}
+
+	// restarting keeps the timestep saved by the first Begin()
+	if (!IsActive())
+	{
+		bPrevUseFixedTimeStep = FApp::UseFixedTimeStep();
+		PrevFixedDeltaTime = FApp::GetFixedDeltaTime();
+		ActiveSession = this;
+	}
+
+	Seed = InSeed;
+	FPS = FMath::Max(InFPS, 1.f);
+
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FPS);
+	return true;
+}
+
+void FReplaySession::End()
+{
+	if (!IsActive()) return;
+
+	ActiveSession = nullptr;
+
+	FApp::SetUseFixedTimeStep(bPrevUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PrevFixedDeltaTime);
+}
+
+int32 FReplaySession::Save(const FString& Path, FReplayFileHeader Header, TFunctionRef<void(FArchive&)> SerializePayload) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	Writer << Header;
+	SerializePayload(Writer);
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[%s] failed to write %s"), LogTag, *Path);
+		return INDEX_NONE;
+	}
+
+	return Bytes.Num();
+}
+
+bool FReplaySession::Load(const FString& Path, uint32 Magic, int32 Version, FReplayFileHeader& OutHeader, TFunctionRef<void(FArchive&)> SerializePayload) const
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[%s] couldn't read %s"), LogTag, *Path);
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	// magic and version first, so an old file isn't misread as the current layout
+	Reader << OutHeader.Magic << OutHeader.Version;
+	if (OutHeader.Magic != Magic || OutHeader.Version != Version)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[%s] %s is not a version %d recording"), LogTag, *Path, Version);
+		return false;
+	}
+
+	Reader << OutHeader.Seed << OutHeader.FPS << OutHeader.Frames;
+	SerializePayload(Reader);
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[%s] %s is truncated"), LogTag, *Path);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SafeRepositionSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace SafeReposition
+{
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("game.SafeReposition.Stats"),
+		TEXT("Prints how many reposition requests were answered by async sweeps vs. sync fallbacks. Pass 'reset' to clear them."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			USafeRepositionSubsystem* Reposition = World ? World->GetSubsystem<USafeRepositionSubsystem>() : nullptr;
+			if (!Reposition) return;
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				Reposition->ResetStats();
+				return;
+			}
+
+			const FSafeRepositionStats& S = Reposition->GetStats();
+			UE_LOG(LogTemp, Display, TEXT("[SafeReposition] %llu requests: %llu async, %llu sync fallback, %llu cancelled, %d pending"),
+				S.Requests, S.AsyncResolved, S.SyncFallbacks, S.Cancelled, Reposition->GetNumPending());
+		}));
+}
+
+bool USafeRepositionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USafeRepositionSubsystem::Deinitialize()
+{
+	Requests.Empty();
+	SweepDelegate.Unbind();
+
+	Super::Deinitialize();
+}
+
+uint32 USafeRepositionSubsystem::RequestReposition(AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	ECollisionChannel Channel, float SafetyOffset, float DriftTolerance)
+{
+	UWorld* World = GetWorld();
+	if (!World) return 0;
+
+	if (!SweepDelegate.IsBound())
+	{
+		SweepDelegate.BindUObject(this, &USafeRepositionSubsystem::OnSweepDone);
+	}
+
+	const uint32 RequestId = NextRequestId++;
+	if (NextRequestId == 0) NextRequestId = 1;
+
+	FRepositionRequest& Request = Requests.Add(RequestId);
+	Request.Mover = Mover;
+	Request.Start = Start;
+	Request.End = End;
+	Request.SafetyOffset = SafetyOffset;
+	Request.DriftToleranceSq = FMath::Square(FMath::Max(DriftTolerance, 0.f));
+
+	World->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, FQuat::Identity, Channel, Shape,
+		FCollisionQueryParams(SCENE_QUERY_STAT(SafeRepositionSweep), false, Mover),
+		FCollisionResponseParams::DefaultResponseParam, &SweepDelegate, RequestId);
+
+	++Stats.Requests;
+	return RequestId;
+}
+
+void USafeRepositionSubsystem::OnSweepDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	// cancelled or already resolved synchronously
+	FRepositionRequest* Request = Requests.Find(Datum.UserData);
+	if (!Request) return;
+
+	const FHitResult* BlockingHit = Datum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+
+	Request->Result = ComputeSafeEnd(Request->Start, Request->End, BlockingHit, Request->SafetyOffset);
+	Request->bHasResult = true;
+}
+
+FVector USafeRepositionSubsystem::ResolveReposition(uint32 RequestId, AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	ECollisionChannel Channel, float SafetyOffset)
+{
+	FRepositionRequest Request;
+	const bool bKnown = Requests.RemoveAndCopyValue(RequestId, Request);
+
+	if (bKnown && Request.bHasResult && Request.Mover.Get() == Mover
+		&& FVector::DistSquared(Request.Start, Start) <= Request.DriftToleranceSq
+		&& FVector::DistSquared(Request.End, End) <= Request.DriftToleranceSq)
+	{
+		++Stats.AsyncResolved;
+		return Request.Result;
+	}
+
+	++Stats.SyncFallbacks;
+	return SweepNow(Mover, Start, End, Shape, Channel, SafetyOffset);
+}
+
+void USafeRepositionSubsystem::CancelReposition(uint32 RequestId)
+{
+	if (Requests.Remove(RequestId) > 0)
+	{
+		++Stats.Cancelled;
+	}
+}
+
+FVector USafeRepositionSubsystem::ComputeSafeEnd(const FVector& Start, const FVector& End, const FHitResult* BlockingHit, float SafetyOffset)
+{
+	if (!BlockingHit)
+	{
+		return End;
+	}
+
+	const FVector Dir = (End - Start).GetSafeNormal();
+	return BlockingHit->Location - Dir * SafetyOffset;
+}
+
+FVector USafeRepositionSubsystem::SweepNow(AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	ECollisionChannel Channel, float SafetyOffset) const
+{
+	UWorld* World = GetWorld();
+	if (!World) return End;
+
+	FHitResult Hit;
+	const bool bHit = World->SweepSingleByChannel(Hit, Start, End, FQuat::Identity, Channel, Shape,
+		FCollisionQueryParams(SCENE_QUERY_STAT(SafeRepositionSweep), false, Mover));
+
+	return ComputeSafeEnd(Start, End, (bHit && Hit.bBlockingHit) ? &Hit : nullptr, SafetyOffset);
+}
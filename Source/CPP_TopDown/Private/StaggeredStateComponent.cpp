@@ -35,10 +35,9 @@ void UStaggeredStateComponent::EnterStagger(float Duration)
 	if (bIsStaggered)
 	{
 		// Already staggered, reset timer if applicable
-		if (Duration > 0.f)
+		if (Duration > 0.f && IsValid(OwnerCharacter))
 		{
-			GetWorld()->GetTimerManager().ClearTimer(StaggerTimerHandle);
-			GetWorld()->GetTimerManager().SetTimer(StaggerTimerHandle, this, &UStaggeredStateComponent::ExitStagger, Duration, false);
+			OwnerCharacter->StartCooldown(ECharacterCooldown::Stagger, Duration, FSimpleDelegate::CreateUObject(this, &UStaggeredStateComponent::ExitStagger));
 		}
 		return;
 	}
@@ -46,9 +45,10 @@ void UStaggeredStateComponent::EnterStagger(float Duration)
 	bIsStaggered = true;
 	ApplyBlock();
 
-	if (Duration > 0.f)
+	// the owner's row in the cooldown table ends the stagger
+	if (Duration > 0.f && IsValid(OwnerCharacter))
 	{
-		GetWorld()->GetTimerManager().SetTimer(StaggerTimerHandle, this, &UStaggeredStateComponent::ExitStagger, Duration, false);
+		OwnerCharacter->StartCooldown(ECharacterCooldown::Stagger, Duration, FSimpleDelegate::CreateUObject(this, &UStaggeredStateComponent::ExitStagger));
 	}
 }
 
@@ -57,7 +57,10 @@ void UStaggeredStateComponent::ExitStagger()
 	if (!bIsStaggered) return;
 
 	bIsStaggered = false;
-	GetWorld()->GetTimerManager().ClearTimer(StaggerTimerHandle);
+	if (IsValid(OwnerCharacter))
+	{
+		OwnerCharacter->ClearCooldown(ECharacterCooldown::Stagger);
+	}
 	RemoveBlock();
 }
 
@@ -2,6 +2,7 @@
 
 
 #include "VerticalBeamSpell.h"
+#include "CPP_TopDown.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "TimerManager.h"
@@ -9,6 +10,8 @@
 #include "GameFramework/DamageType.h"  
 #include "Engine/DamageEvents.h"  
 
+DECLARE_CYCLE_STAT(TEXT("Beam ApplyDamageTick"), STAT_WizardDungeon_BeamDamageTick, STATGROUP_WizardDungeon);
+
 // Sets default values
 AVerticalBeamSpell::AVerticalBeamSpell()
 {
@@ -194,6 +197,7 @@ void AVerticalBeamSpell::OnEndOverlap(UPrimitiveComponent* OverlappedComp, AActo
 
 void AVerticalBeamSpell::ApplyDamageTick()
 {
+    SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_BeamDamageTick);
 
     if (OverlappingActors.Num() == 0) return;
 
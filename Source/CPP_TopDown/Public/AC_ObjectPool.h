@@ -8,6 +8,16 @@
 
 class APooledActor;
 
+/** Snapshot of a pool's occupancy, for benchmarks and reports */
+struct FObjectPoolStats
+{
+	int32 NumPooled = 0;
+	int32 NumInUse = 0;
+
+	/** Times the pool ran dry and had to grow at runtime */
+	int32 NumGrowEvents = 0;
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class CPP_TOPDOWN_API UAC_ObjectPool : public UActorComponent
 {
@@ -45,6 +55,8 @@ protected:
 	// remembers next index to try per class to spread usage (round-robin)
 	TMap<UClass*, int32> PerClassNextIndex;
 
+	int32 NumGrowEvents = 0;
+
 
 	UFUNCTION()
 	void InitializePool();
@@ -69,4 +81,10 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Pooling")
 	void PoolPrewarmReport();
+
+	/** Counts across every class pool; cheap enough to call once per frame */
+	FObjectPoolStats GetPoolStats() const;
+
+	/** Every valid actor owned by this pool, in use or not */
+	void GetAllPooledActors(TArray<APooledActor*>& OutActors) const;
 };
@@ -6,8 +6,16 @@
 #include "BehaviorTree/BTService.h"
 #include "BTService_UpdateDistanceToPlayer.generated.h"
 
+class UBTCompositeNode;
+
 /**
- * 
+ * Registers the enemy with UEnemyDistanceSubsystem while this branch is relevant.
+ * The service itself never ticks: the subsystem computes all distances in one pass
+ * and writes DistanceToPlayer (and DistanceBand) as soon as the enemy crosses a band,
+ * so decorators observing those keys re-evaluate on change instead of every frame.
+ * The bands are the thresholds of the Blackboard decorators on DistanceToPlayer in the
+ * running tree, and the exact distance is still refreshed every Interval for anything
+ * else reading the key.
  */
 UCLASS()
 class CPP_TOPDOWN_API UBTService_UpdateDistanceToPlayer : public UBTService
@@ -16,7 +24,12 @@ class CPP_TOPDOWN_API UBTService_UpdateDistanceToPlayer : public UBTService
 
 	UBTService_UpdateDistanceToPlayer();
 
-	virtual void TickNode(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory, float deltaSeconds) override;
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory) override;
+
+	/** Adds the FloatValue of every Blackboard decorator on KeyName below Node to OutThresholds */
+	static void CollectDecoratorThresholds(const UBTCompositeNode* Node, FName KeyName, TArray<float>& OutThresholds);
 
 	UPROPERTY(EditAnywhere, Category = Blackboard)
 	FBlackboardKeySelector SelfActorKey;
@@ -26,5 +39,24 @@ class CPP_TOPDOWN_API UBTService_UpdateDistanceToPlayer : public UBTService
 
 	UPROPERTY(EditAnywhere, Category = Blackboard)
 	FBlackboardKeySelector DistanceToPlayer;
+
+	/** Optional int key receiving the band index (0 = inside the first threshold) */
+	UPROPERTY(EditAnywhere, Category = Blackboard)
+	FBlackboardKeySelector DistanceBand;
+
+	/** Extra distance thresholds on top of the ones read from the tree's decorators */
+	UPROPERTY(EditAnywhere, Category = "Distance Bands")
+	TArray<float> DistanceBands;
+
+	/** Use the thresholds of the Blackboard decorators comparing DistanceToPlayer in this tree as bands */
+	UPROPERTY(EditAnywhere, Category = "Distance Bands")
+	bool bBandsFromDecorators = true;
+
+	/** How far past a threshold the enemy has to be before it counts as having left the inner band */
+	UPROPERTY(EditAnywhere, Category = "Distance Bands", meta = (ClampMin = "0"))
+	float BandHysteresis = 25.f;
+
+	/** DistanceBands plus the decorator thresholds, resolved once per tree asset */
+	TArray<float> ResolvedBands;
 	
 };
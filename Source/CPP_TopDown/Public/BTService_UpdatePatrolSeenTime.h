@@ -7,7 +7,8 @@
 #include "BTService_UpdatePatrolSeenTime.generated.h"
 
 /**
- * 
+ * Kept so existing behavior trees still load. The "lost sight, go back to Passive" logic now
+ * lives in ABaseEnemyController (perception events + one expiry timer), so this service never ticks.
  */
 UCLASS()
 class CPP_TOPDOWN_API UBTService_UpdatePatrolSeenTime : public UBTService
@@ -16,11 +17,7 @@ class CPP_TOPDOWN_API UBTService_UpdatePatrolSeenTime : public UBTService
 
 	UBTService_UpdatePatrolSeenTime();
 
-	virtual void TickNode(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory, float deltaSeconds) override;
-
 	UPROPERTY(EditAnywhere, Category = Blackboard)
 	FBlackboardKeySelector SelfActorKey;
-
-	bool FlagForInitialStart;
 	
 };
@@ -7,8 +7,22 @@
 #include "BehaviorTree/BTTaskNode.h"
 #include "BTTask_EnemyBasicMelee.generated.h"
 
+/** Per-enemy state of the melee task, lives in the behavior tree's node memory */
+struct FBTEnemyBasicMeleeMemory
+{
+	/** Enemy that started the attack; cleared when the task finishes or is aborted */
+	TWeakObjectPtr<ABaseEnemyCharacter> Enemy;
+
+	/** World time the attack started, for the timeout */
+	double StartTime = 0.0;
+};
+
 /**
- * 
+ * Starts a melee attack and stays in progress until the enemy sends
+ * ABaseMagicCharacter::MeleeFinishedMessage. Not instanced: one node object is shared
+ * by every enemy running the tree, and nothing is bound to the character's delegates.
+ * Fails if the message doesn't arrive within the melee cooldown plus TimeoutMargin,
+ * e.g. because the cooldown was cleared without firing its callback.
  */
 UCLASS()
 class CPP_TOPDOWN_API UBTTask_EnemyBasicMelee : public UBTTaskNode
@@ -19,20 +33,19 @@ public:
 
 	UBTTask_EnemyBasicMelee();
 
-	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory);
-	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
-
-private:
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
 
-	UPROPERTY()
-	ABaseEnemyCharacter* CachedEnemy;
+	virtual uint16 GetInstanceMemorySize() const override { return sizeof(FBTEnemyBasicMeleeMemory); }
+	virtual void InitializeMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryInit::Type InitType) const override;
+	virtual void CleanupMemory(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTMemoryClear::Type CleanupType) const override;
 
-	UPROPERTY()	
-	UBehaviorTreeComponent* CachedOwnerComp;
+protected:
 
-	UFUNCTION()
-	void HandleMeleeFinished(bool bIsAttacking);
-
-	bool bIsWaitingForMelee;
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+	virtual void OnMessage(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, FName Message, int32 RequestID, bool bSuccess) override;
 
+	/** Extra time on top of the enemy's melee cooldown before the task gives up waiting */
+	UPROPERTY(EditAnywhere, Category = "Node", meta = (ClampMin = 0, Units = "s"))
+	float TimeoutMargin = 1.f;
 };
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "BTTask_EnemyPatrol.generated.h"
+
+/**
+ * Walks the enemy to its next patrol waypoint and advances the patrol once it arrives.
+ * Crowd members are steered by UPatrolCrowdSubsystem instead, so for them the task issues no
+ * move at all and just stays in progress until the branch is aborted (e.g. the enemy leaves Passive).
+ * Use this as the patrol branch's task so the crowd is the only thing moving its members.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UBTTask_EnemyPatrol : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+
+	UBTTask_EnemyPatrol();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+protected:
+
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	/** How close the enemy needs to get to the waypoint */
+	UPROPERTY(EditAnywhere, Category = "Node", meta = (ClampMin = 0, Units = "cm"))
+	float AcceptanceRadius = 50.f;
+};
@@ -7,13 +7,15 @@
 #include "BTTask_EnemyVerticalBeam.generated.h"
 
 /**
- * 
+ * Fire-and-forget: finishes inside ExecuteTask, so the node is never instanced and keeps no memory.
  */
 UCLASS()
 class CPP_TOPDOWN_API UBTTask_EnemyVerticalBeam : public UBTTaskNode
 {
 	GENERATED_BODY()
 
-	EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory);
+	UBTTask_EnemyVerticalBeam();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& ownerComp, uint8* nodeMemory) override;
 	
 };
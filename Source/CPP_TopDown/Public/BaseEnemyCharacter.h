@@ -38,6 +38,7 @@ public:
 protected:
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual float TakeDamage(
 		float DamageCount,
@@ -50,6 +51,23 @@ protected:
 	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "AI|Patrol")
 	APatrolRoute* PatrolRouteActor;
 
+	/** Walk PatrolRouteActor with this enemy's own cursor, so several enemies can share one route */
+	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "AI|Patrol")
+	bool bUseOwnPatrolCursor = false;
+
+	/** Waypoint this enemy's own cursor starts from */
+	UPROPERTY(EditInstanceOnly, Category = "AI|Patrol")
+	int32 PatrolStartPoint = 0;
+
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "AI|Patrol")
+	FPatrolCursor PatrolCursor;
+
+	/** Set while this enemy walks a crowd-mode route */
+	bool bInPatrolCrowd = false;
+
+	/** Slot assigned by UPatrolCrowdSubsystem this frame */
+	FVector CrowdSlotLocation = FVector::ZeroVector;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Spells")
 	TSubclassOf<ABaseBullet> BaseSpellClass;
 
@@ -89,4 +107,19 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "FX")
 	void SpawnVerticalBeamAtActor(AActor* TargetActor, float Duration = 2.0f, float BeamScale = 0.1f);
+
+	/** Waypoint this enemy is heading to (own cursor, or the route's shared one) */
+	UFUNCTION(BlueprintCallable, Category = "AI|Patrol")
+	FVector GetPatrolTargetLocation() const;
+
+	/** Written by UPatrolCrowdSubsystem once per frame for crowd members */
+	void SetCrowdSlotLocation(const FVector& Location) { CrowdSlotLocation = Location; }
+
+	/** True while UPatrolCrowdSubsystem moves this enemy; patrol tasks must not issue moves of their own */
+	UFUNCTION(BlueprintPure, Category = "AI|Patrol")
+	bool IsInPatrolCrowd() const { return bInPatrolCrowd; }
+
+	/** Call when the current waypoint was reached */
+	UFUNCTION(BlueprintCallable, Category = "AI|Patrol")
+	void AdvancePatrol();
 };
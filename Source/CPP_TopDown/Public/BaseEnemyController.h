@@ -8,6 +8,7 @@
 #include "Perception/AISenseConfig_Sight.h"
 #include "Perception/AISenseConfig_Hearing.h"
 #include "Perception/AISenseConfig_Damage.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
 #include "EEnemyStates.h"
 #include "BaseEnemyController.generated.h"
 
@@ -25,7 +26,12 @@ public:
 
 protected:
 
-	virtual void BeginPlay();
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnPossess(APawn* InPawn) override;
+
+	/** Runs the pawn's BTAsset and seeds the blackboard; does nothing if the tree is already running */
+	void StartBehaviorTree();
 
 	// Perception
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "AI")
@@ -36,8 +42,62 @@ protected:
 	UFUNCTION()
 	void OnTargetPerceptionUpdated(AActor* Actor, FAIStimulus Stimulus);
 
+	/** Looks up the blackboard key IDs once, right after the behavior tree (and its blackboard) starts */
+	void CacheBlackboardKeys();
+
+	void SetEnemyState(EEnemyStates NewState);
+
+	/** (Re)arms the single "lost the player" timer, replacing any pending one */
+	void StartLostSightTimer(float Delay);
+
+	/** Arms the timer for Delay unless it's already set to fire later than that */
+	void ExtendLostSightTimer(float Delay);
+
+	/** MaxAge of the matching sense config, 0 for senses this controller doesn't configure */
+	float GetSenseMaxAge(FAISenseID SenseID) const;
+
+	/** Fired once MaxAge after the player was last sensed; drops back to Passive if still attacking */
+	void OnLostSightExpired();
+
+	FTimerHandle TimerHandle_LostSight;
+
+	/** Between a successful and a failed sight stimulus for the player; other senses never clear the timer meanwhile */
+	bool bPlayerInSight = false;
+
+	/** Who we're fighting; set on BeginPlay and refreshed whenever perception senses a target */
+	TWeakObjectPtr<AActor> CachedAttackTarget;
+
+	// Blackboard key IDs, resolved once so perception events never look keys up by name
+	FBlackboard::FKey StateKeyId = FBlackboard::InvalidKey;
+	FBlackboard::FKey PlayerKeyId = FBlackboard::InvalidKey;
+	FBlackboard::FKey LastSeenTimeKeyId = FBlackboard::InvalidKey;
+	FBlackboard::FKey LastSeenLocationKeyId = FBlackboard::InvalidKey;
+	FBlackboard::FKey TimeSinceLastSeenKeyId = FBlackboard::InvalidKey;
+
 public:
 
+	/** True once the pawn's behavior tree is running */
+	bool IsBehaviorTreeRunning() const;
+
+	/** Sight result from UPerceptionGridSubsystem, handled exactly like a stock sight stimulus */
+	void ReceiveGridSight(AActor* Target, bool bSensed);
+
+	/** Cached target for EQS contexts and tasks, no blackboard lookup involved */
+	AActor* GetAttackTarget() const { return CachedAttackTarget.Get(); }
+
+	/** Current State blackboard value, read through the cached key ID */
+	UFUNCTION(BlueprintPure, Category = "AI")
+	EEnemyStates GetEnemyState() const;
+
+	/**
+	 * Let UPerceptionGridSubsystem schedule sight checks (grid neighbourhood + per-frame trace budget)
+	 * instead of stock sight. Hearing and damage stay on the perception component either way.
+	 * Off by default: grid sight bypasses the perception component's stimulus memory, so
+	 * GetKnownPerceivedActors and friends won't report the player while it's on.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "AI|Perception")
+	bool bUseGridSightScheduling = false;
+
 	UAISenseConfig_Sight* SightConfig;
 	UAISenseConfig_Hearing* HearingConfig;
 	UAISenseConfig_Damage* DamageConfig;
@@ -7,6 +7,8 @@
 #include "BaseWeapon.h"
 #include "StaggeredStateComponent.h"
 #include "AC_ObjectPool.h"
+#include "CooldownSubsystem.h"
+#include "DissolveComponent.h"
 #include "BaseMagicCharacter.generated.h"
 
 
@@ -65,6 +67,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UStaggeredStateComponent* StaggeredState;
 
+	/** Material dissolve used for the player's dodge and for death */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UDissolveComponent* Dissolve;
+
 	//Called     // Called by StaggerStateComponent to block/unblock actions on this character
 	void BlockAllActions();
 	void UnblockAllActions();
@@ -93,9 +99,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Stagger")
 	bool IsStaggered() const;
 
+	/** Cooldown helpers on this character's row of the world cooldown table */
+	void StartCooldown(ECharacterCooldown Cooldown, float Duration, FSimpleDelegate OnReady = FSimpleDelegate());
+	void ClearCooldown(ECharacterCooldown Cooldown);
+	bool IsCooldownReady(ECharacterCooldown Cooldown) const;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Our row in the world's UCooldownSubsystem table */
+	int32 CooldownSlot = INDEX_NONE;
 
 	UPROPERTY(EditAnywhere)
 	UChildActorComponent* Weapon;
@@ -125,6 +140,13 @@ protected:
 
 	bool bIsDead = false;
 
+	/** Dissolve the mesh out when this character dies (finishes before the deferred destroy) */
+	UPROPERTY(EditDefaultsOnly, Category = "Damage|Visual")
+	bool bDissolveOnDeath = false;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Damage|Visual", meta = (EditCondition = "bDissolveOnDeath"))
+	float DeathDissolveDuration = 0.8f;
+
 	// Visual hit flash settings (tweak in editor)
 	UPROPERTY(EditDefaultsOnly, Category = "Damage|Visual")
 	FLinearColor DamageTint = FLinearColor::Red;
@@ -143,8 +165,6 @@ protected:
 	UPROPERTY()
 	TArray<UMaterialInstanceDynamic*> DynamicMaterials;
 
-	FTimerHandle TimerHandle_HitFlash;
-
 	// Helpers
 	void StartHitFlash();
 	void StopHitFlash();
@@ -152,13 +172,7 @@ protected:
 	// Optional: function to ensure dynamic mats exist (call from BeginPlay)
 	void EnsureDynamicMaterials();
 
-	UFUNCTION()
-	void SetCanFire(bool value);
-
-	// Timer handle for resetting melee
-	FTimerHandle MeleeTimerHandle;
-
-	// Resets the ability to melee
+	// Resets the ability to melee (fired when the Melee cooldown expires)
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 	void ResetMelee();
 
@@ -181,6 +195,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Combat|Melee")
 	void MeleeAttack();
 
+	/** True if MeleeAttack() would actually start an attack right now */
+	bool CanMeleeAttack() const { return bCanMelee && !IsStaggered() && IsCooldownReady(ECharacterCooldown::Melee); }
+
+	/** AI message sent to our AI controller when the melee cooldown ends (see ResetMelee) */
+	static const FName MeleeFinishedMessage;
+
 	/** Switch directly to a specific bullet type slot */
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 	void SetBulletTypeByIndex(int32 NewIndex);
@@ -189,6 +209,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat")
 	int32 CurrentBulletTypeIndex = 0;
 
+	/** First slot in AvailableBulletTypes that is (a child of) BaseClass, or INDEX_NONE */
+	int32 FindBulletTypeIndex(const UClass* BaseClass) const;
+
 	/** Switch to the next bullet type in the array */
 	UFUNCTION(BlueprintCallable, Category = "Combat")
 	void ChangeBulletType();
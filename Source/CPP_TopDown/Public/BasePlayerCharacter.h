@@ -38,6 +38,7 @@ public:
 protected:
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Top down camera */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
@@ -97,12 +98,6 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Teleport|Dissolve")
 	float ResolveDuration = 0.2f;
 
-	// Runtime
-	TArray<UMaterialInstanceDynamic*> DynamicMats;
-	TArray<UMaterialInterface*> OriginalMats;
-	FTimerHandle TimerHandle_DissolveTick;
-	float DissolveElapsed = 0.f;
-	bool bDissolvingOut = false; // true = dissolving (hide); false = resolving (show)
 
 	/// <summary>
 	/// Teleport / Dodge Settings
@@ -142,6 +137,12 @@ protected:
 	// helper that actually performs teleport when we are fully dissolved
 	void PerformTeleportNow();
 
+	// start/end/capsule of the dodge sweep from where we stand right now
+	void GetDodgeSweep(FVector& OutStart, FVector& OutEnd, FCollisionShape& OutShape) const;
+
+	// async sweep submitted when the dissolve starts, resolved in PerformTeleportNow (0 = none)
+	uint32 DodgeRepositionRequest = 0;
+
 	// runtime state
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dodge")
 	bool bCanDodge = true;
@@ -149,12 +150,9 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dodge")
 	bool bIsDodgeInvulnerable = false;
 
-	FTimerHandle TimerHandle_DodgeCooldown;
-	FTimerHandle TimerHandle_EndInvuln;
-
-	void InitDissolveMIDs();
-	void StartDissolveOut();   // begin dissolve (0 -> 1)
-	void UpdateDissolveTick(); // called by timer
+	// dissolve component finished a phase: teleport after dissolving out, clean up after resolving in
+	UFUNCTION()
+	void OnDodgeDissolveFinished(bool bDissolvedOut);
 
 	// indicator blueprint class to set in editor
 	UPROPERTY(EditAnywhere, Category = "ArcPreview")
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatBenchmarkSubsystem.generated.h"
+
+class ABaseEnemyCharacter;
+class ABasePlayerCharacter;
+class UAC_ObjectPool;
+
+UENUM()
+enum class ECombatBenchmarkScenario : uint8
+{
+	/** N enemies running their behavior trees against a circling player */
+	Enemies,
+
+	/** Every character (brains stopped) firing ShootBullet as fast as its fire rate allows */
+	Fire,
+
+	/** The player lobbing AOE spells into a ring of enemies */
+	AOE
+};
+
+/** One measured frame; written as a CSV row */
+struct FCombatBenchmarkSample
+{
+	int32 Frame = 0;
+	float FrameMs = 0.f;
+
+	/** Game thread time of this frame; the engine only publishes it after our tick, so it's filled in one frame later */
+	float GameThreadMs = 0.f;
+
+	int32 NumActors = 0;
+	int32 NumEnemies = 0;
+	int32 PoolTotal = 0;
+	int32 PoolInUse = 0;
+	int32 PoolGrowEvents = 0;
+};
+
+/**
+ * Headless, scripted combat benchmark. Only created when the game is started with
+ * -CombatBenchmark=Enemies,Fire,AOE (any subset, run in order), e.g.
+ *
+ *   UnrealEditor CPP_TopDown <Map> -game -nullrhi -unattended -CombatBenchmark=Enemies,Fire,AOE
+ *       [-BenchmarkEnemies=50] [-BenchmarkFrames=1800] [-BenchmarkWarmup=120] [-BenchmarkFPS=30]
+ *       [-BenchmarkSeed=1234] [-BenchmarkEnemyClass=/Game/.../BP_Enemy.BP_Enemy_C] [-BenchmarkNoExit]
+ *
+ * The enemy class defaults to DefaultEnemyClass from DefaultGame.ini. It has to be a Blueprint enemy with a
+ * BTAsset and an ABaseEnemyController, otherwise the run fails instead of measuring idle pawns.
+ *
+ * The engine runs on a fixed timestep and all scripted randomness comes from one seeded stream,
+ * so the same build produces the same game simulation every run. Each scenario writes one CSV
+ * to Saved/Benchmarks and logs a summary; the process exits when the last scenario is done.
+ */
+UCLASS(Config = Game)
+class CPP_TOPDOWN_API UCombatBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** True while a -CombatBenchmark run is driving this world */
+	bool IsRunning() const { return bRunning; }
+
+protected:
+
+	void ParseCommandLine();
+
+	/** Checks EnemyClass is a Blueprint enemy that will run its behavior tree; logs why not */
+	bool ValidateEnemyClass() const;
+
+	/** Stops the run with an error, exiting with a non-zero code unless -BenchmarkNoExit */
+	void FailRun(const FString& Reason);
+
+	void StartScenario();
+	void FinishScenario();
+	void TearDownScenario();
+
+	/** Returns false if a spawned enemy didn't end up with a running behavior tree */
+	bool SpawnEnemies();
+
+	/** Collects this world's object pools once, so sampling doesn't walk every UObject each frame */
+	void CachePools();
+
+	void DriveScenario(float DeltaTime);
+	void RecordSample();
+	void WriteCsv() const;
+
+	ABasePlayerCharacter* GetPlayer() const;
+
+	TArray<ECombatBenchmarkScenario> Scenarios;
+	int32 ScenarioIndex = INDEX_NONE;
+
+	int32 NumEnemies = 50;
+	int32 MeasuredFrames = 1800;
+	int32 WarmupFrames = 120;
+	float FixedFPS = 30.f;
+	int32 Seed = 1234;
+	bool bExitWhenDone = true;
+
+	/** Enemy Blueprint used when -BenchmarkEnemyClass isn't given */
+	UPROPERTY(Config)
+	FSoftClassPath DefaultEnemyClass;
+
+	UPROPERTY()
+	TSubclassOf<ABaseEnemyCharacter> EnemyClass;
+
+	UPROPERTY()
+	TArray<TObjectPtr<ABaseEnemyCharacter>> SpawnedEnemies;
+
+	/** Pools of every character in the scenario, gathered by CachePools() */
+	TArray<TWeakObjectPtr<UAC_ObjectPool>> Pools;
+
+	FRandomStream Random;
+
+	bool bRunning = false;
+	int32 ScenarioFrame = 0;
+	double LastFrameSeconds = 0.0;
+	FVector ArenaCenter = FVector::ZeroVector;
+	float PlayerOrbitAngle = 0.f;
+
+	TArray<FCombatBenchmarkSample> Samples;
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CooldownSubsystem.generated.h"
+
+/** Every cooldown a character can have; one column of the cooldown table each */
+UENUM(BlueprintType)
+enum class ECharacterCooldown : uint8
+{
+	Fire,
+	Melee,
+	HitFlash,
+	Stagger,
+	Dodge,
+	DodgeInvulnerability,
+
+	Num UMETA(Hidden)
+};
+
+/**
+ * Per-world cooldown table. Each registered character owns one row (a slot) of
+ * ready-at timestamps, one per ECharacterCooldown, packed into a single array.
+ * "Is it ready" is a compare against world time; cooldowns that were started with a
+ * callback are collected in one sweep per frame and their callbacks fired together,
+ * instead of every character arming its own FTimerManager timers.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UCooldownSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Reserves a row for a character; keep the returned slot and pass it back to UnregisterOwner */
+	int32 RegisterOwner();
+	void UnregisterOwner(int32 Slot);
+
+	/** Starts (or restarts) a cooldown. OnReady fires once from the batched sweep when it expires. */
+	void StartCooldown(int32 Slot, ECharacterCooldown Cooldown, float Duration, FSimpleDelegate OnReady = FSimpleDelegate());
+
+	/** Makes the cooldown ready right away without firing its callback */
+	void ClearCooldown(int32 Slot, ECharacterCooldown Cooldown);
+
+	bool IsReady(int32 Slot, ECharacterCooldown Cooldown) const;
+	float GetRemaining(int32 Slot, ECharacterCooldown Cooldown) const;
+
+	int32 GetNumPending() const { return Pending.Num(); }
+
+protected:
+
+	static constexpr int32 NumCooldowns = int32(ECharacterCooldown::Num);
+
+	static int32 ToIndex(int32 Slot, ECharacterCooldown Cooldown) { return Slot * NumCooldowns + int32(Cooldown); }
+
+	double Now() const;
+
+	/** Removes an entry from Pending, if it's in there */
+	void Disarm(int32 Index);
+
+	/** Slot * NumCooldowns + cooldown -> world time it becomes ready */
+	TArray<double> ReadyAt;
+
+	/** Parallel to ReadyAt */
+	TArray<FSimpleDelegate> Callbacks;
+
+	/** Parallel to ReadyAt: position in Pending, INDEX_NONE if no callback is waiting */
+	TArray<int32> PendingPos;
+
+	/** Table indices with a callback still to fire; the only thing the per-frame sweep walks */
+	TArray<int32> Pending;
+
+	TArray<int32> FreeSlots;
+
+	/** Scratch for the sweep so callbacks can safely start new cooldowns */
+	TArray<FSimpleDelegate> Expired;
+};
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CrowdAvoidanceMovementComponent.generated.h"
+
+/**
+ * Character movement that takes its local avoidance from UCrowdAvoidanceSubsystem instead of the engine's RVO.
+ * The component tells the subsystem where it wants to go (from path following's requested velocity, or from
+ * movement input), and substitutes the solved avoidance velocity for it while a fresh result is available.
+ * Swap it in with ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName).
+ */
+UCLASS()
+class CPP_TOPDOWN_API UCrowdAvoidanceMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UCrowdAvoidanceMovementComponent();
+
+	/** Join the shared avoidance solve. Neighbours are looked for within AvoidanceConsiderationRadius */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crowd Avoidance")
+	bool bUseCrowdAvoidance = true;
+
+	/** Radius this agent keeps clear; 0 uses the capsule radius */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crowd Avoidance", meta = (ClampMin = "0"))
+	float CrowdAvoidanceRadius = 0.f;
+
+	virtual void RequestDirectMove(const FVector& MoveVelocity, bool bForceMaxSpeed) override;
+	virtual void StopActiveMovement() override;
+	virtual FVector ConsumeInputVector() override;
+
+	/** Velocity this agent would take without any avoidance */
+	const FVector2D& GetPreferredVelocity() const { return PreferredVelocity; }
+
+	float GetCrowdAvoidanceRadius() const;
+
+	/** Called by the subsystem with this frame's solved velocity */
+	void SetAvoidanceVelocity(const FVector2D& Velocity, uint64 Frame);
+
+	/** The last solved velocity, if it's recent enough to use */
+	bool GetAvoidanceVelocity(FVector2D& OutVelocity) const;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	FVector2D PreferredVelocity = FVector2D::ZeroVector;
+	FVector2D AvoidanceVelocity = FVector2D::ZeroVector;
+	uint64 AvoidanceFrame = 0;
+
+	/** Set by RequestDirectMove so the input path doesn't overwrite path following's preferred velocity */
+	bool bDirectMoveRequested = false;
+
+	/** Index in the subsystem's agent list, INDEX_NONE while unregistered */
+	int32 CrowdIndex = INDEX_NONE;
+
+	friend class UCrowdAvoidanceSubsystem;
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "CrowdAvoidanceStressAgent.generated.h"
+
+/**
+ * Bare capsule character used by ai.Avoidance.Stress: AI controlled, crowd avoidance movement,
+ * no mesh or gameplay, so the scenario measures movement and avoidance only.
+ */
+UCLASS(NotBlueprintable)
+class CPP_TOPDOWN_API ACrowdAvoidanceStressAgent : public ACharacter
+{
+	GENERATED_BODY()
+
+public:
+
+	ACrowdAvoidanceStressAgent(const FObjectInitializer& ObjectInitializer);
+};
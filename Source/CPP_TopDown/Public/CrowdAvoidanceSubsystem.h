@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UniformGrid2D.h"
+#include "CrowdAvoidanceSubsystem.generated.h"
+
+class UCrowdAvoidanceMovementComponent;
+
+/** Per-frame snapshot of one agent, read by the worker threads */
+struct FCrowdAvoidanceAgent
+{
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Velocity = FVector2D::ZeroVector;
+	FVector2D PreferredVelocity = FVector2D::ZeroVector;
+	float Radius = 0.f;
+	float MaxSpeed = 0.f;
+	float ConsiderationRadius = 0.f;
+};
+
+/** Running counters for ai.Avoidance.Stats */
+struct FCrowdAvoidanceStats
+{
+	uint64 Frames = 0;
+	uint64 AgentsSolved = 0;
+	double SolveSeconds = 0.0;
+	int32 PeakAgents = 0;
+};
+
+/**
+ * Reciprocal velocity obstacle (ORCA) avoidance for every UCrowdAvoidanceMovementComponent in the world,
+ * replacing the engine's per-component RVO.
+ * Once per frame all agents are snapshotted into a uniform grid, then a budgeted slice of them
+ * (round-robin, ai.Avoidance.MaxAgentsPerFrame) solves its ORCA linear program against its nearest
+ * neighbours in one ParallelFor. Results go back to the components, which apply them to the next
+ * requested velocity or input; agents left out of a frame's slice keep their last result for a few frames.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UCrowdAvoidanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterAgent(UCrowdAvoidanceMovementComponent* Agent);
+	void UnregisterAgent(UCrowdAvoidanceMovementComponent* Agent);
+
+	int32 GetNumAgents() const { return Agents.Num(); }
+
+	const FCrowdAvoidanceStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FCrowdAvoidanceStats(); }
+
+	/** Frames an avoidance result stays valid when the agent isn't re-solved */
+	static uint64 GetResultLifetimeFrames();
+
+protected:
+
+	/** Registered agents; each component caches its own index for O(1) removal */
+	UPROPERTY()
+	TArray<TObjectPtr<UCrowdAvoidanceMovementComponent>> Agents;
+
+	/** This frame's agent snapshots, parallel to Agents */
+	TArray<FCrowdAvoidanceAgent> Snapshots;
+
+	/** Agents to solve this frame and their results */
+	TArray<int32> SliceIndices;
+	TArray<FVector2D> SliceResults;
+
+	/** Agent positions, indexed like Snapshots */
+	FUniformGrid2D AgentGrid { 250.f };
+
+	/** Next agent to solve in the round-robin */
+	int32 NextAgent = 0;
+
+	FCrowdAvoidanceStats Stats;
+};
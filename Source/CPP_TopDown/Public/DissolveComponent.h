@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "DissolveComponent.generated.h"
+
+class UMaterialInstanceDynamic;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDissolveFinished, bool, bDissolvedOut);
+
+/**
+ * Dissolves / resolves the owner's mesh without per-frame CPU work.
+ * Each phase writes start time, duration and from/to values to the mesh MIDs once; the material
+ * evaluates lerp(From, To, saturate((Time - StartTime) / Duration)) itself. The only CPU event is
+ * OnDissolveFinished when the phase ends.
+ * Materials that don't expose StartTimeParameterName fall back to a component tick writing
+ * AmountParameterName with the real frame delta, so they still dissolve at the right speed.
+ * None of the shipped character materials have the time parameters yet, so until they get
+ * StartTime/Duration/From/To scalars and the lerp above, every dissolve takes the tick path.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class CPP_TOPDOWN_API UDissolveComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	// Sets default values for this component's properties
+	UDissolveComponent();
+
+	/** Fade the mesh out (ValueMin -> ValueMax) over Duration seconds */
+	UFUNCTION(BlueprintCallable, Category = "Dissolve")
+	void DissolveOut(float Duration);
+
+	/** Bring the mesh back (ValueMax -> ValueMin) over Duration seconds */
+	UFUNCTION(BlueprintCallable, Category = "Dissolve")
+	void ResolveIn(float Duration);
+
+	UFUNCTION(BlueprintCallable, Category = "Dissolve")
+	bool IsDissolving() const { return bPhaseActive; }
+
+	/** Fired once at the end of every phase */
+	UPROPERTY(BlueprintAssignable, Category = "Dissolve")
+	FOnDissolveFinished OnDissolveFinished;
+
+	/** Scalar the fallback path writes every frame (and the material's fully dissolved amount) */
+	UPROPERTY(EditAnywhere, Category = "Dissolve")
+	FName AmountParameterName = "DissolveAmount";
+
+	UPROPERTY(EditAnywhere, Category = "Dissolve|Material")
+	FName StartTimeParameterName = "DissolveStartTime";
+
+	UPROPERTY(EditAnywhere, Category = "Dissolve|Material")
+	FName DurationParameterName = "DissolveDuration";
+
+	UPROPERTY(EditAnywhere, Category = "Dissolve|Material")
+	FName FromParameterName = "DissolveFrom";
+
+	UPROPERTY(EditAnywhere, Category = "Dissolve|Material")
+	FName ToParameterName = "DissolveTo";
+
+	/** Fully visible */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dissolve")
+	float ValueMin = -0.032f;
+
+	/** Fully dissolved */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dissolve")
+	float ValueMax = 0.67f;
+
+protected:
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void StartPhase(float From, float To, float Duration, bool bOut);
+	void FinishPhase();
+
+	/** Creates MIDs on the owner's mesh the first time a phase starts */
+	void EnsureMIDs();
+
+	void WriteAmount(float Value);
+
+	UPROPERTY()
+	TArray<UMaterialInstanceDynamic*> DynamicMats;
+
+	/** True if the materials do the interpolation themselves */
+	bool bMaterialDriven = false;
+
+	bool bPhaseActive = false;
+	bool bPhaseOut = false;
+	float PhaseFrom = 0.f;
+	float PhaseTo = 0.f;
+	float PhaseDuration = 0.f;
+	float PhaseElapsed = 0.f;
+
+	FTimerHandle TimerHandle_PhaseEnd;
+
+public:	
+	// Only ticks for materials without the time parameters
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "EnemyDistanceSubsystem.generated.h"
+
+/**
+ * One enemy tracked by the distance band subsystem.
+ * Keys are resolved once when the enemy registers, never looked up by name afterwards.
+ */
+struct FEnemyDistanceEntry
+{
+	TWeakObjectPtr<UBlackboardComponent> Blackboard;
+	TObjectKey<UBlackboardComponent> BlackboardKey;
+	TWeakObjectPtr<AActor> Self;
+	TWeakObjectPtr<AActor> Target;
+
+	FBlackboard::FKey TargetKey = FBlackboard::InvalidKey;
+	FBlackboard::FKey DistanceKey = FBlackboard::InvalidKey;
+	FBlackboard::FKey BandKey = FBlackboard::InvalidKey;
+
+	/** Ascending distance thresholds; band N means "closer than Bands[N]" */
+	TArray<float, TInlineAllocator<4>> Bands;
+
+	/** Extra distance needed to leave an inner band again (prevents flicker on the border) */
+	float Hysteresis = 0.f;
+
+	/** Band we last wrote to the blackboard, INDEX_NONE until the first write */
+	int32 CurrentBand = INDEX_NONE;
+
+	/** The exact distance is rewritten at least this often even without a band change (0 = bands only) */
+	float RefreshInterval = 0.f;
+
+	float TimeSinceWrite = 0.f;
+};
+
+/**
+ * Computes every registered enemy's distance to its target in a single pass per frame
+ * and writes the blackboard as soon as an enemy crosses into a different distance band
+ * (e.g. melee / shoot / chase). Blackboard decorators observing the distance key then
+ * wake up by observer instead of a service polling it on every enemy. In between, the
+ * exact distance is only refreshed every RefreshInterval.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UEnemyDistanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts tracking the enemy owning this blackboard. Re-registering replaces the previous entry. */
+	void RegisterEnemy(UBlackboardComponent& Blackboard, AActor* Self,
+		FBlackboard::FKey TargetKey, FBlackboard::FKey DistanceKey, FBlackboard::FKey BandKey,
+		const TArray<float>& Bands, float Hysteresis, float RefreshInterval);
+
+	/** Stops tracking the enemy owning this blackboard */
+	void UnregisterEnemy(UBlackboardComponent& Blackboard);
+
+	int32 GetNumTrackedEnemies() const { return Entries.Num(); }
+
+protected:
+
+	/** Blackboard observer: the target object key changed, so re-cache the target actor */
+	EBlackboardNotificationResult OnTargetKeyChanged(const UBlackboardComponent& Blackboard, FBlackboard::FKey ChangedKey);
+
+	/** Picks the band for a distance, keeping the current band while inside the hysteresis margin */
+	static int32 ComputeBand(const FEnemyDistanceEntry& Entry, float Distance);
+
+	/** Writes distance (and band if a band key is set) to the entry's blackboard */
+	static void WriteBand(FEnemyDistanceEntry& Entry, float Distance, int32 NewBand);
+
+	void RemoveEntryAt(int32 Index);
+
+	TArray<FEnemyDistanceEntry> Entries;
+
+	/** Blackboard -> index into Entries */
+	TMap<TObjectKey<UBlackboardComponent>, int32> EntryIndices;
+
+	// Scratch buffers for the per-frame pass, kept around so we don't reallocate every tick
+	TArray<FVector> SelfLocations;
+	TArray<FVector> TargetLocations;
+	TArray<float> DistancesSquared;
+};
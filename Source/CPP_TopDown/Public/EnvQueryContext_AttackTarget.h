@@ -7,7 +7,9 @@
 #include "EnvQueryContext_AttackTarget.generated.h"
 
 /**
- * 
+ * The actor an enemy is currently attacking, as cached by its ABaseEnemyController.
+ * Resolving it is a couple of pointer reads (no blackboard lookup by name), so many
+ * enemies can run queries against this context in the same frame cheaply.
  */
 UCLASS()
 class CPP_TOPDOWN_API UEnvQueryContext_AttackTarget : public UEnvQueryContext
@@ -16,6 +18,9 @@ class CPP_TOPDOWN_API UEnvQueryContext_AttackTarget : public UEnvQueryContext
 	
 public:
 
+	virtual void ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const override;
+
+	/** Querier may be the enemy pawn or its controller */
 	virtual void ProvideSingleActor(UObject* QuerierObject, AActor*& ResultingActor) const;
 
 };
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FootstepNoiseComponent.generated.h"
+
+/**
+ * Turns "the player is moving" into footstep hearing stimuli at a sensible rate.
+ * Lives on the player controller; Move() calls ReportMovement() every triggered input and this
+ * component decides whether that becomes a noise event:
+ *  - the first step after standing still is reported immediately (AI reacts as fast as before)
+ *  - after that, one report per StrideDistance travelled, carrying the loudest merged step
+ *  - nothing is reported when no enemy is inside NoiseRange according to the perception grid (only when every enemy is on the grid)
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class CPP_TOPDOWN_API UFootstepNoiseComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:	
+	// Sets default values for this component's properties
+	UFootstepNoiseComponent();
+
+	/** Call whenever the controlled pawn gets movement input this frame */
+	void ReportMovement(float LoudnessScale = 1.f);
+
+	/** Distance the pawn has to cover between two footstep reports */
+	UPROPERTY(EditAnywhere, Category = "Footsteps", meta = (ClampMin = "1"))
+	float StrideDistance = 150.f;
+
+	/** Gap without movement input after which the next step counts as a fresh start */
+	UPROPERTY(EditAnywhere, Category = "Footsteps", meta = (ClampMin = "0"))
+	float StillnessResetTime = 0.25f;
+
+	/** How loud footsteps are */
+	UPROPERTY(EditAnywhere, Category = "Footsteps")
+	float Loudness = 1.f;
+
+	/** How far footsteps carry; also the radius checked for nearby listeners */
+	UPROPERTY(EditAnywhere, Category = "Footsteps")
+	float NoiseRange = 500.f;
+
+	// Counters for comparing against one report per movement input
+	int32 NumMovementInputs = 0;
+	int32 NumReported = 0;
+	int32 NumSkippedNoListener = 0;
+
+protected:
+
+	void EmitNoise(APawn& Pawn, float MergedLoudness);
+
+	FVector LastReportLocation = FVector::ZeroVector;
+	double LastMovementTime = -UE_BIG_NUMBER;
+
+	/** Loudest step since the last report */
+	float PendingLoudness = 0.f;
+};
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ReplaySession.h"
+#include "InputReplaySubsystem.generated.h"
+
+class ACPP_TopDownPlayerController;
+
+/** The player controller's input handlers, one entry per (action, trigger event) binding */
+UENUM()
+enum class EReplayedInput : uint8
+{
+	Move,
+	SelectFirstSpell,
+	SelectSecondSpell,
+	Fire,
+	FireStarted,
+	FireCompleted,
+	ArcStarted,
+	ArcCompleted,
+	Melee,
+	MeleeStarted,
+	MeleeCompleted,
+	DodgeStarted,
+	DodgeCompleted
+};
+
+/** One handler call, stamped with the frame (relative to the start of the recording) it happened on */
+struct FRecordedInputEvent
+{
+	int32 Frame = 0;
+	EReplayedInput Input = EReplayedInput::Move;
+	FVector2D Value = FVector2D::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FRecordedInputEvent& Event)
+	{
+		Ar << Event.Frame << Event.Input << Event.Value;
+		return Ar;
+	}
+};
+
+/**
+ * Records the player's Enhanced Input handler calls and plays them back frame for frame.
+ * Recording and playback both run on a fixed timestep and reseed the gameplay random stream,
+ * so the same session can be replayed headless against two builds and their captures compared.
+ *
+ *   replay.Record [Seed] [FPS]	start recording
+ *   replay.Stop [Name]			stop and save to Saved/InputReplays/<Name>.replay
+ *   replay.Play <Name>			play a recording back (live input is ignored meanwhile)
+ *
+ * -InputReplay=<Name> plays a recording as soon as the world begins play (add -ReplayExit to quit
+ * when it ends), and -InputRecord=<Name> records the whole session and saves on world teardown.
+ * A playback that dispatched any event on a different frame than it was recorded on is reported
+ * as an error (and exits with code 1 under -ReplayExit).
+ */
+UCLASS()
+class CPP_TOPDOWN_API UInputReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** The controller whose handlers are recorded / driven */
+	void RegisterController(ACPP_TopDownPlayerController* Controller);
+
+	/** False if another replay session (e.g. a strategy order recording) is already running */
+	bool StartRecording(int32 Seed, float FPS);
+	bool StopRecording(const FString& Name);
+
+	bool StartPlayback(const FString& Name);
+	void StopPlayback();
+
+	bool IsRecording() const { return bRecording; }
+	bool IsPlayingBack() const { return bPlayingBack; }
+
+	/** Called by the controller for every live handler call; false means "drop it, we're replaying" */
+	bool OnLiveInput(EReplayedInput Input, const FVector2D& Value);
+
+	/**
+	 * Called by the controller right after its live input was processed, so recorded events run
+	 * at the same point of the same frame they were recorded on.
+	 */
+	void DispatchRecordedInput();
+
+	/** Gameplay randomness that has to match between recording and playback */
+	FRandomStream& GetGameplayRandom() { return GameplayRandom; }
+
+protected:
+
+	static FString GetReplayPath(const FString& Name);
+
+	/** Seeds every random source and locks the timestep for a recording or playback */
+	bool BeginSession(int32 Seed, float FPS);
+	void EndSession();
+
+	FReplaySession Session{TEXT("InputReplay")};
+
+	TWeakObjectPtr<ACPP_TopDownPlayerController> Controller;
+
+	TArray<FRecordedInputEvent> Events;
+
+	FRandomStream GameplayRandom;
+
+	/** Frames since the recording/playback started */
+	int32 SessionFrame = 0;
+
+	/** Frames the recording being played back lasts */
+	int32 PlaybackFrames = 0;
+
+	/** Next event to dispatch during playback */
+	int32 PlaybackCursor = 0;
+
+	/** Events that ran on a different frame than they were recorded on (checked when playback ends) */
+	int32 FrameMismatches = 0;
+
+	bool bRecording = false;
+	bool bPlayingBack = false;
+	bool bExitAfterPlayback = false;
+
+	/** -InputRecord name, saved on Deinitialize */
+	FString AutoRecordName;
+};
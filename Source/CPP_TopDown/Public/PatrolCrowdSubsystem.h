@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PatrolCrowdSubsystem.generated.h"
+
+class APatrolRoute;
+class ABaseEnemyCharacter;
+
+/** All enemies walking one crowd-mode route, spread out along it */
+struct FPatrolCrowdGroup
+{
+	TWeakObjectPtr<APatrolRoute> Route;
+
+	TArray<TWeakObjectPtr<ABaseEnemyCharacter>> Members;
+
+	/** Arc-length offset of each member, parallel to Members: along the cycle on closed loops, from the rear of the column on open routes */
+	TArray<float> Offsets;
+
+	/** Slot location of each member this frame, parallel to Members */
+	TArray<FVector> SlotLocations;
+
+	/** How far the whole group has walked: along the cycle on closed loops, there and back along the column's travel on open routes */
+	float Phase = 0.f;
+
+	/** Cycle length the offsets were computed for; re-staggered if the route (re)bakes */
+	float StaggeredCycle = -1.f;
+};
+
+/**
+ * Lets many enemies share one APatrolRoute (with bCrowdMode set).
+ * Members get staggered arc-length offsets at least MinSpacing apart and the group walks
+ * the route together: once per frame every member's slot is evaluated in a single pass
+ * over the route's baked samples, pushed to the enemy, and Passive members are steered to it.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UPatrolCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void JoinCrowd(APatrolRoute* Route, ABaseEnemyCharacter* Enemy);
+	void LeaveCrowd(ABaseEnemyCharacter* Enemy);
+
+	int32 GetNumMembers() const;
+
+protected:
+
+	/** Spreads the members evenly over a closed loop (never closer than the route's MinSpacing), or packs them MinSpacing apart on an open route */
+	void RestaggerGroup(FPatrolCrowdGroup& Group);
+
+	void EvaluateGroup(FPatrolCrowdGroup& Group, float DeltaTime);
+
+	TArray<FPatrolCrowdGroup> Groups;
+};
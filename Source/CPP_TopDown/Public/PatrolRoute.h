@@ -7,6 +7,32 @@
 #include "Components/SplineComponent.h"
 #include "PatrolRoute.generated.h"
 
+/**
+ * Per-enemy position on a patrol route. Routes are shared, cursors are not:
+ * any number of enemies can walk the same APatrolRoute, each with its own cursor.
+ */
+USTRUCT(BlueprintType)
+struct FPatrolCursor
+{
+	GENERATED_BODY()
+
+	// Which spline‐point we’ve just reached
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Patrol")
+	int32 CurrentPoint = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Patrol")
+	int32 NextPoint = 1;
+
+	// +1 when going forward, –1 when going backward
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Patrol")
+	int32 Direction = 1;
+};
+
+/**
+ * Spline patrol route. The spline is baked at BeginPlay into world-space waypoints plus
+ * evenly spaced arc-length samples; after that the route never ticks and never touches
+ * the spline component again. Waypoints only advance when a walker calls AdvanceCursor.
+ */
 UCLASS()
 class CPP_TOPDOWN_API APatrolRoute : public AActor
 {
@@ -16,6 +42,7 @@ public:
 	// Sets default values for this actor's properties
 	APatrolRoute();
 
+	/** Legacy single-walker API, backed by DefaultCursor */
 	UFUNCTION(BlueprintCallable, Category = "Patrol")
 	FVector GetWorldSplineLocation() const;
 
@@ -23,40 +50,84 @@ public:
 	float GetAcceptanceRadius() const { return AcceptanceRadius; }
 
 	UFUNCTION(BlueprintCallable, Category = "Patrol")
-	int32 GetCurrentPatrolPoint() const { return CurrentPatrolPoint; }
+	int32 GetCurrentPatrolPoint() const { return DefaultCursor.CurrentPoint; }
 
 	UFUNCTION(BlueprintCallable, Category = "Patrol")
-	int32 GetNextPoint() const { return NextPoint; }
+	int32 GetNextPoint() const { return DefaultCursor.NextPoint; }
 
 	UFUNCTION(BlueprintCallable, Category = "Patrol")
 	void AdvancePatrolPoint();
 
+	/** Cursor starting at the given waypoint, heading forward */
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	FPatrolCursor MakeCursor(int32 StartPoint = 0) const;
+
+	/** World location of the waypoint the cursor is heading to */
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	FVector GetCursorLocation(const FPatrolCursor& Cursor) const;
+
+	/** Cursor reached its next waypoint: step forward, bouncing at the ends */
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	void AdvanceCursor(UPARAM(ref) FPatrolCursor& Cursor) const;
+
+	/** World location at an arc-length distance along the route (clamped to the ends) */
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	FVector GetLocationAtDistance(float Distance) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Patrol")
+	float GetRouteLength() const { return RouteLength; }
+
+	int32 GetNumWaypoints() const { return Waypoints.Num(); }
+
+	bool IsClosedLoop() const { return bClosedLoop; }
+
+	/** Length of one full patrol cycle: there and back again, or once around for closed loops */
+	float GetPatrolCycleLength() const { return bClosedLoop ? RouteLength : 2.f * RouteLength; }
+
+	/** Location at a distance along the patrol cycle (wraps, and walks back on open routes) */
+	FVector GetLocationAtCycleDistance(float CycleDistance) const;
+
+	bool IsCrowdMode() const { return bCrowdMode; }
+	float GetCrowdSpeed() const { return CrowdSpeed; }
+	float GetCrowdMinSpacing() const { return CrowdMinSpacing; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	USplineComponent* Spline;
-
-	// Which spline‐point we’ve just reached
-	UPROPERTY(VisibleAnywhere, Category = "Patrol")
-	int32 CurrentPatrolPoint = 0;
-
-	UPROPERTY(VisibleAnywhere, Category = "Patrol")
-	int32 NextPoint;
+	/** Copies the spline into Waypoints / Samples. Routes are assumed not to move afterwards. */
+	void BakeRoute();
 
-	// +1 when going forward, –1 when going backward
-	UPROPERTY(VisibleAnywhere, Category = "Patrol")
-	int32 PatrolDirection = 1;
+	USplineComponent* Spline;
 
 	// How close to a point counts as “reached”
 	UPROPERTY(EditAnywhere, Category = "Patrol")
 	float AcceptanceRadius = 10.f;
 
-	// For debugging / external reads
-	UPROPERTY(VisibleAnywhere, Category = "Patrol")
-	FVector TargetLocation = FVector::ZeroVector;
+	/** Arc-length spacing of the baked samples used by GetLocationAtDistance */
+	UPROPERTY(EditAnywhere, Category = "Patrol", meta = (ClampMin = "1"))
+	float SampleSpacing = 50.f;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	/** Enemies assigned to this route share it through UPatrolCrowdSubsystem instead of walking waypoints */
+	UPROPERTY(EditAnywhere, Category = "Patrol|Crowd")
+	bool bCrowdMode = false;
+
+	/** Speed the crowd slots move along the route */
+	UPROPERTY(EditAnywhere, Category = "Patrol|Crowd", meta = (EditCondition = "bCrowdMode", ClampMin = "0"))
+	float CrowdSpeed = 150.f;
+
+	/** Smallest arc-length gap between two crowd members */
+	UPROPERTY(EditAnywhere, Category = "Patrol|Crowd", meta = (EditCondition = "bCrowdMode", ClampMin = "0"))
+	float CrowdMinSpacing = 200.f;
+
+	/** Cursor used by the legacy GetWorldSplineLocation / AdvancePatrolPoint functions */
+	UPROPERTY(VisibleAnywhere, Category = "Patrol")
+	FPatrolCursor DefaultCursor;
+
+	// Baked data
+	TArray<FVector> Waypoints;
+	TArray<FVector> Samples;
+	float RouteLength = 0.f;
+	float SampleStep = 0.f;
+	bool bClosedLoop = false;
 };
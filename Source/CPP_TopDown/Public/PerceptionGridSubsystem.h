@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UniformGrid2D.h"
+#include "PerceptionGridSubsystem.generated.h"
+
+class ABaseEnemyController;
+
+/** Running totals so the grid scheduler can be compared against stock sight */
+struct FPerceptionGridStats
+{
+	uint64 Frames = 0;
+
+	/** Listener x target pairs stock sight walks every update */
+	uint64 StockPairChecks = 0;
+
+	/** Pairs the grid actually looked at (listeners in cells around a target) */
+	uint64 GridPairChecks = 0;
+
+	/** Pairs inside sight radius + cone, i.e. the line traces stock sight would request */
+	uint64 TracesRequested = 0;
+
+	/** Line traces issued by the grid scheduler (capped by the per-frame budget) */
+	uint64 TracesIssued = 0;
+
+	int32 PeakListeners = 0;
+};
+
+/**
+ * Project-side sight scheduler for enemy controllers.
+ * Listeners (enemy pawns) are bucketed into a uniform 2D grid every frame, and each target only
+ * considers listeners in nearby cells. Pairs that pass the radius and cone checks queue a line of
+ * sight trace; at most MaxTracesPerFrame traces run per frame, round-robin, so cost stays flat as
+ * the enemy count grows. Results are delivered to the controller as regular sight stimuli.
+ */
+UCLASS()
+class CPP_TOPDOWN_API UPerceptionGridSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterListener(ABaseEnemyController* Controller);
+	void UnregisterListener(ABaseEnemyController* Controller);
+
+	/** Enemies that keep stock sight; tracked only so noise culling knows the grid doesn't cover every hearer */
+	void RegisterUnscheduledListener(ABaseEnemyController* Controller);
+
+	/** Actors the listeners try to see (the player) */
+	void RegisterTarget(AActor* Target);
+	void UnregisterTarget(AActor* Target);
+
+	/** True if any registered listener pawn is within Radius (XY) of Location, as of the last grid rebuild */
+	bool HasListenerWithinRadius(const FVector& Location, float Radius) const;
+
+	int32 GetNumListeners() const { return Listeners.Num(); }
+
+	/** True if HasListenerWithinRadius can rule out every hearer: there are listeners and none of the enemies opted out of the grid */
+	bool CanCullNoise() const { return Listeners.Num() > 0 && UnscheduledListeners.Num() == 0; }
+
+	const FPerceptionGridStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FPerceptionGridStats(); }
+
+protected:
+
+	struct FSeenTarget
+	{
+		TWeakObjectPtr<AActor> Target;
+
+		/** Last frame this pair was still within range; anything older is reported as lost */
+		uint32 LastInRangeFrame = 0;
+	};
+
+	struct FListener
+	{
+		TWeakObjectPtr<ABaseEnemyController> Controller;
+
+		float SightRadiusSq = 0.f;
+		float LoseSightRadiusSq = 0.f;
+		float CosHalfAngle = 0.f;
+
+		TArray<FSeenTarget, TInlineAllocator<1>> SeenTargets;
+	};
+
+	struct FSightCandidate
+	{
+		int32 ListenerIndex = INDEX_NONE;
+		int32 TargetIndex = INDEX_NONE;
+		bool bCurrentlySeen = false;
+	};
+
+	void RebuildListenerGrid();
+	void GatherCandidates();
+	void RunTraces();
+	void ExpireOutOfRangeTargets();
+
+	bool HasLineOfSight(const APawn& ListenerPawn, const AActor& Target) const;
+	void SetSeen(FListener& Listener, AActor& Target, bool bSeen);
+
+	TArray<FListener> Listeners;
+	TArray<TWeakObjectPtr<ABaseEnemyController>> UnscheduledListeners;
+	TArray<TWeakObjectPtr<AActor>> Targets;
+
+	FUniformGrid2D ListenerGrid { 1000.f };
+
+	/** Largest lose-sight radius of any listener, used as the grid query radius */
+	float MaxQueryRadius = 0.f;
+
+	/** Scratch, rebuilt every frame */
+	TArray<FSightCandidate> Candidates;
+
+	/** Round-robin start into Candidates so deferred pairs get their turn next frame */
+	uint32 TraceCursor = 0;
+
+	uint32 FrameCounter = 0;
+
+	FPerceptionGridStats Stats;
+};
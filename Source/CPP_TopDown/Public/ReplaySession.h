@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+
+/** Header every replay file starts with, followed by the recording's own payload */
+struct FReplayFileHeader
+{
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 Seed = 0;
+	float FPS = 60.f;
+	int32 Frames = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FReplayFileHeader& Header)
+	{
+		Ar << Header.Magic << Header.Version << Header.Seed << Header.FPS << Header.Frames;
+		return Ar;
+	}
+};
+
+/**
+ * The part of a recording or playback the replay subsystems have in common: locking the fixed
+ * timestep, seeding the global random streams, and reading / writing the replay file around
+ * the subsystem's own payload.
+ * FApp's timestep is global, so only one session may run at a time. Begin() refuses to start
+ * while another session holds it, instead of the two overwriting each other's saved timestep.
+ */
+class CPP_TOPDOWN_API FReplaySession
+{
+public:
+
+	explicit FReplaySession(const TCHAR* InLogTag)
+		: LogTag(InLogTag)
+	{
+	}
+
+	~FReplaySession() { End(); }
+
+	/** Locks the timestep to FPS and seeds FMath's random streams; false if another session is running */
+	bool Begin(int32 InSeed, float InFPS);
+
+	/** Restores the timestep that was active before Begin() */
+	void End();
+
+	bool IsActive() const { return ActiveSession == this; }
+
+	int32 GetSeed() const { return Seed; }
+	float GetFPS() const { return FPS; }
+
+	/** Writes Header and then the payload to Path; returns the file size, INDEX_NONE on failure */
+	int32 Save(const FString& Path, FReplayFileHeader Header, TFunctionRef<void(FArchive&)> SerializePayload) const;
+
+	/** Reads Path, checking Magic and Version before the payload is read */
+	bool Load(const FString& Path, uint32 Magic, int32 Version, FReplayFileHeader& OutHeader, TFunctionRef<void(FArchive&)> SerializePayload) const;
+
+private:
+
+	/** Session currently holding the fixed timestep, if any */
+	static FReplaySession* ActiveSession;
+
+	const TCHAR* LogTag;
+
+	int32 Seed = 0;
+	float FPS = 60.f;
+
+	bool bPrevUseFixedTimeStep = false;
+	double PrevFixedDeltaTime = 0.0;
+};
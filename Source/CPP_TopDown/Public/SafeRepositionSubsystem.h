@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "SafeRepositionSubsystem.generated.h"
+
+/** Running totals, mostly to see how often the sync fallback still runs */
+struct FSafeRepositionStats
+{
+	uint64 Requests = 0;
+
+	/** Resolved from an async sweep that had already come back */
+	uint64 AsyncResolved = 0;
+
+	/** Had to sweep on the spot (result not back yet, or the mover drifted too far) */
+	uint64 SyncFallbacks = 0;
+
+	uint64 Cancelled = 0;
+};
+
+/**
+ * Resolves "move this shape from A towards B, stopping short of walls" ahead of time.
+ * Callers submit a request when the move becomes known (e.g. when a dodge starts dissolving),
+ * the capsule sweep runs as an async trace during the frame, and ResolveReposition() later
+ * returns the safe end point without touching physics. If the result isn't back yet, or the
+ * mover's start/end drifted more than the request's tolerance since submission, the sweep is
+ * done synchronously instead, so the answer is never stale.
+ */
+UCLASS()
+class CPP_TOPDOWN_API USafeRepositionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Queues an async capsule/sphere sweep from Start to End for Mover.
+	 * @param SafetyOffset	How far to stay back from a blocking hit
+	 * @param DriftTolerance	How far Start/End may move before the async answer is thrown away
+	 * @return Request id for ResolveReposition / CancelReposition (never 0)
+	 */
+	uint32 RequestReposition(AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		ECollisionChannel Channel = ECC_WorldStatic, float SafetyOffset = 10.f, float DriftTolerance = 50.f);
+
+	/**
+	 * Returns the safe end point for a request and forgets it.
+	 * Start/End are the mover's current values; pass the submitted ones if nothing changed.
+	 * An unknown request id (or 0) simply sweeps synchronously.
+	 */
+	FVector ResolveReposition(uint32 RequestId, AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		ECollisionChannel Channel = ECC_WorldStatic, float SafetyOffset = 10.f);
+
+	/** Drops a request whose result is no longer needed */
+	void CancelReposition(uint32 RequestId);
+
+	int32 GetNumPending() const { return Requests.Num(); }
+
+	const FSafeRepositionStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FSafeRepositionStats(); }
+
+protected:
+
+	struct FRepositionRequest
+	{
+		TWeakObjectPtr<AActor> Mover;
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		float SafetyOffset = 0.f;
+		float DriftToleranceSq = 0.f;
+
+		bool bHasResult = false;
+		FVector Result = FVector::ZeroVector;
+	};
+
+	/** Async trace callback; UserData carries the request id */
+	void OnSweepDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/** Turns a sweep's first blocking hit into an end point SafetyOffset short of it */
+	static FVector ComputeSafeEnd(const FVector& Start, const FVector& End, const FHitResult* BlockingHit, float SafetyOffset);
+
+	FVector SweepNow(AActor* Mover, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		ECollisionChannel Channel, float SafetyOffset) const;
+
+	TMap<uint32, FRepositionRequest> Requests;
+
+	FTraceDelegate SweepDelegate;
+
+	uint32 NextRequestId = 1;
+
+	FSafeRepositionStats Stats;
+};
@@ -35,8 +35,6 @@ protected:
 	UPROPERTY()
 	ABaseMagicCharacter* OwnerCharacter;
 
-	FTimerHandle StaggerTimerHandle;
-
 	bool bIsStaggered;
 
 	/** Internal helper to apply the "block" effects (disable movement, input, actions). */
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Flat uniform grid over the XY plane for neighbourhood queries.
+ * Items are added with an integer id, then Build() sorts them by cell so every
+ * cell is a contiguous run in one array (no per-cell allocations).
+ * Rebuild it whenever positions change; queries are only valid after Build().
+ */
+class FUniformGrid2D
+{
+public:
+
+	explicit FUniformGrid2D(float InCellSize = 500.f)
+		: CellSize(FMath::Max(InCellSize, 1.f))
+	{
+	}
+
+	void SetCellSize(float InCellSize)
+	{
+		CellSize = FMath::Max(InCellSize, 1.f);
+		Reset();
+	}
+
+	float GetCellSize() const { return CellSize; }
+	int32 Num() const { return Items.Num(); }
+
+	/** Clears all items but keeps the allocations */
+	void Reset()
+	{
+		Items.Reset();
+		CellRanges.Reset();
+	}
+
+	void Add(int32 Id, const FVector& Location)
+	{
+		FItem& Item = Items.AddDefaulted_GetRef();
+		Item.Id = Id;
+		Item.Location = FVector2D(Location);
+		Item.CellKey = MakeKey(ToCell(Location.X), ToCell(Location.Y));
+	}
+
+	/** Sorts the items by cell and indexes the runs. Call once after all Add()s. */
+	void Build()
+	{
+		Items.Sort([](const FItem& A, const FItem& B) { return A.CellKey < B.CellKey; });
+
+		CellRanges.Reset();
+		for (int32 Start = 0; Start < Items.Num();)
+		{
+			int32 End = Start + 1;
+			while (End < Items.Num() && Items[End].CellKey == Items[Start].CellKey)
+			{
+				++End;
+			}
+			CellRanges.Add(Items[Start].CellKey, FIntPoint(Start, End - Start));
+			Start = End;
+		}
+	}
+
+	/** Calls Visit(Id, Location2D) for every item within Radius of Center */
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Center, float Radius, FuncType&& Visit) const
+	{
+		const FVector2D Center2D(Center);
+		const float RadiusSq = Radius * Radius;
+
+		ForEachInBox(FBox2D(Center2D - FVector2D(Radius), Center2D + FVector2D(Radius)),
+			[&](int32 Id, const FVector2D& Location)
+			{
+				if (FVector2D::DistSquared(Location, Center2D) <= RadiusSq)
+				{
+					Visit(Id, Location);
+				}
+			});
+	}
+
+	/** Calls Visit(Id, Location2D) for every item inside the box */
+	template<typename FuncType>
+	void ForEachInBox(const FBox2D& Box, FuncType&& Visit) const
+	{
+		if (Items.Num() == 0) return;
+
+		const int32 MinX = ToCell(Box.Min.X), MaxX = ToCell(Box.Max.X);
+		const int32 MinY = ToCell(Box.Min.Y), MaxY = ToCell(Box.Max.Y);
+
+		for (int32 CellX = MinX; CellX <= MaxX; ++CellX)
+		{
+			for (int32 CellY = MinY; CellY <= MaxY; ++CellY)
+			{
+				const FIntPoint* Range = CellRanges.Find(MakeKey(CellX, CellY));
+				if (!Range) continue;
+
+				for (int32 i = Range->X; i < Range->X + Range->Y; ++i)
+				{
+					const FItem& Item = Items[i];
+					if (Box.IsInside(Item.Location))
+					{
+						Visit(Item.Id, Item.Location);
+					}
+				}
+			}
+		}
+	}
+
+	/** True if any item lies within Radius of Center (stops at the first hit) */
+	bool AnyInRadius(const FVector& Center, float Radius) const
+	{
+		const FVector2D Center2D(Center);
+		const float RadiusSq = Radius * Radius;
+
+		const int32 MinX = ToCell(Center2D.X - Radius), MaxX = ToCell(Center2D.X + Radius);
+		const int32 MinY = ToCell(Center2D.Y - Radius), MaxY = ToCell(Center2D.Y + Radius);
+
+		for (int32 CellX = MinX; CellX <= MaxX; ++CellX)
+		{
+			for (int32 CellY = MinY; CellY <= MaxY; ++CellY)
+			{
+				const FIntPoint* Range = CellRanges.Find(MakeKey(CellX, CellY));
+				if (!Range) continue;
+
+				for (int32 i = Range->X; i < Range->X + Range->Y; ++i)
+				{
+					if (FVector2D::DistSquared(Items[i].Location, Center2D) <= RadiusSq)
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+private:
+
+	struct FItem
+	{
+		uint64 CellKey = 0;
+		FVector2D Location = FVector2D::ZeroVector;
+		int32 Id = INDEX_NONE;
+	};
+
+	int32 ToCell(double Coord) const
+	{
+		return FMath::FloorToInt32(Coord / CellSize);
+	}
+
+	static uint64 MakeKey(int32 CellX, int32 CellY)
+	{
+		return (uint64(uint32(CellX)) << 32) | uint64(uint32(CellY));
+	}
+
+	float CellSize;
+
+	TArray<FItem> Items;
+
+	/** Cell key -> (first item index, item count) */
+	TMap<uint64, FIntPoint> CellRanges;
+};
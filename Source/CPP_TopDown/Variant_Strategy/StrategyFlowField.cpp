@@ -0,0 +1,516 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyFlowField.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "Tasks/Task.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace StrategyFlowField
+{
+	static float CellSize = 100.0f;
+	static FAutoConsoleVariableRef CVarCellSize(
+		TEXT("ai.FlowField.CellSize"),
+		CellSize,
+		TEXT("Smallest flow field cell size in cm. Grows on large maps to respect ai.FlowField.MaxCellsPerAxis"));
+
+	static int32 MaxCellsPerAxis = 256;
+	static FAutoConsoleVariableRef CVarMaxCellsPerAxis(
+		TEXT("ai.FlowField.MaxCellsPerAxis"),
+		MaxCellsPerAxis,
+		TEXT("Upper bound on flow field grid resolution along each axis"));
+
+	static float GridBuildBudgetMs = 2.0f;
+	static FAutoConsoleVariableRef CVarGridBuildBudgetMs(
+		TEXT("ai.FlowField.GridBuildBudgetMs"),
+		GridBuildBudgetMs,
+		TEXT("Game thread time per frame spent projecting the passability grid onto the navmesh"));
+
+	/** How far off the navmesh, horizontally, a grid sample may be and still count as on it */
+	static constexpr float ProjectionTolerance = 10.0f;
+
+	static bool bAsyncBuild = true;
+	static FAutoConsoleVariableRef CVarAsyncBuild(
+		TEXT("ai.FlowField.Async"),
+		bAsyncBuild,
+		TEXT("Build integration fields on a worker thread"));
+
+	/** Neighbour offsets, indexed by the values stored in FStrategyFlowField::Directions */
+	static const FIntPoint Neighbours[8] = {
+		FIntPoint(1, 0), FIntPoint(1, 1), FIntPoint(0, 1), FIntPoint(-1, 1),
+		FIntPoint(-1, 0), FIntPoint(-1, -1), FIntPoint(0, -1), FIntPoint(1, -1)
+	};
+
+	/** Normalized steering direction for each neighbour offset */
+	static const FVector NeighbourDirections[8] = {
+		FVector(1.0, 0.0, 0.0), FVector(UE_INV_SQRT_2, UE_INV_SQRT_2, 0.0), FVector(0.0, 1.0, 0.0), FVector(-UE_INV_SQRT_2, UE_INV_SQRT_2, 0.0),
+		FVector(-1.0, 0.0, 0.0), FVector(-UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.0), FVector(0.0, -1.0, 0.0), FVector(UE_INV_SQRT_2, -UE_INV_SQRT_2, 0.0)
+	};
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkCommand(
+		TEXT("ai.FlowField.Benchmark"),
+		TEXT("Usage: ai.FlowField.Benchmark [UnitCounts...]. For each unit count (default 100 1000 5000), compares one navmesh path search per unit against building a single flow field and sampling it once per unit."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UStrategyFlowFieldSubsystem* FlowFields = World ? World->GetSubsystem<UStrategyFlowFieldSubsystem>() : nullptr;
+			UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+			ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+			if (!FlowFields || !NavData)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[FlowFieldBench] no flow field subsystem or navigation data in this world"));
+				return;
+			}
+
+			TArray<int32> Counts;
+			for (const FString& Arg : Args)
+			{
+				Counts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+			}
+
+			if (Counts.Num() == 0)
+			{
+				Counts = { 100, 1000, 5000 };
+			}
+
+			double Start = FPlatformTime::Seconds();
+			TSharedPtr<const FStrategyFlowCostGrid, ESPMode::ThreadSafe> Grid = FlowFields->GetCostGrid();
+			const double GridMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			FNavLocation Goal;
+			if (!Grid.IsValid() || !NavSys->GetRandomPoint(Goal, NavData) || Grid->GetCellIndex(Goal.Location) == INDEX_NONE)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[FlowFieldBench] couldn't build the passability grid or pick a goal"));
+				return;
+			}
+
+			UE_LOG(LogTemp, Display, TEXT("[FlowFieldBench] grid %dx%d cells of %.0f cm, projected in %.2f ms"), Grid->Size.X, Grid->Size.Y, Grid->CellSize, GridMs);
+
+			const float SpawnRadius = FVector2D(NavSys->GetNavigableWorldBounds().GetExtent()).Size();
+
+			for (const int32 Count : Counts)
+			{
+				// unit start locations, not timed
+				TArray<FVector> Starts;
+				Starts.Reserve(Count);
+
+				for (int32 i = 0; i < Count; ++i)
+				{
+					FNavLocation Point;
+					if (NavSys->GetRandomReachablePointInRadius(Goal.Location, SpawnRadius, Point, NavData))
+					{
+						Starts.Add(Point.Location);
+					}
+				}
+
+				// one path search per unit, like MoveToLocation does
+				int32 PathsFound = 0;
+				Start = FPlatformTime::Seconds();
+				for (const FVector& UnitStart : Starts)
+				{
+					FPathFindingQuery Query(nullptr, *NavData, UnitStart, Goal.Location);
+					PathsFound += NavSys->FindPathSync(Query).IsSuccessful() ? 1 : 0;
+				}
+				const double PathMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+				// one field for everyone, then a sample per unit per frame
+				FStrategyFlowField Field;
+				Field.Grid = Grid;
+				Field.Goal = Goal.Location;
+				Field.GoalIndex = Grid->GetCellIndex(Goal.Location);
+
+				Start = FPlatformTime::Seconds();
+				Field.Build();
+				const double BuildMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+				int32 Sampled = 0;
+				FVector Direction;
+				float Distance;
+
+				Start = FPlatformTime::Seconds();
+				for (const FVector& UnitStart : Starts)
+				{
+					Sampled += Field.Sample(UnitStart, Direction, Distance) ? 1 : 0;
+				}
+				const double SampleMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+				UE_LOG(LogTemp, Display, TEXT("[FlowFieldBench] %d units: paths %.2f ms (%d found), field build %.2f ms + sampling %.3f ms/frame (%d on the field)"),
+					Starts.Num(), PathMs, PathsFound, BuildMs, SampleMs, Sampled);
+			}
+		}));
+}
+
+int32 FStrategyFlowCostGrid::GetCellIndex(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt32((Location.X - Origin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt32((Location.Y - Origin.Y) / CellSize);
+
+	if (X < 0 || Y < 0 || X >= Size.X || Y >= Size.Y)
+	{
+		return INDEX_NONE;
+	}
+
+	return Y * Size.X + X;
+}
+
+bool FStrategyFlowCostGrid::IsLinked(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const
+{
+	if (!IsPassable(X, Y) || !IsPassable(X + DeltaX, Y + DeltaY))
+	{
+		return false;
+	}
+
+	// the link flag lives on the cell with the lower coordinate
+	const int32 LowX = FMath::Min(X, X + DeltaX);
+	const int32 LowY = FMath::Min(Y, Y + DeltaY);
+
+	return (Flags[LowY * Size.X + LowX] & (DeltaX != 0 ? Flag_LinkX : Flag_LinkY)) != 0;
+}
+
+bool FStrategyFlowCostGrid::CanStep(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const
+{
+	if (DeltaX == 0 || DeltaY == 0)
+	{
+		return IsLinked(X, Y, DeltaX, DeltaY);
+	}
+
+	// diagonal steps need both orthogonal detours open, so they can't cut a corner or slip through a wall
+	return IsLinked(X, Y, DeltaX, 0) && IsLinked(X + DeltaX, Y, 0, DeltaY)
+		&& IsLinked(X, Y, 0, DeltaY) && IsLinked(X, Y + DeltaY, DeltaX, 0);
+}
+
+void FStrategyFlowField::Build()
+{
+	const FStrategyFlowCostGrid& CostGrid = *Grid;
+	const int32 NumCells = CostGrid.Size.X * CostGrid.Size.Y;
+
+	Integration.Init(MAX_flt, NumCells);
+	Directions.Init(NoDirection, NumCells);
+
+	// Dijkstra from the goal outwards over the 8-connected grid
+	struct FOpenCell
+	{
+		float Distance;
+		int32 Index;
+
+		bool operator<(const FOpenCell& Other) const { return Distance < Other.Distance; }
+	};
+
+	TArray<FOpenCell> Open;
+	Open.Reserve(NumCells / 4);
+
+	Integration[GoalIndex] = 0.0f;
+	Open.HeapPush(FOpenCell{ 0.0f, GoalIndex });
+
+	const float StepCost[2] = { CostGrid.CellSize, CostGrid.CellSize * UE_SQRT_2 };
+
+	while (Open.Num() > 0)
+	{
+		FOpenCell Current;
+		Open.HeapPop(Current, EAllowShrinking::No);
+
+		// stale entry, the cell was reached more cheaply since
+		if (Current.Distance > Integration[Current.Index])
+		{
+			continue;
+		}
+
+		const int32 X = Current.Index % CostGrid.Size.X;
+		const int32 Y = Current.Index / CostGrid.Size.X;
+
+		for (const FIntPoint& Offset : StrategyFlowField::Neighbours)
+		{
+			if (!CostGrid.CanStep(X, Y, Offset.X, Offset.Y))
+			{
+				continue;
+			}
+
+			const int32 NeighbourIndex = (Y + Offset.Y) * CostGrid.Size.X + (X + Offset.X);
+			const float Distance = Current.Distance + StepCost[Offset.X != 0 && Offset.Y != 0];
+
+			if (Distance < Integration[NeighbourIndex])
+			{
+				Integration[NeighbourIndex] = Distance;
+				Open.HeapPush(FOpenCell{ Distance, NeighbourIndex });
+			}
+		}
+	}
+
+	// point every reachable cell at its cheapest neighbour
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		if (Index == GoalIndex || Integration[Index] == MAX_flt)
+		{
+			continue;
+		}
+
+		const int32 X = Index % CostGrid.Size.X;
+		const int32 Y = Index / CostGrid.Size.X;
+
+		float Best = Integration[Index];
+
+		for (uint8 Dir = 0; Dir < 8; ++Dir)
+		{
+			const FIntPoint& Offset = StrategyFlowField::Neighbours[Dir];
+
+			if (CostGrid.CanStep(X, Y, Offset.X, Offset.Y))
+			{
+				const float Distance = Integration[(Y + Offset.Y) * CostGrid.Size.X + (X + Offset.X)];
+
+				if (Distance < Best)
+				{
+					Best = Distance;
+					Directions[Index] = Dir;
+				}
+			}
+		}
+	}
+
+	bReady.store(true, std::memory_order_release);
+}
+
+bool FStrategyFlowField::Sample(const FVector& Location, FVector& OutDirection, float& OutDistance) const
+{
+	const int32 Index = Grid->GetCellIndex(Location);
+
+	if (Index == INDEX_NONE || Integration[Index] == MAX_flt)
+	{
+		return false;
+	}
+
+	OutDistance = Integration[Index];
+
+	// inside the goal cell we steer straight at the goal
+	if (Index == GoalIndex)
+	{
+		OutDirection = (Goal - Location).GetSafeNormal2D();
+		return true;
+	}
+
+	if (Directions[Index] == NoDirection)
+	{
+		return false;
+	}
+
+	OutDirection = StrategyFlowField::NeighbourDirections[Directions[Index]];
+	return true;
+}
+
+bool UStrategyFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// the passability grid goes stale whenever the navmesh is rebuilt
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &UStrategyFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+
+	// have the grid ready before the first order instead of projecting it when one comes in
+	StartCostGridBuild();
+}
+
+void UStrategyFlowFieldSubsystem::Deinitialize()
+{
+	// builds in flight hold their own references, so this is safe while they finish
+	ActiveFields.Empty();
+	CostGrid.Reset();
+	PendingGrid.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UStrategyFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UStrategyFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	if (PendingGrid.IsValid())
+	{
+		ContinueCostGridBuild(StrategyFlowField::GridBuildBudgetMs * 0.001);
+	}
+
+	// release finished fields no unit is using anymore
+	ActiveFields.RemoveAllSwap([](const TSharedPtr<FStrategyFlowField, ESPMode::ThreadSafe>& Field)
+	{
+		return Field->IsReady() && Field.GetSharedReferenceCount() == 1;
+	}, EAllowShrinking::No);
+}
+
+TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe> UStrategyFlowFieldSubsystem::RequestField(const FVector& Goal, bool bAllowAsync)
+{
+	// never project the grid on demand; the order falls back to pathfinding until it's ready
+	if (!CostGrid.IsValid())
+	{
+		if (!PendingGrid.IsValid())
+		{
+			StartCostGridBuild();
+		}
+
+		return nullptr;
+	}
+
+	const int32 GoalIndex = CostGrid->GetCellIndex(Goal);
+
+	if (GoalIndex == INDEX_NONE || !CostGrid->IsPassable(GoalIndex))
+	{
+		return nullptr;
+	}
+
+	// share the field with any earlier order to the same cell
+	for (const TSharedPtr<FStrategyFlowField, ESPMode::ThreadSafe>& Field : ActiveFields)
+	{
+		if (Field->GoalIndex == GoalIndex && Field->Grid == CostGrid)
+		{
+			return Field;
+		}
+	}
+
+	TSharedPtr<FStrategyFlowField, ESPMode::ThreadSafe> Field = MakeShared<FStrategyFlowField, ESPMode::ThreadSafe>();
+	Field->Grid = CostGrid;
+	Field->Goal = Goal;
+	Field->GoalIndex = GoalIndex;
+
+	ActiveFields.Add(Field);
+
+	if (bAllowAsync && StrategyFlowField::bAsyncBuild)
+	{
+		// the task keeps the field alive until it's done, even if everyone else lets go of it
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Field]() { Field->Build(); });
+	}
+	else
+	{
+		Field->Build();
+	}
+
+	return Field;
+}
+
+TSharedPtr<const FStrategyFlowCostGrid, ESPMode::ThreadSafe> UStrategyFlowFieldSubsystem::GetCostGrid()
+{
+	if (!CostGrid.IsValid() && !PendingGrid.IsValid())
+	{
+		StartCostGridBuild();
+	}
+
+	if (PendingGrid.IsValid())
+	{
+		ContinueCostGridBuild(TNumericLimits<double>::Max());
+	}
+
+	return CostGrid;
+}
+
+bool UStrategyFlowFieldSubsystem::StartCostGridBuild()
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!NavSys)
+	{
+		return false;
+	}
+
+	const FBox Bounds = NavSys->GetNavigableWorldBounds();
+
+	if (!Bounds.IsValid)
+	{
+		return false;
+	}
+
+	// pick a cell size that keeps the grid within the resolution cap
+	const FVector Extent = Bounds.GetSize();
+	const int32 MaxCells = FMath::Max(StrategyFlowField::MaxCellsPerAxis, 1);
+	const float CellSize = FMath::Max3(StrategyFlowField::CellSize, float(Extent.X) / MaxCells, float(Extent.Y) / MaxCells);
+
+	PendingGrid = MakeShared<FStrategyFlowCostGrid, ESPMode::ThreadSafe>();
+	PendingGrid->Origin = FVector2D(Bounds.Min);
+	PendingGrid->CellSize = CellSize;
+	PendingGrid->Size = FIntPoint(FMath::Max(1, FMath::CeilToInt32(Extent.X / CellSize)), FMath::Max(1, FMath::CeilToInt32(Extent.Y / CellSize)));
+	PendingGrid->Flags.SetNumZeroed(PendingGrid->Size.X * PendingGrid->Size.Y);
+
+	PendingRow = 0;
+	PendingZ = Bounds.GetCenter().Z;
+	PendingZExtent = Extent.Z * 0.5f + 100.0f;
+
+	return true;
+}
+
+bool UStrategyFlowFieldSubsystem::ContinueCostGridBuild(double BudgetSeconds)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+
+	if (!NavSys || !PendingGrid.IsValid())
+	{
+		PendingGrid.Reset();
+		return false;
+	}
+
+	FStrategyFlowCostGrid& Grid = *PendingGrid;
+	const float HalfCell = Grid.CellSize * 0.5f;
+
+	// samples have to sit on the navmesh themselves; a wide extent would let cells next to a wall snap across it
+	const FVector ProjectionExtent(StrategyFlowField::ProjectionTolerance, StrategyFlowField::ProjectionTolerance, PendingZExtent);
+
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(Grid.Size.X * 3);
+
+	const double Start = FPlatformTime::Seconds();
+
+	// one batch per row: each cell's center, plus the midpoints towards its +X and +Y neighbours
+	while (PendingRow < Grid.Size.Y)
+	{
+		const int32 Y = PendingRow++;
+
+		Workload.Reset();
+
+		for (int32 X = 0; X < Grid.Size.X; ++X)
+		{
+			const FVector2D Center = Grid.Origin + (FVector2D(X, Y) + 0.5) * Grid.CellSize;
+			Workload.Emplace(FVector(Center.X, Center.Y, PendingZ));
+			Workload.Emplace(FVector(Center.X + HalfCell, Center.Y, PendingZ));
+			Workload.Emplace(FVector(Center.X, Center.Y + HalfCell, PendingZ));
+		}
+
+		NavSys->BatchProjectPoints(Workload, ProjectionExtent);
+
+		for (int32 X = 0; X < Grid.Size.X; ++X)
+		{
+			uint8& CellFlags = Grid.Flags[Y * Grid.Size.X + X];
+			CellFlags = uint8((Workload[X * 3].bResult ? FStrategyFlowCostGrid::Flag_Passable : 0)
+				| (Workload[X * 3 + 1].bResult ? FStrategyFlowCostGrid::Flag_LinkX : 0)
+				| (Workload[X * 3 + 2].bResult ? FStrategyFlowCostGrid::Flag_LinkY : 0));
+		}
+
+		if (FPlatformTime::Seconds() - Start >= BudgetSeconds)
+		{
+			break;
+		}
+	}
+
+	if (PendingRow < Grid.Size.Y)
+	{
+		return false;
+	}
+
+	// fields already handed out keep their old grid; new requests pick up this one
+	CostGrid = PendingGrid;
+	PendingGrid.Reset();
+
+	return true;
+}
+
+void UStrategyFlowFieldSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	// the old grid keeps serving orders until the new one is projected
+	StartCostGridBuild();
+}
@@ -0,0 +1,165 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include <atomic>
+#include "StrategyFlowField.generated.h"
+
+class ANavigationData;
+
+/**
+ *  Coarse passability grid over the navigable area
+ *  Projected from the navmesh a few rows per frame and shared read-only by all flow fields
+ *  until the navmesh is rebuilt. A cell is passable if its center lies on the navmesh, and two
+ *  neighbouring cells are linked if the midpoint between their centers does too, so walls
+ *  thinner than a cell still cut the grid apart.
+ */
+struct FStrategyFlowCostGrid
+{
+	/** Cell flags */
+	static constexpr uint8 Flag_Passable = 1 << 0;
+	static constexpr uint8 Flag_LinkX = 1 << 1;		// can step to X + 1
+	static constexpr uint8 Flag_LinkY = 1 << 2;		// can step to Y + 1
+
+	/** World XY of the grid's min corner */
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	/** Number of cells along X and Y */
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	/** Size of one square cell */
+	float CellSize = 100.0f;
+
+	/** Flag_ bits per cell */
+	TArray<uint8> Flags;
+
+	/** Returns the index of the cell containing the location, INDEX_NONE if outside the grid */
+	int32 GetCellIndex(const FVector& Location) const;
+
+	/** Returns true if a unit can step from the cell to its neighbour. Diagonal steps may not cut corners */
+	bool CanStep(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const;
+
+	bool IsPassable(int32 X, int32 Y) const
+	{
+		return X >= 0 && Y >= 0 && X < Size.X && Y < Size.Y && (Flags[Y * Size.X + X] & Flag_Passable) != 0;
+	}
+
+	bool IsPassable(int32 Index) const
+	{
+		return Flags.IsValidIndex(Index) && (Flags[Index] & Flag_Passable) != 0;
+	}
+
+	/** Returns true if both cells are passable and the edge between them is open. Orthogonal steps only */
+	bool IsLinked(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const;
+};
+
+/**
+ *  Integration field and flow directions towards a single destination
+ *  Every unit heading to the destination samples the same field for steering instead of
+ *  running its own path search.
+ */
+struct FStrategyFlowField
+{
+	/** Passability grid this field was integrated over */
+	TSharedPtr<const FStrategyFlowCostGrid, ESPMode::ThreadSafe> Grid;
+
+	/** Destination of the field */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Grid cell of the destination */
+	int32 GoalIndex = INDEX_NONE;
+
+	/** Path distance from each cell to the goal, MAX_flt where unreachable */
+	TArray<float> Integration;
+
+	/** Index into the neighbour table of the next cell towards the goal, per cell */
+	TArray<uint8> Directions;
+
+	/** Set once Build has finished, possibly on a worker thread */
+	std::atomic<bool> bReady { false };
+
+	/** Runs the integration pass and fills in the flow directions */
+	void Build();
+
+	bool IsReady() const { return bReady.load(std::memory_order_acquire); }
+
+	/**
+	 *  Samples the field at a location. Only valid once the field is ready
+	 *  @param Location			world location to sample
+	 *  @param OutDirection		normalized XY direction to steer in
+	 *  @param OutDistance		path distance left to the goal
+	 *  @return false if the location is off the grid or can't reach the goal
+	 */
+	bool Sample(const FVector& Location, FVector& OutDirection, float& OutDistance) const;
+
+	/** Value used for cells without a direction */
+	static constexpr uint8 NoDirection = 0xFF;
+};
+
+/**
+ *  Builds and shares flow fields for large group move orders
+ *  The passability grid is projected from the navmesh when play begins and again whenever
+ *  navigation is rebuilt, a few rows per frame within ai.FlowField.GridBuildBudgetMs, so no
+ *  move order ever waits on it. Each requested destination gets one integration field, built
+ *  on a worker thread, which is reused by later requests for the same cell and released once
+ *  no unit holds on to it anymore.
+ */
+UCLASS()
+class UStrategyFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Shared passability grid, nullptr until the first build has finished */
+	TSharedPtr<FStrategyFlowCostGrid, ESPMode::ThreadSafe> CostGrid;
+
+	/** Grid being projected over several frames; replaces CostGrid once it's complete */
+	TSharedPtr<FStrategyFlowCostGrid, ESPMode::ThreadSafe> PendingGrid;
+
+	/** Next row of PendingGrid to project */
+	int32 PendingRow = 0;
+
+	/** Height and vertical half extent of the pending grid's projections */
+	float PendingZ = 0.0f;
+	float PendingZExtent = 0.0f;
+
+	/** Fields handed out to units, including ones still being built */
+	TArray<TSharedPtr<FStrategyFlowField, ESPMode::ThreadSafe>> ActiveFields;
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 *  Returns a flow field towards the goal, starting a build if there isn't one for its cell yet
+	 *  The field may not be ready yet; check IsReady before sampling.
+	 *  @return nullptr if the passability grid isn't built yet or the goal is off the navigable grid
+	 */
+	TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe> RequestField(const FVector& Goal, bool bAllowAsync = true);
+
+	/** Returns the passability grid, finishing any pending build on the spot. Blocks, so only meant for tools and benchmarks */
+	TSharedPtr<const FStrategyFlowCostGrid, ESPMode::ThreadSafe> GetCostGrid();
+
+	/** Number of fields currently alive */
+	int32 GetNumActiveFields() const { return ActiveFields.Num(); }
+
+protected:
+
+	/** Starts projecting the navigable bounds into a fresh passability grid */
+	bool StartCostGridBuild();
+
+	/** Projects rows of the pending grid until the time budget runs out; returns true once the grid is complete */
+	bool ContinueCostGridBuild(double BudgetSeconds);
+
+	/** Rebuilds the passability grid against the new navmesh */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+};
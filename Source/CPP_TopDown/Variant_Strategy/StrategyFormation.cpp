@@ -0,0 +1,288 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyFormation.h"
+#include "NavigationSystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+
+void FStrategyFormation::ComputeSlots(EStrategyFormationShape Shape, const FVector& Goal, const FVector& Facing, int32 NumSlots, float Spacing, TArray<FVector>& OutSlots)
+{
+	OutSlots.Reset(NumSlots);
+
+	if (NumSlots <= 0)
+	{
+		return;
+	}
+
+	// build the formation in local space (X forward, Y right) and rotate it onto the facing direction
+	FVector Forward = Facing.GetSafeNormal2D();
+
+	if (Forward.IsNearlyZero())
+	{
+		Forward = FVector::ForwardVector;
+	}
+
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+
+	auto AddSlot = [&](float LocalX, float LocalY)
+	{
+		OutSlots.Add(Goal + Forward * LocalX + Right * LocalY);
+	};
+
+	switch (Shape)
+	{
+	case SFS_Grid:
+		{
+			// roughly square block centered on the goal, last row centered on the others
+			const int32 Columns = FMath::CeilToInt32(FMath::Sqrt(float(NumSlots)));
+			const int32 Rows = FMath::DivideAndRoundUp(NumSlots, Columns);
+
+			for (int32 Row = 0; Row < Rows; ++Row)
+			{
+				const int32 InRow = FMath::Min(Columns, NumSlots - Row * Columns);
+				const float X = ((Rows - 1) * 0.5f - Row) * Spacing;
+
+				for (int32 Column = 0; Column < InRow; ++Column)
+				{
+					AddSlot(X, (Column - (InRow - 1) * 0.5f) * Spacing);
+				}
+			}
+		}
+		break;
+
+	case SFS_Wedge:
+		{
+			// tip on the goal, each row one slot wider than the one in front of it
+			for (int32 Row = 0; OutSlots.Num() < NumSlots; ++Row)
+			{
+				const int32 InRow = FMath::Min(Row + 1, NumSlots - OutSlots.Num());
+
+				for (int32 Column = 0; Column < InRow; ++Column)
+				{
+					AddSlot(-Row * Spacing, (Column - Row * 0.5f) * Spacing);
+				}
+			}
+		}
+		break;
+
+	case SFS_Circle:
+		{
+			// one slot on the goal, then concentric rings spaced evenly along their circumference
+			AddSlot(0.0f, 0.0f);
+
+			for (int32 Ring = 1; OutSlots.Num() < NumSlots; ++Ring)
+			{
+				const int32 Capacity = FMath::FloorToInt32(UE_TWO_PI * Ring);
+				const int32 InRing = FMath::Min(Capacity, NumSlots - OutSlots.Num());
+				const float Radius = Ring * Spacing;
+
+				for (int32 i = 0; i < InRing; ++i)
+				{
+					float Sin, Cos;
+					FMath::SinCos(&Sin, &Cos, UE_TWO_PI * i / InRing);
+					AddSlot(Cos * Radius, Sin * Radius);
+				}
+			}
+		}
+		break;
+	}
+}
+
+bool FStrategyFormation::ProjectSlots(UWorld* World, const FVector& Goal, float Spacing, TArray<FVector>& InOutSlots)
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+
+	if (!NavSys)
+	{
+		return false;
+	}
+
+	// project the goal and every slot in a single batch. The goal goes first
+	TArray<FNavigationProjectionWork> Workload;
+	Workload.Reserve(InOutSlots.Num() + 1);
+
+	Workload.Emplace(Goal);
+
+	for (const FVector& Slot : InOutSlots)
+	{
+		Workload.Emplace(Slot);
+	}
+
+	NavSys->BatchProjectPoints(Workload, FVector(Spacing * 0.5f, Spacing * 0.5f, 250.0f));
+
+	if (!Workload[0].bResult)
+	{
+		return false;
+	}
+
+	// slots off the navmesh fall back to the goal, the unit will settle next to its neighbours
+	const FVector ProjectedGoal = Workload[0].OutLocation.Location;
+
+	for (int32 i = 0; i < InOutSlots.Num(); ++i)
+	{
+		const FNavigationProjectionWork& Work = Workload[i + 1];
+		InOutSlots[i] = Work.bResult ? Work.OutLocation.Location : ProjectedGoal;
+	}
+
+	return true;
+}
+
+void FStrategyFormation::AssignSlots(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, const FVector& Facing, TArray<int32>& OutSlotForUnit)
+{
+	check(UnitLocations.Num() == Slots.Num());
+
+	if (UnitLocations.Num() <= MaxExactAssignment)
+	{
+		AssignExact(UnitLocations, Slots, OutSlotForUnit);
+	}
+	else
+	{
+		AssignSweep(UnitLocations, Slots, Facing, OutSlotForUnit);
+	}
+}
+
+void FStrategyFormation::AssignExact(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit)
+{
+	const int32 N = UnitLocations.Num();
+
+	// squared distances, so a few moderate moves are preferred over one long one
+	TArray<double> Cost;
+	Cost.SetNumUninitialized(N * N);
+
+	for (int32 Unit = 0; Unit < N; ++Unit)
+	{
+		for (int32 Slot = 0; Slot < N; ++Slot)
+		{
+			Cost[Unit * N + Slot] = FVector::DistSquared2D(UnitLocations[Unit], Slots[Slot]);
+		}
+	}
+
+	// Hungarian algorithm with row/column potentials. Arrays are 1-based, index 0 is a sentinel column
+	TArray<double> RowPotential, ColumnPotential, MinSlack;
+	TArray<int32> RowForColumn, PrevColumn;
+	TBitArray<> Visited;
+
+	RowPotential.Init(0.0, N + 1);
+	ColumnPotential.Init(0.0, N + 1);
+	RowForColumn.Init(0, N + 1);
+	PrevColumn.Init(0, N + 1);
+
+	for (int32 Row = 1; Row <= N; ++Row)
+	{
+		RowForColumn[0] = Row;
+		int32 Column = 0;
+
+		MinSlack.Init(TNumericLimits<double>::Max(), N + 1);
+		Visited.Init(false, N + 1);
+
+		// grow an alternating tree until we reach a free column
+		do
+		{
+			Visited[Column] = true;
+
+			const int32 CurrentRow = RowForColumn[Column];
+			double Delta = TNumericLimits<double>::Max();
+			int32 NextColumn = 0;
+
+			for (int32 j = 1; j <= N; ++j)
+			{
+				if (!Visited[j])
+				{
+					const double Slack = Cost[(CurrentRow - 1) * N + (j - 1)] - RowPotential[CurrentRow] - ColumnPotential[j];
+
+					if (Slack < MinSlack[j])
+					{
+						MinSlack[j] = Slack;
+						PrevColumn[j] = Column;
+					}
+
+					if (MinSlack[j] < Delta)
+					{
+						Delta = MinSlack[j];
+						NextColumn = j;
+					}
+				}
+			}
+
+			for (int32 j = 0; j <= N; ++j)
+			{
+				if (Visited[j])
+				{
+					RowPotential[RowForColumn[j]] += Delta;
+					ColumnPotential[j] -= Delta;
+				}
+				else
+				{
+					MinSlack[j] -= Delta;
+				}
+			}
+
+			Column = NextColumn;
+
+		} while (RowForColumn[Column] != 0);
+
+		// flip the augmenting path
+		do
+		{
+			const int32 Prev = PrevColumn[Column];
+			RowForColumn[Column] = RowForColumn[Prev];
+			Column = Prev;
+
+		} while (Column != 0);
+	}
+
+	OutSlotForUnit.SetNumUninitialized(N);
+
+	for (int32 j = 1; j <= N; ++j)
+	{
+		OutSlotForUnit[RowForColumn[j] - 1] = j - 1;
+	}
+}
+
+void FStrategyFormation::AssignSweep(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, const FVector& Facing, TArray<int32>& OutSlotForUnit)
+{
+	const int32 N = UnitLocations.Num();
+
+	FVector Forward = Facing.GetSafeNormal2D();
+
+	if (Forward.IsNearlyZero())
+	{
+		Forward = FVector::ForwardVector;
+	}
+
+	const FVector Right = FVector::CrossProduct(FVector::UpVector, Forward);
+
+	// sort both sides front to back
+	TArray<int32> UnitOrder, SlotOrder;
+	UnitOrder.SetNumUninitialized(N);
+	SlotOrder.SetNumUninitialized(N);
+
+	for (int32 i = 0; i < N; ++i)
+	{
+		UnitOrder[i] = SlotOrder[i] = i;
+	}
+
+	UnitOrder.Sort([&](int32 A, int32 B) { return FVector::DotProduct(UnitLocations[A], Forward) > FVector::DotProduct(UnitLocations[B], Forward); });
+	SlotOrder.Sort([&](int32 A, int32 B) { return FVector::DotProduct(Slots[A], Forward) > FVector::DotProduct(Slots[B], Forward); });
+
+	// pair them up in rows, sorted left to right within each row, so paths don't cross
+	const int32 RowSize = FMath::Max(1, FMath::CeilToInt32(FMath::Sqrt(float(N))));
+
+	OutSlotForUnit.SetNumUninitialized(N);
+
+	for (int32 RowStart = 0; RowStart < N; RowStart += RowSize)
+	{
+		const int32 Count = FMath::Min(RowSize, N - RowStart);
+
+		TArrayView<int32> UnitRow(UnitOrder.GetData() + RowStart, Count);
+		TArrayView<int32> SlotRow(SlotOrder.GetData() + RowStart, Count);
+
+		UnitRow.Sort([&](int32 A, int32 B) { return FVector::DotProduct(UnitLocations[A], Right) < FVector::DotProduct(UnitLocations[B], Right); });
+		SlotRow.Sort([&](int32 A, int32 B) { return FVector::DotProduct(Slots[A], Right) < FVector::DotProduct(Slots[B], Right); });
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			OutSlotForUnit[UnitRow[i]] = SlotRow[i];
+		}
+	}
+}
@@ -0,0 +1,63 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StrategyFormation.generated.h"
+
+class UWorld;
+
+UENUM(BlueprintType)
+enum EStrategyFormationShape : uint8
+{
+	SFS_Grid	UMETA(DisplayName = "Grid"),
+	SFS_Wedge	UMETA(DisplayName = "Wedge"),
+	SFS_Circle	UMETA(DisplayName = "Circle")
+};
+
+/**
+ *  Formation planner for group move orders
+ *  Lays out one slot per unit around the goal in a single pass, projects all slots to the
+ *  navmesh in one batch and matches units to slots so that the total travel distance is minimal.
+ */
+struct FStrategyFormation
+{
+	/**
+	 *  Computes formation slots around the goal
+	 *  @param Shape		formation layout
+	 *  @param Goal			world location the formation is arranged around
+	 *  @param Facing		direction the formation faces, only XY is used
+	 *  @param NumSlots		number of slots to generate
+	 *  @param Spacing		distance between neighbouring slots
+	 *  @param OutSlots		receives the slot locations
+	 */
+	static void ComputeSlots(EStrategyFormationShape Shape, const FVector& Goal, const FVector& Facing, int32 NumSlots, float Spacing, TArray<FVector>& OutSlots);
+
+	/**
+	 *  Projects all slots to the navmesh in a single batch query
+	 *  Slots that can't be projected are moved onto the projected goal instead.
+	 *  @return false if the goal itself is not on the navmesh
+	 */
+	static bool ProjectSlots(UWorld* World, const FVector& Goal, float Spacing, TArray<FVector>& InOutSlots);
+
+	/**
+	 *  Assigns one slot to each unit so the summed squared travel distance is minimal
+	 *  Groups above MaxExactAssignment are matched with a row sweep instead of the exact solver.
+	 *  @param UnitLocations	current unit locations
+	 *  @param Slots			slot locations, same count as units
+	 *  @param Facing			direction the formation faces, used by the row sweep
+	 *  @param OutSlotForUnit	receives the slot index for each unit
+	 */
+	static void AssignSlots(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, const FVector& Facing, TArray<int32>& OutSlotForUnit);
+
+	/** Largest group solved exactly. The exact solver is cubic, so bigger groups use the row sweep */
+	static constexpr int32 MaxExactAssignment = 128;
+
+private:
+
+	/** Hungarian algorithm over a square cost matrix */
+	static void AssignExact(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, TArray<int32>& OutSlotForUnit);
+
+	/** Matches the front-most units to the front-most slots row by row, left to right within each row */
+	static void AssignSweep(TConstArrayView<FVector> UnitLocations, TConstArrayView<FVector> Slots, const FVector& Facing, TArray<int32>& OutSlotForUnit);
+};
@@ -2,9 +2,13 @@
 
 
 #include "StrategyHUD.h"
+#include "CPP_TopDown.h"
 #include "StrategyUnit.h"
 #include "StrategyPlayerController.h"
 #include "StrategyUI.h"
+#include "StrategySelectionMarkers.h"
+
+DECLARE_CYCLE_STAT(TEXT("StrategyHUD DrawHUD"), STAT_WizardDungeon_StrategyDrawHUD, STATGROUP_WizardDungeon);
 
 void AStrategyHUD::BeginPlay()
 {
@@ -16,6 +20,21 @@ void AStrategyHUD::BeginPlay()
 
 	// add the UI widget to the screen
 	UIWidget->AddToViewport(0);
+
+	// spawn the selection markers
+	UClass* MarkersClass = SelectionMarkersClass ? SelectionMarkersClass.Get() : AStrategySelectionMarkers::StaticClass();
+	SelectionMarkers = GetWorld()->SpawnActor<AStrategySelectionMarkers>(MarkersClass);
+}
+
+void AStrategyHUD::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// destroy the selection markers
+	if (IsValid(SelectionMarkers))
+	{
+		SelectionMarkers->Destroy();
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AStrategyHUD::DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, FVector2D CurrentPosition, bool bDraw)
@@ -30,6 +49,8 @@ void AStrategyHUD::DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, F
 
 void AStrategyHUD::DrawHUD()
 {
+	SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_StrategyDrawHUD);
+
 	// draw all debug information, etc.
 	Super::DrawHUD();
 
@@ -40,38 +61,10 @@ void AStrategyHUD::DrawHUD()
 		if (bDrawBox)
 		{
 			DrawRect(SelectionBoxColor, BoxStart.X, BoxStart.Y, BoxSize.X, BoxSize.Y);
-
-			// get all the units in the selection box
-			TArray<AStrategyUnit*> BoxedUnits;
-			GetActorsInSelectionRectangle(BoxStart, BoxCurrentPosition, BoxedUnits, true);
-
-			// update the unit selection on the player controller
-			PC->DragSelectUnits(BoxedUnits);
 		}
 
-		// get the currently selected units
-		TArray<AStrategyUnit*> SelectedUnits = PC->GetSelectedUnits();
-
-		// update the selection count on the UI widget
-		UIWidget->SetSelectedUnitsCount(SelectedUnits.Num());
-
-		// process each selected unit
-		for (AStrategyUnit* CurrentUnit : SelectedUnits)
-		{
-			if (IsValid(CurrentUnit))
-			{
-				// project the unit's location to screen coordinates
-				FVector2D ScreenCoords;
-
-				if (PC->ProjectWorldLocationToScreen(CurrentUnit->GetActorLocation(), ScreenCoords, true))
-				{
-					// draw a selection string near the unit
-					const FString SelectionString = "Selected";
-					DrawText(SelectionString, FColor::White, ScreenCoords.X - 25.0f, ScreenCoords.Y + 25.0f, nullptr, 1.5f);
-				}
-			}
-			
-		}
+		// update the selection count on the UI widget. Selected units are marked by the selection markers actor
+		UIWidget->SetSelectedUnitsCount(PC->GetSelectedUnits().Num());
 	}
 
 }
@@ -7,6 +7,7 @@
 #include "StrategyHUD.generated.h"
 
 class UStrategyUI;
+class AStrategySelectionMarkers;
 
 /**
  *  Simple strategy game HUD
@@ -38,6 +39,13 @@ protected:
 	/** Current position of the selection box */
 	FVector2D BoxCurrentPosition;
 
+	/** Actor drawing the instanced markers under selected units */
+	TObjectPtr<AStrategySelectionMarkers> SelectionMarkers;
+
+	/** Type of selection markers actor to spawn */
+	UPROPERTY(EditAnywhere, Category="UI")
+	TSubclassOf<AStrategySelectionMarkers> SelectionMarkersClass;
+
 	/** Color of the selection box */
 	UPROPERTY(EditAnywhere, Category="UI")
 	FLinearColor SelectionBoxColor;
@@ -47,6 +55,9 @@ public:
 	/** Initialization */
 	virtual void BeginPlay() override;
 
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Updates the drag selection box */
 	void DragSelectUpdate(FVector2D Start, FVector2D WidthAndHeight, FVector2D CurrentPosition, bool bDraw);
 
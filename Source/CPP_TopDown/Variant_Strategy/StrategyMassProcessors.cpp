@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyMassProcessors.h"
+#include "StrategyMassSubsystem.h"
+#include "StrategyMassTypes.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "MassExecutionContext.h"
+#include "MassEntityManager.h"
+#include "Engine/World.h"
+
+UStrategyMassMoveProcessor::UStrategyMassMoveProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+}
+
+void UStrategyMassMoveProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FStrategyMassUnitFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FStrategyMassSimulatedTag>(EMassFragmentPresence::All);
+}
+
+void UStrategyMassMoveProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const float DeltaTime = Context.GetDeltaTimeSeconds();
+	const float WanderRadius = UStrategyMassSubsystem::GetWanderRadius();
+
+	EntityQuery.ParallelForEachEntityChunk(Context, [DeltaTime, WanderRadius](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FStrategyMassUnitFragment> Units = ChunkContext.GetMutableFragmentView<FStrategyMassUnitFragment>();
+
+		for (FStrategyMassUnitFragment& Unit : Units)
+		{
+			// idle units pick somewhere new to go
+			if (!Unit.bMoving)
+			{
+				if (WanderRadius > 0.0f)
+				{
+					Unit.PickWanderDestination(WanderRadius);
+				}
+
+				continue;
+			}
+
+			// straight line, no avoidance: nobody is watching
+			const FVector2D ToDestination(Unit.Destination - Unit.Location);
+			const double Distance = ToDestination.Size();
+			const double Step = Unit.Speed * DeltaTime;
+
+			if (Distance <= Step)
+			{
+				Unit.Location.X = Unit.Destination.X;
+				Unit.Location.Y = Unit.Destination.Y;
+				Unit.bMoving = false;
+			}
+			else
+			{
+				Unit.Location += FVector(ToDestination * (Step / Distance), 0.0);
+			}
+		}
+	});
+}
+
+UStrategyMassRepresentationProcessor::UStrategyMassRepresentationProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+
+	// spawns and destroys actors
+	bRequiresGameThreadExecution = true;
+}
+
+void UStrategyMassRepresentationProcessor::ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager)
+{
+	EntityQuery.AddRequirement<FStrategyMassUnitFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FStrategyMassActorFragment>(EMassFragmentAccess::ReadWrite);
+}
+
+void UStrategyMassRepresentationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UWorld* World = EntityManager.GetWorld();
+	UStrategyMassSubsystem* MassUnits = World ? World->GetSubsystem<UStrategyMassSubsystem>() : nullptr;
+
+	// the backend is off, or there's no camera to represent units around
+	if (!MassUnits || !MassUnits->GetDespawnBounds().bIsValid)
+	{
+		return;
+	}
+
+	UStrategyUnitRegistry* Registry = World->GetSubsystem<UStrategyUnitRegistry>();
+	const TSubclassOf<AStrategyUnit> UnitClass = MassUnits->GetUnitClass();
+	const FBox2D& SpawnBounds = MassUnits->GetSpawnBounds();
+	const FBox2D& DespawnBounds = MassUnits->GetDespawnBounds();
+	const float WanderRadius = UStrategyMassSubsystem::GetWanderRadius();
+	const float AcceptanceRadius = UStrategyMassSubsystem::GetAcceptanceRadius();
+
+	// spread the spawn cost of a camera jump over several frames
+	int32 SpawnBudget = UStrategyMassSubsystem::GetMaxSpawnsPerFrame();
+
+	const float SpawnHalfHeight = UnitClass ? UnitClass->GetDefaultObject<AStrategyUnit>()->GetSimpleCollisionHalfHeight() : 0.0f;
+
+	EntityQuery.ForEachEntityChunk(Context, [&](FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FStrategyMassUnitFragment> Units = ChunkContext.GetMutableFragmentView<FStrategyMassUnitFragment>();
+		const TArrayView<FStrategyMassActorFragment> Actors = ChunkContext.GetMutableFragmentView<FStrategyMassActorFragment>();
+
+		for (int32 EntityIndex = 0; EntityIndex < ChunkContext.GetNumEntities(); ++EntityIndex)
+		{
+			FStrategyMassUnitFragment& Unit = Units[EntityIndex];
+			FStrategyMassActorFragment& Representation = Actors[EntityIndex];
+
+			if (AStrategyUnit* Actor = Representation.Actor.Get())
+			{
+				// the actor owns the unit's state while it exists
+				Unit.Location = Actor->GetActorLocation() - FVector(0.0f, 0.0f, Actor->GetSimpleCollisionHalfHeight());
+
+				// units the player has selected or is looking at keep their actor
+				if (DespawnBounds.IsInside(FVector2D(Unit.Location)) || (Registry && Registry->IsSelected(Actor)))
+				{
+					// keep unordered units wandering so the stress scenario stays busy on screen too
+					if (WanderRadius > 0.0f && Actor->GetMoveOrderId() == 0 && !Actor->IsMoving())
+					{
+						Unit.PickWanderDestination(WanderRadius);
+						Actor->MoveToLocationAsync(Unit.Destination, AcceptanceRadius);
+					}
+
+					continue;
+				}
+
+				// hand the move back to Mass and drop the actor
+				Unit.bMoving = Actor->IsMoving();
+				Unit.Destination = Actor->GetMoveDestination();
+
+				Actor->Destroy();
+				Representation.Actor.Reset();
+				MassUnits->NotifyActorRemoved();
+
+				ChunkContext.Defer().AddTag<FStrategyMassSimulatedTag>(ChunkContext.GetEntity(EntityIndex));
+			}
+			else if (!Representation.Actor.IsExplicitlyNull())
+			{
+				// the actor was destroyed by gameplay, so the unit is gone
+				Representation.Actor.Reset();
+				MassUnits->NotifyActorRemoved();
+				MassUnits->NotifyUnitDestroyed();
+
+				ChunkContext.Defer().DestroyEntity(ChunkContext.GetEntity(EntityIndex));
+			}
+			else if (SpawnBudget > 0 && UnitClass && SpawnBounds.IsInside(FVector2D(Unit.Location)))
+			{
+				// the unit came into view, give it an actor
+				FActorSpawnParameters SpawnParams;
+				SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+				const FRotator Facing = Unit.bMoving ? (Unit.Destination - Unit.Location).GetSafeNormal2D().Rotation() : FRotator::ZeroRotator;
+
+				AStrategyUnit* Actor = World->SpawnActor<AStrategyUnit>(UnitClass, Unit.Location + FVector(0.0f, 0.0f, SpawnHalfHeight), Facing, SpawnParams);
+
+				--SpawnBudget;
+
+				if (!Actor)
+				{
+					continue;
+				}
+
+				// pick up the move where Mass left it
+				if (Unit.bMoving)
+				{
+					Actor->MoveToLocationAsync(Unit.Destination, AcceptanceRadius);
+				}
+
+				Representation.Actor = Actor;
+				MassUnits->NotifyActorSpawned();
+
+				ChunkContext.Defer().RemoveTag<FStrategyMassSimulatedTag>(ChunkContext.GetEntity(EntityIndex));
+			}
+		}
+	});
+}
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "StrategyMassProcessors.generated.h"
+
+/**
+ *  Cheap movement for strategy units that have no actor
+ *  Moves each unit in a straight line towards its destination with no pathfinding, collision or
+ *  avoidance. Runs on worker threads over whole chunks at a time.
+ */
+UCLASS()
+class UStrategyMassMoveProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Units without an actor */
+	FMassEntityQuery EntityQuery;
+
+public:
+
+	/** Constructor */
+	UStrategyMassMoveProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
+
+/**
+ *  Switches strategy units between their Mass and actor representations
+ *  Units entering the area around the camera get an actor spawned, which takes over movement.
+ *  Units leaving it hand their state back to Mass and lose their actor, unless they're selected.
+ *  Runs on the game thread after physics so it sees this frame's actor locations.
+ */
+UCLASS()
+class UStrategyMassRepresentationProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Every strategy Mass unit */
+	FMassEntityQuery EntityQuery;
+
+public:
+
+	/** Constructor */
+	UStrategyMassRepresentationProcessor();
+
+protected:
+
+	virtual void ConfigureQueries(const TSharedRef<FMassEntityManager>& EntityManager) override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
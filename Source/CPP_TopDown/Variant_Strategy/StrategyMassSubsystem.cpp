@@ -0,0 +1,361 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyMassSubsystem.h"
+#include "StrategyMassTypes.h"
+#include "StrategyPawn.h"
+#include "StrategyUnit.h"
+#include "MassEntityManager.h"
+#include "MassEntityUtils.h"
+#include "NavigationSystem.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "RenderCore.h"
+
+namespace StrategyMass
+{
+	static float SpawnMargin = 300.0f;
+	static FAutoConsoleVariableRef CVarSpawnMargin(
+		TEXT("ai.StrategyMass.SpawnMargin"),
+		SpawnMargin,
+		TEXT("Distance outside the visible area within which Mass units get an actor"));
+
+	static float DespawnMargin = 800.0f;
+	static FAutoConsoleVariableRef CVarDespawnMargin(
+		TEXT("ai.StrategyMass.DespawnMargin"),
+		DespawnMargin,
+		TEXT("Distance outside the visible area beyond which Mass units lose their actor. Keep it above ai.StrategyMass.SpawnMargin"));
+
+	static int32 MaxSpawnsPerFrame = 32;
+	static FAutoConsoleVariableRef CVarMaxSpawnsPerFrame(
+		TEXT("ai.StrategyMass.MaxSpawnsPerFrame"),
+		MaxSpawnsPerFrame,
+		TEXT("Upper bound on unit actors spawned per frame; the rest wait for the next frames"));
+
+	static float WanderRadius = 1500.0f;
+	static FAutoConsoleVariableRef CVarWanderRadius(
+		TEXT("ai.StrategyMass.WanderRadius"),
+		WanderRadius,
+		TEXT("Radius idle Mass units wander around their spawn point in, 0 to keep them still"));
+
+	static float AcceptanceRadius = 50.0f;
+	static FAutoConsoleVariableRef CVarAcceptanceRadius(
+		TEXT("ai.StrategyMass.AcceptanceRadius"),
+		AcceptanceRadius,
+		TEXT("Acceptance radius of moves handed over from Mass to a unit actor"));
+
+	/** Seconds of game thread time averaged per headroom step */
+	static constexpr double HeadroomSampleSeconds = 2.0;
+
+	/** Radius units added by the headroom ramp are spread over */
+	static constexpr float HeadroomSpawnRadius = 20000.0f;
+
+	static FAutoConsoleCommandWithWorldAndArgs SpawnCommand(
+		TEXT("ai.StrategyMass.Spawn"),
+		TEXT("Usage: ai.StrategyMass.Spawn <Count> [Radius]. Spawns Mass strategy units around the camera. Requires -StrategyMass."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UStrategyMassSubsystem* MassUnits = World ? World->GetSubsystem<UStrategyMassSubsystem>() : nullptr;
+
+			if (!MassUnits || Args.Num() < 1)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[StrategyMass] usage: ai.StrategyMass.Spawn <Count> [Radius], with the game started with -StrategyMass"));
+				return;
+			}
+
+			const int32 Count = FMath::Max(FCString::Atoi(*Args[0]), 1);
+			const float Radius = Args.Num() > 1 ? FCString::Atof(*Args[1]) : HeadroomSpawnRadius;
+
+			MassUnits->SpawnUnits(Count, MassUnits->GetViewCenter(), Radius);
+			MassUnits->LogStats();
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs HeadroomCommand(
+		TEXT("ai.StrategyMass.Headroom"),
+		TEXT("Usage: ai.StrategyMass.Headroom [BudgetMs] [Step]. Adds Step Mass units (default 1000) every couple of seconds until the average game thread time exceeds BudgetMs (default 16.6), then logs how many fit. Requires -StrategyMass."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UStrategyMassSubsystem* MassUnits = World ? World->GetSubsystem<UStrategyMassSubsystem>() : nullptr;
+
+			if (!MassUnits)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[StrategyMass] start the game with -StrategyMass to use the Mass backend"));
+				return;
+			}
+
+			const float BudgetMs = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 16.6f;
+			const int32 Step = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000;
+
+			MassUnits->StartHeadroomRamp(BudgetMs, Step);
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("ai.StrategyMass.Stats"),
+		TEXT("Logs the number of Mass strategy units and how many are represented by actors."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UStrategyMassSubsystem* MassUnits = World ? World->GetSubsystem<UStrategyMassSubsystem>() : nullptr)
+			{
+				MassUnits->LogStats();
+			}
+		}));
+}
+
+bool UStrategyMassSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("StrategyMass")) && Super::ShouldCreateSubsystem(Outer);
+}
+
+bool UStrategyMassSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyMassSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(InWorld);
+
+	// units start out without an actor; the representation processor spawns them near the camera
+	const UScriptStruct* Composition[] = {
+		FStrategyMassUnitFragment::StaticStruct(),
+		FStrategyMassActorFragment::StaticStruct(),
+		FStrategyMassSimulatedTag::StaticStruct()
+	};
+
+	UnitArchetype = EntityManager.CreateArchetype(Composition);
+
+	int32 NumUnits = 0;
+	float Radius = StrategyMass::HeadroomSpawnRadius;
+	ParseCommandLine(NumUnits, Radius);
+
+	if (NumUnits > 0)
+	{
+		SpawnUnits(NumUnits, FVector::ZeroVector, Radius);
+		LogStats();
+	}
+}
+
+void UStrategyMassSubsystem::Deinitialize()
+{
+	// the entity manager goes away with the world, taking the entities with it
+	Entities.Empty();
+	UnitClass = nullptr;
+	NumRepresented = 0;
+	bHeadroomRunning = false;
+
+	Super::Deinitialize();
+}
+
+TStatId UStrategyMassSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyMassSubsystem, STATGROUP_Tickables);
+}
+
+int32 UStrategyMassSubsystem::GetMaxSpawnsPerFrame()
+{
+	return FMath::Max(StrategyMass::MaxSpawnsPerFrame, 0);
+}
+
+float UStrategyMassSubsystem::GetWanderRadius()
+{
+	return FMath::Max(StrategyMass::WanderRadius, 0.0f);
+}
+
+float UStrategyMassSubsystem::GetAcceptanceRadius()
+{
+	return StrategyMass::AcceptanceRadius;
+}
+
+void UStrategyMassSubsystem::ParseCommandLine(int32& OutNumUnits, float& OutRadius)
+{
+	const TCHAR* CmdLine = FCommandLine::Get();
+
+	FParse::Value(CmdLine, TEXT("StrategyMassUnits="), OutNumUnits);
+	FParse::Value(CmdLine, TEXT("StrategyMassRadius="), OutRadius);
+
+	FString UnitClassPath;
+	if (FParse::Value(CmdLine, TEXT("StrategyMassUnitClass="), UnitClassPath))
+	{
+		UnitClass = LoadClass<AStrategyUnit>(nullptr, *UnitClassPath);
+
+		if (!UnitClass)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[StrategyMass] couldn't load unit class '%s', using the class of the first unit in the level"), *UnitClassPath);
+		}
+	}
+}
+
+void UStrategyMassSubsystem::ResolveUnitClass()
+{
+	// AStrategyUnit is abstract, so borrow the Blueprint class of a unit placed in the level
+	for (TActorIterator<AStrategyUnit> It(GetWorld()); It; ++It)
+	{
+		UnitClass = It->GetClass();
+		return;
+	}
+}
+
+void UStrategyMassSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!UnitClass && Entities.Num() > 0)
+	{
+		ResolveUnitClass();
+	}
+
+	UpdateViewBounds();
+
+	if (bHeadroomRunning)
+	{
+		UpdateHeadroomRamp();
+	}
+}
+
+FVector UStrategyMassSubsystem::GetViewCenter() const
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	const AStrategyPawn* Pawn = PC ? Cast<AStrategyPawn>(PC->GetPawn()) : nullptr;
+
+	return Pawn ? Pawn->GetActorLocation() : FVector::ZeroVector;
+}
+
+void UStrategyMassSubsystem::UpdateViewBounds()
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	const AStrategyPawn* Pawn = PC ? Cast<AStrategyPawn>(PC->GetPawn()) : nullptr;
+
+	// no camera to represent units around
+	if (!Pawn)
+	{
+		SpawnBounds.Init();
+		DespawnBounds.Init();
+		return;
+	}
+
+	FBox2D ViewBounds;
+	Pawn->GetVisibleGroundBounds(0.0f, ViewBounds);
+
+	// despawn further out than we spawn so units on the edge don't swap back and forth every frame
+	SpawnBounds = ViewBounds.ExpandBy(StrategyMass::SpawnMargin);
+	DespawnBounds = ViewBounds.ExpandBy(FMath::Max(StrategyMass::DespawnMargin, StrategyMass::SpawnMargin));
+}
+
+void UStrategyMassSubsystem::SpawnUnits(int32 Count, const FVector& Center, float Radius)
+{
+	if (Count <= 0 || !UnitArchetype.IsValid())
+	{
+		return;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*GetWorld());
+
+	const double Start = FPlatformTime::Seconds();
+
+	TArray<FMassEntityHandle> NewEntities;
+	TSharedRef<FMassEntityManager::FEntityCreationContext> CreationContext = EntityManager.BatchCreateEntities(UnitArchetype, Count, NewEntities);
+
+	for (const FMassEntityHandle& Entity : NewEntities)
+	{
+		FStrategyMassUnitFragment& Unit = EntityManager.GetFragmentDataChecked<FStrategyMassUnitFragment>(Entity);
+
+		// start on the navmesh if there is one, otherwise anywhere on the disc
+		FNavLocation NavLocation;
+		if (NavSys && NavSys->GetRandomPointInNavigableRadius(Center, Radius, NavLocation))
+		{
+			Unit.Location = NavLocation.Location;
+		}
+		else
+		{
+			const FVector2D Offset = FMath::RandPointInCircle(Radius);
+			Unit.Location = Center + FVector(Offset, 0.0f);
+		}
+
+		Unit.Home = Unit.Location;
+		Unit.Destination = Unit.Location;
+		Unit.WanderSeed = Entity.Index;
+	}
+
+	Entities.Append(NewEntities);
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyMass] spawned %d units in %.2f ms"), Count, (FPlatformTime::Seconds() - Start) * 1000.0);
+}
+
+void UStrategyMassSubsystem::StartHeadroomRamp(float BudgetMs, int32 Step)
+{
+	bHeadroomRunning = true;
+	HeadroomBudgetMs = FMath::Max(BudgetMs, 1.0f);
+	HeadroomStep = FMath::Max(Step, 1);
+	HeadroomGameThreadMs = 0.0;
+	HeadroomFrames = 0;
+	HeadroomSampleStart = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyMass] headroom ramp: +%d units every %.0f s until the game thread averages over %.1f ms"),
+		HeadroomStep, StrategyMass::HeadroomSampleSeconds, HeadroomBudgetMs);
+}
+
+void UStrategyMassSubsystem::UpdateHeadroomRamp()
+{
+	HeadroomGameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+	++HeadroomFrames;
+
+	if (FPlatformTime::Seconds() - HeadroomSampleStart < StrategyMass::HeadroomSampleSeconds)
+	{
+		return;
+	}
+
+	const double AverageMs = HeadroomGameThreadMs / FMath::Max(HeadroomFrames, 1);
+
+	PruneDestroyedEntities();
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyMass] %d units (%d actors): %.2f ms game thread"), Entities.Num(), NumRepresented, AverageMs);
+
+	if (AverageMs > HeadroomBudgetMs)
+	{
+		// the last step pushed us over, so the step before is what fits
+		UE_LOG(LogTemp, Display, TEXT("[StrategyMass] headroom: about %d units fit in %.1f ms"), FMath::Max(Entities.Num() - HeadroomStep, 0), HeadroomBudgetMs);
+		bHeadroomRunning = false;
+		return;
+	}
+
+	SpawnUnits(HeadroomStep, GetViewCenter(), StrategyMass::HeadroomSpawnRadius);
+
+	HeadroomGameThreadMs = 0.0;
+	HeadroomFrames = 0;
+	HeadroomSampleStart = FPlatformTime::Seconds();
+}
+
+void UStrategyMassSubsystem::LogStats()
+{
+	PruneDestroyedEntities();
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyMass] %d units, %d represented by actors, actor class %s"),
+		Entities.Num(), NumRepresented, UnitClass ? *UnitClass->GetName() : TEXT("<none yet>"));
+}
+
+int32 UStrategyMassSubsystem::GetNumUnits()
+{
+	PruneDestroyedEntities();
+
+	return Entities.Num();
+}
+
+void UStrategyMassSubsystem::PruneDestroyedEntities()
+{
+	if (!bEntitiesDirty)
+	{
+		return;
+	}
+
+	bEntitiesDirty = false;
+
+	// units destroyed by gameplay are removed through deferred commands, so their handles go stale here
+	const FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(*GetWorld());
+	Entities.RemoveAllSwap([&EntityManager](const FMassEntityHandle& Entity) { return !EntityManager.IsEntityValid(Entity); });
+}
@@ -0,0 +1,133 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MassEntityTypes.h"
+#include "MassArchetypeTypes.h"
+#include "StrategyMassSubsystem.generated.h"
+
+class AStrategyUnit;
+
+/**
+ *  Optional Mass backend for strategy units. Only created when the game is started with -StrategyMass, e.g.
+ *
+ *   UnrealEditor CPP_TopDown <StrategyMap> -game -StrategyMass [-StrategyMassUnits=20000] [-StrategyMassRadius=20000]
+ *       [-StrategyMassUnitClass=/Game/.../BP_StrategyUnit.BP_StrategyUnit_C]
+ *
+ *  Every unit it spawns is a Mass entity. Entities near the camera are represented by a regular
+ *  AStrategyUnit actor, which does the pathfinding, collision and interactions and can be selected
+ *  and ordered around by the player controller like any placed unit. Everywhere else a cheap
+ *  straight-line movement processor stands in for the character. Selected units keep their actor
+ *  wherever they go, so selection and move orders never lose track of them.
+ *
+ *  Console:
+ *   ai.StrategyMass.Spawn <Count> [Radius]			spawns more units around the camera
+ *   ai.StrategyMass.Headroom [BudgetMs] [Step]		keeps adding units until the game thread exceeds the budget
+ *   ai.StrategyMass.Stats							logs unit and actor counts
+ */
+UCLASS()
+class UStrategyMassSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Archetype shared by every strategy unit entity */
+	FMassArchetypeHandle UnitArchetype;
+
+	/** Every entity spawned by this subsystem. May hold destroyed entities until the next prune */
+	TArray<FMassEntityHandle> Entities;
+
+	/** Set when a unit entity was destroyed, so Entities needs pruning before it's counted */
+	bool bEntitiesDirty = false;
+
+	/** Actor class spawned to represent units near the camera */
+	UPROPERTY()
+	TSubclassOf<AStrategyUnit> UnitClass;
+
+	/** Number of units currently represented by an actor */
+	int32 NumRepresented = 0;
+
+	/** Area around the camera where units get an actor */
+	FBox2D SpawnBounds { ForceInit };
+
+	/** Area around the camera outside of which units lose their actor. Larger than the spawn bounds so units don't flicker at the edge */
+	FBox2D DespawnBounds { ForceInit };
+
+	/** Headroom ramp state */
+	bool bHeadroomRunning = false;
+	float HeadroomBudgetMs = 16.6f;
+	int32 HeadroomStep = 1000;
+	double HeadroomGameThreadMs = 0.0;
+	int32 HeadroomFrames = 0;
+	double HeadroomSampleStart = 0.0;
+
+public:
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 *  Spawns unit entities at random navigable locations
+	 *  @param Count		number of units to spawn
+	 *  @param Center		center of the spawn area
+	 *  @param Radius		radius of the spawn area
+	 */
+	void SpawnUnits(int32 Count, const FVector& Center, float Radius);
+
+	/** Starts adding units until the average game thread time exceeds the budget */
+	void StartHeadroomRamp(float BudgetMs, int32 Step);
+
+	/** Logs unit and actor counts */
+	void LogStats();
+
+	/** Returns the location under the local player's camera */
+	FVector GetViewCenter() const;
+
+	/** Returns the number of live unit entities */
+	int32 GetNumUnits();
+
+	/** Returns the actor class used to represent units, null until one is known */
+	TSubclassOf<AStrategyUnit> GetUnitClass() const { return UnitClass; }
+
+	const FBox2D& GetSpawnBounds() const { return SpawnBounds; }
+	const FBox2D& GetDespawnBounds() const { return DespawnBounds; }
+
+	/** Representation bookkeeping, called by the representation processor */
+	void NotifyActorSpawned() { ++NumRepresented; }
+	void NotifyActorRemoved() { --NumRepresented; }
+	void NotifyUnitDestroyed() { bEntitiesDirty = true; }
+
+	/** Maximum number of actors to spawn per frame */
+	static int32 GetMaxSpawnsPerFrame();
+
+	/** Radius idle units wander around their home in, 0 to keep them idle */
+	static float GetWanderRadius();
+
+	/** Acceptance radius for moves handed over to actors */
+	static float GetAcceptanceRadius();
+
+protected:
+
+	/** Reads the unit count and actor class from the command line */
+	void ParseCommandLine(int32& OutNumUnits, float& OutRadius);
+
+	/** Drops the handles of entities destroyed since the last prune */
+	void PruneDestroyedEntities();
+
+	/** Finds an actor class for the representation if none was given */
+	void ResolveUnitClass();
+
+	/** Recomputes the representation bounds from the local player's camera */
+	void UpdateViewBounds();
+
+	/** Samples the game thread time and grows the unit count while it's under budget */
+	void UpdateHeadroomRamp();
+};
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "StrategyMassTypes.generated.h"
+
+class AStrategyUnit;
+
+/**
+ *  Simulation state of a strategy unit living in Mass
+ *  This is the unit's ground truth while it has no actor. While an actor represents it,
+ *  the location is copied back from the actor every frame so it can be dropped at any time.
+ */
+USTRUCT()
+struct FStrategyMassUnitFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Current location, at the unit's feet */
+	FVector Location = FVector::ZeroVector;
+
+	/** Location the unit is heading to */
+	FVector Destination = FVector::ZeroVector;
+
+	/** Location the unit wanders around when idle */
+	FVector Home = FVector::ZeroVector;
+
+	/** Movement speed while simulated without an actor */
+	float Speed = 500.0f;
+
+	/** Seed for this unit's wander targets */
+	uint32 WanderSeed = 0;
+
+	/** True while the unit is heading to its destination */
+	bool bMoving = false;
+
+	/** Picks a random destination within the radius around home and starts moving. Deterministic per unit */
+	void PickWanderDestination(float Radius)
+	{
+		const FRandomStream Stream(WanderSeed++);
+		const float Angle = Stream.FRandRange(0.0f, UE_TWO_PI);
+		const float Distance = Radius * FMath::Sqrt(Stream.FRand());
+
+		Destination = Home + FVector(FMath::Cos(Angle) * Distance, FMath::Sin(Angle) * Distance, 0.0f);
+		bMoving = true;
+	}
+};
+
+/**
+ *  Actor currently representing the unit, if any
+ */
+USTRUCT()
+struct FStrategyMassActorFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Spawned unit actor, null while the unit is simulated in Mass only */
+	TWeakObjectPtr<AStrategyUnit> Actor;
+};
+
+/**
+ *  Marks units simulated by the cheap Mass movement processor rather than by an actor
+ */
+USTRUCT()
+struct FStrategyMassSimulatedTag : public FMassTag
+{
+	GENERATED_BODY()
+};
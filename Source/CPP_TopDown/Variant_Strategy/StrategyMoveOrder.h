@@ -0,0 +1,84 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AStrategyUnit;
+struct FStrategyMoveOrder;
+
+/** Delegate to report that a unit taking part in a move order has finished moving */
+DECLARE_DELEGATE_TwoParams(FOnStrategyOrderUnitArrivedDelegate, FStrategyMoveOrder& /* Order */, AStrategyUnit* /* Unit */);
+
+/** Delegate to report that every unit of a move order has arrived or left it */
+DECLARE_DELEGATE_OneParam(FOnStrategyOrderCompletedDelegate, FStrategyMoveOrder& /* Order */);
+
+/**
+ *  A single move order given to a group of units
+ *  Every unit in the group holds a reference to the order and reports back to it once when its
+ *  move ends, so the issuer binds one delegate per order instead of one per unit. The order id
+ *  doubles as a group id that identifies the order's units in queries. Arrivals are counted, and
+ *  the order completes once the last unit has arrived or been taken off it.
+ */
+struct FStrategyMoveOrder
+{
+	/** Unique id of this order, never 0 */
+	uint32 OrderId = 0;
+
+	/** Location the order was given at */
+	FVector Goal = FVector::ZeroVector;
+
+	/** Number of units still taking part in the order */
+	int32 NumUnits = 0;
+
+	/** Number of units that have finished moving */
+	int32 NumArrived = 0;
+
+	/** Set once the order's interaction query has run */
+	bool bInteractionHandled = false;
+
+	/** Arrived unit that ended up closest to the goal, in case none made it into interaction range */
+	TWeakObjectPtr<AStrategyUnit> ClosestUnit;
+	float ClosestDistanceSquared = MAX_flt;
+
+	/** Called every time a unit of this order finishes moving */
+	FOnStrategyOrderUnitArrivedDelegate OnUnitArrived;
+
+	/** Called once, when the last unit has arrived or left the order */
+	FOnStrategyOrderCompletedDelegate OnCompleted;
+
+	/** Returns true once every unit has finished moving */
+	bool IsComplete() const { return NumArrived >= NumUnits; }
+
+	/** Counts a unit taking part in the order */
+	void AddUnit() { ++NumUnits; }
+
+	/** Counts a unit's arrival and notifies the issuer */
+	void NotifyUnitArrived(AStrategyUnit* Unit)
+	{
+		++NumArrived;
+		OnUnitArrived.ExecuteIfBound(*this, Unit);
+		CompleteIfDone();
+	}
+
+	/** A unit left the order without arriving, e.g. because it was given a new one */
+	void NotifyUnitDropped()
+	{
+		--NumUnits;
+		CompleteIfDone();
+	}
+
+private:
+
+	void CompleteIfDone()
+	{
+		if (IsComplete() && OnCompleted.IsBound())
+		{
+			// unbind first so the order ends exactly once
+			FOnStrategyOrderCompletedDelegate Completed = MoveTemp(OnCompleted);
+			OnUnitArrived.Unbind();
+
+			Completed.Execute(*this);
+		}
+	}
+};
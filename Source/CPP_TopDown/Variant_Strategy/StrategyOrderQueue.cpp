@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyOrderQueue.h"
+
+void FStrategyOrderQueue::Push(const FStrategyOrder& Order)
+{
+	++NumPushed;
+
+	switch (Order.Type)
+	{
+	case EStrategyOrderType::DragScroll:
+		// scroll offsets are additive, so one scroll per frame carries the whole drag
+		if (const int32 Index = FindPending(EStrategyOrderType::DragScroll); Index != INDEX_NONE)
+		{
+			Pending[Index].Location += Order.Location;
+			++NumCoalesced;
+			return;
+		}
+		break;
+
+	case EStrategyOrderType::DragSelect:
+		// the latest box replaces the previous one in place
+		if (const int32 Index = FindPending(EStrategyOrderType::DragSelect); Index != INDEX_NONE)
+		{
+			Pending[Index] = Order;
+			++NumCoalesced;
+			return;
+		}
+		break;
+
+	case EStrategyOrderType::MoveUnits:
+		// only the last move of the frame counts. Drop the earlier one so the move still runs after any selection given before it
+		if (const int32 Index = FindPending(EStrategyOrderType::MoveUnits); Index != INDEX_NONE)
+		{
+			Pending.RemoveAt(Index);
+			++NumCoalesced;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	Pending.Add(Order);
+}
+
+void FStrategyOrderQueue::Flush(TArray<FStrategyOrder>& OutOrders)
+{
+	OutOrders.Append(Pending);
+	Pending.Reset();
+}
+
+int32 FStrategyOrderQueue::FindPending(EStrategyOrderType Type) const
+{
+	return Pending.IndexOfByPredicate([Type](const FStrategyOrder& Other) { return Other.Type == Type; });
+}
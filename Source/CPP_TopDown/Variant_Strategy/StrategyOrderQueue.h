@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Kinds of player commands the strategy controller queues up */
+enum class EStrategyOrderType : uint8
+{
+	/** Select or deselect the unit at Location */
+	Select,
+
+	/** Touch double tap: select everything on screen, or deselect all with the modifier held */
+	DoubleTap,
+
+	/** Replace the selection with the units inside Footprint */
+	DragSelect,
+
+	/** Offset the camera by Location (world space, XY) */
+	DragScroll,
+
+	/** Move the selected units to Location */
+	MoveUnits
+};
+
+/**
+ *  A single player command, recorded when the input arrives and executed with the frame's batch
+ *  Only holds what the command needs to run, so it doesn't depend on cursor or touch state at execution time
+ *  and can be serialized as is.
+ */
+struct FStrategyOrder
+{
+	/** What to do */
+	EStrategyOrderType Type = EStrategyOrderType::Select;
+
+	/** Selection modifier was held when the order was given */
+	bool bModifier = false;
+
+	/** Target world location, or world offset for drag scrolls */
+	FVector Location = FVector::ZeroVector;
+
+	/** Ground footprint of the selection box, for drag selects */
+	FVector2D Footprint[4];
+
+	friend FArchive& operator<<(FArchive& Ar, FStrategyOrder& Order)
+	{
+		Ar << Order.Type << Order.bModifier;
+
+		// only write the payload the order type actually uses
+		switch (Order.Type)
+		{
+		case EStrategyOrderType::Select:
+		case EStrategyOrderType::DragScroll:
+		case EStrategyOrderType::MoveUnits:
+			Ar << Order.Location;
+			break;
+
+		case EStrategyOrderType::DragSelect:
+			for (FVector2D& Corner : Order.Footprint)
+			{
+				Ar << Corner;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return Ar;
+	}
+};
+
+/**
+ *  Collects the orders given during a frame so the controller can execute them as one batch
+ *  Orders are coalesced as they come in: drag scroll offsets add up into a single scroll, and only the
+ *  latest drag select and move order of the frame are kept.
+ */
+class FStrategyOrderQueue
+{
+public:
+
+	/** Adds an order to this frame's batch, merging it with a pending order where possible */
+	void Push(const FStrategyOrder& Order);
+
+	/** Moves the pending orders into OutOrders and empties the queue */
+	void Flush(TArray<FStrategyOrder>& OutOrders);
+
+	/** Number of orders waiting for the next flush */
+	int32 Num() const { return Pending.Num(); }
+
+	/** Total orders pushed since the queue was created */
+	int32 GetNumPushed() const { return NumPushed; }
+
+	/** Total orders merged into, or replaced by, another pending order */
+	int32 GetNumCoalesced() const { return NumCoalesced; }
+
+protected:
+
+	/** Returns the index of the pending order of the given type, or INDEX_NONE */
+	int32 FindPending(EStrategyOrderType Type) const;
+
+	/** Orders given since the last flush */
+	TArray<FStrategyOrder> Pending;
+
+	int32 NumPushed = 0;
+	int32 NumCoalesced = 0;
+};
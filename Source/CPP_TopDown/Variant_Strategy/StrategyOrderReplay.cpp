@@ -0,0 +1,257 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyOrderReplay.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+
+namespace StrategyOrderReplay
+{
+	static constexpr uint32 FileMagic = 0x57444F52; // "WDOR"
+	static constexpr int32 FileVersion = 2;
+
+	static UStrategyOrderReplaySubsystem* Get(UWorld* World)
+	{
+		return World ? World->GetSubsystem<UStrategyOrderReplaySubsystem>() : nullptr;
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs RecordCommand(
+		TEXT("replay.Orders.Record"),
+		TEXT("Starts recording strategy orders. Args: [FPS=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UStrategyOrderReplaySubsystem* Replay = Get(World))
+			{
+				Replay->StartRecording(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 60.0f);
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StopCommand(
+		TEXT("replay.Orders.Stop"),
+		TEXT("Stops recording (saving to Saved/StrategyOrders/<Name>.orders) or playback. Args: [Name=Last]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UStrategyOrderReplaySubsystem* Replay = Get(World))
+			{
+				if (Replay->IsRecording())
+				{
+					Replay->StopRecording(Args.Num() > 0 ? Args[0] : TEXT("Last"));
+				}
+				else
+				{
+					Replay->StopPlayback();
+				}
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs PlayCommand(
+		TEXT("replay.Orders.Play"),
+		TEXT("Plays back a recording from Saved/StrategyOrders. Args: [Name=Last]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UStrategyOrderReplaySubsystem* Replay = Get(World))
+			{
+				Replay->StartPlayback(Args.Num() > 0 ? Args[0] : TEXT("Last"));
+			}
+		}));
+}
+
+bool UStrategyOrderReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyOrderReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	const TCHAR* CmdLine = FCommandLine::Get();
+
+	FString Name;
+	if (FParse::Value(CmdLine, TEXT("StrategyOrderReplay="), Name))
+	{
+		bExitAfterPlayback = FParse::Param(CmdLine, TEXT("ReplayExit"));
+		StartPlayback(Name);
+	}
+	else if (FParse::Value(CmdLine, TEXT("StrategyOrderRecord="), AutoRecordName))
+	{
+		float FPS = 60.0f;
+		FParse::Value(CmdLine, TEXT("ReplayFPS="), FPS);
+		StartRecording(FPS);
+	}
+}
+
+void UStrategyOrderReplaySubsystem::Deinitialize()
+{
+	if (bRecording && !AutoRecordName.IsEmpty())
+	{
+		StopRecording(AutoRecordName);
+	}
+
+	EndSession();
+	Orders.Empty();
+
+	Super::Deinitialize();
+}
+
+TStatId UStrategyOrderReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyOrderReplaySubsystem, STATGROUP_Tickables);
+}
+
+FString UStrategyOrderReplaySubsystem::GetReplayPath(const FString& Name)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("StrategyOrders"), Name + TEXT(".orders"));
+}
+
+bool UStrategyOrderReplaySubsystem::BeginSession(int32 Seed, float FPS)
+{
+	if (!Session.Begin(Seed, FPS))
+	{
+		return false;
+	}
+
+	SessionFrame = 0;
+	PlaybackCursor = 0;
+	return true;
+}
+
+void UStrategyOrderReplaySubsystem::EndSession()
+{
+	if (!bRecording && !bPlayingBack)
+	{
+		return;
+	}
+
+	bRecording = false;
+	bPlayingBack = false;
+
+	Session.End();
+}
+
+bool UStrategyOrderReplaySubsystem::StartRecording(float FPS)
+{
+	EndSession();
+
+	if (!BeginSession(0, FPS))
+	{
+		return false;
+	}
+
+	Orders.Reset();
+	bRecording = true;
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyOrders] recording at %.0f fps"), Session.GetFPS());
+	return true;
+}
+
+bool UStrategyOrderReplaySubsystem::StopRecording(const FString& Name)
+{
+	if (!bRecording)
+	{
+		return false;
+	}
+
+	FReplayFileHeader Header;
+	Header.Magic = StrategyOrderReplay::FileMagic;
+	Header.Version = StrategyOrderReplay::FileVersion;
+	Header.Seed = Session.GetSeed();
+	Header.FPS = Session.GetFPS();
+	Header.Frames = SessionFrame;
+
+	EndSession();
+
+	const FString Path = GetReplayPath(Name);
+	const int32 Bytes = Session.Save(Path, Header, [this](FArchive& Ar) { Ar << Orders; });
+	if (Bytes == INDEX_NONE)
+	{
+		return false;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyOrders] saved %d orders over %d frames to %s (%d bytes)"), Orders.Num(), Header.Frames, *Path, Bytes);
+	return true;
+}
+
+bool UStrategyOrderReplaySubsystem::StartPlayback(const FString& Name)
+{
+	EndSession();
+
+	const FString Path = GetReplayPath(Name);
+
+	FReplayFileHeader Header;
+	if (!Session.Load(Path, StrategyOrderReplay::FileMagic, StrategyOrderReplay::FileVersion, Header, [this](FArchive& Ar) { Ar << Orders; })
+		|| !BeginSession(Header.Seed, Header.FPS))
+	{
+		Orders.Reset();
+		return false;
+	}
+
+	PlaybackFrames = Header.Frames;
+	PlaybackStartTime = FPlatformTime::Seconds();
+	bPlayingBack = true;
+
+	UE_LOG(LogTemp, Display, TEXT("[StrategyOrders] playing %d orders over %d frames from %s (%.0f fps)"), Orders.Num(), Header.Frames, *Path, Session.GetFPS());
+	return true;
+}
+
+void UStrategyOrderReplaySubsystem::StopPlayback()
+{
+	if (!bPlayingBack)
+	{
+		return;
+	}
+
+	EndSession();
+
+	// wall clock over the fixed step frames is the number to compare between builds
+	const double Elapsed = FPlatformTime::Seconds() - PlaybackStartTime;
+	UE_LOG(LogTemp, Display, TEXT("[StrategyOrders] playback finished: %d frames, %d orders in %.2fs (%.2f ms/frame)"),
+		SessionFrame, PlaybackCursor, Elapsed, SessionFrame > 0 ? Elapsed * 1000.0 / SessionFrame : 0.0);
+
+	if (bExitAfterPlayback)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UStrategyOrderReplaySubsystem::ProcessBatch(TArray<FStrategyOrder>& Batch)
+{
+	if (bRecording)
+	{
+		for (const FStrategyOrder& Order : Batch)
+		{
+			FRecordedStrategyOrder& Recorded = Orders.AddDefaulted_GetRef();
+			Recorded.Frame = SessionFrame;
+			Recorded.Order = Order;
+		}
+	}
+	else if (bPlayingBack)
+	{
+		// live orders are dropped, the recording drives the controller
+		Batch.Reset();
+
+		while (PlaybackCursor < Orders.Num() && Orders[PlaybackCursor].Frame <= SessionFrame)
+		{
+			Batch.Add(Orders[PlaybackCursor++].Order);
+		}
+	}
+}
+
+void UStrategyOrderReplaySubsystem::Tick(float DeltaTime)
+{
+	if (!bRecording && !bPlayingBack)
+	{
+		return;
+	}
+
+	// tickables run after the actors, so this is the boundary between frame N and N+1
+	++SessionFrame;
+
+	// keep running until the recorded session length, so the benchmark also covers the units finishing their moves
+	if (bPlayingBack && SessionFrame >= PlaybackFrames && PlaybackCursor >= Orders.Num())
+	{
+		StopPlayback();
+	}
+}
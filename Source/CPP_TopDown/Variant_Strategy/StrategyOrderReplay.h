@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyOrderQueue.h"
+#include "ReplaySession.h"
+#include "StrategyOrderReplay.generated.h"
+
+/** One executed order, stamped with the frame (relative to the start of the recording) it ran on */
+struct FRecordedStrategyOrder
+{
+	int32 Frame = 0;
+	FStrategyOrder Order;
+
+	friend FArchive& operator<<(FArchive& Ar, FRecordedStrategyOrder& Recorded)
+	{
+		Ar << Recorded.Frame << Recorded.Order;
+		return Ar;
+	}
+};
+
+/**
+ *  Records the order batches the strategy player controller executes and plays them back frame for frame
+ *  Orders carry their own target locations, so a playback runs the same commands regardless of cursor state,
+ *  on a fixed timestep, which makes it usable as a repeatable benchmark for selection and move handling.
+ *
+ *   replay.Orders.Record [FPS]	start recording
+ *   replay.Orders.Stop [Name]	stop and save to Saved/StrategyOrders/<Name>.orders
+ *   replay.Orders.Play [Name]	play a recording back (live orders are dropped meanwhile)
+ *
+ *  -StrategyOrderReplay=<Name> plays a recording as soon as the world begins play (add -ReplayExit to quit
+ *  when it ends), and -StrategyOrderRecord=<Name> records the whole session and saves on world teardown.
+ *  Shares FReplaySession with UInputReplaySubsystem, so it won't start while an input replay is running.
+ */
+UCLASS()
+class UStrategyOrderReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** False if another replay session (e.g. an input recording) is already running */
+	bool StartRecording(float FPS);
+	bool StopRecording(const FString& Name);
+
+	bool StartPlayback(const FString& Name);
+	void StopPlayback();
+
+	bool IsRecording() const { return bRecording; }
+	bool IsPlayingBack() const { return bPlayingBack; }
+
+	/**
+	 *  Called by the controller with the batch it's about to execute.
+	 *  While recording the batch is saved, while playing back it's replaced with this frame's recorded orders.
+	 */
+	void ProcessBatch(TArray<FStrategyOrder>& Batch);
+
+protected:
+
+	static FString GetReplayPath(const FString& Name);
+
+	/** Locks the timestep and seeds the random streams for a recording or playback */
+	bool BeginSession(int32 Seed, float FPS);
+	void EndSession();
+
+	FReplaySession Session{TEXT("StrategyOrders")};
+
+	TArray<FRecordedStrategyOrder> Orders;
+
+	/** Frames since the recording/playback started */
+	int32 SessionFrame = 0;
+
+	/** Frames the recording being played back lasts */
+	int32 PlaybackFrames = 0;
+
+	/** Next order to hand out during playback */
+	int32 PlaybackCursor = 0;
+
+	/** Wall clock time the playback started at */
+	double PlaybackStartTime = 0.0;
+
+	bool bRecording = false;
+	bool bPlayingBack = false;
+	bool bExitAfterPlayback = false;
+
+	/** -StrategyOrderRecord name, saved on Deinitialize */
+	FString AutoRecordName;
+};
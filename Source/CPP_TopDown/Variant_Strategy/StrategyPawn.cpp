@@ -5,6 +5,7 @@
 #include "Components/SceneComponent.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/FloatingPawnMovement.h"
+#include "GameFramework/PlayerController.h"
 
 AStrategyPawn::AStrategyPawn()
 {
@@ -37,3 +38,49 @@ void AStrategyPawn::SetZoomModifier(float Value)
 	// set the ortho width on the camera
 	Camera->SetOrthoWidth(Value);
 }
+
+void AStrategyPawn::GetVisibleGroundBounds(float PlaneHeight, FBox2D& OutBounds) const
+{
+	OutBounds.Init();
+
+	const FPlane GroundPlane(FVector(0.0f, 0.0f, PlaneHeight), FVector::UpVector);
+
+	// project the viewport corners onto the ground plane
+	if (const APlayerController* PC = Cast<APlayerController>(GetController()))
+	{
+		int32 SizeX, SizeY;
+		PC->GetViewportSize(SizeX, SizeY);
+
+		if (SizeX > 0 && SizeY > 0)
+		{
+			const FVector2D ScreenCorners[4] = {
+				FVector2D(0.0f, 0.0f),
+				FVector2D(SizeX, 0.0f),
+				FVector2D(SizeX, SizeY),
+				FVector2D(0.0f, SizeY)
+			};
+
+			for (const FVector2D& Corner : ScreenCorners)
+			{
+				FVector WorldLocation, WorldDirection;
+
+				if (!PC->DeprojectScreenPositionToWorld(Corner.X, Corner.Y, WorldLocation, WorldDirection) || FMath::IsNearlyZero(WorldDirection.Z))
+				{
+					OutBounds.Init();
+					break;
+				}
+
+				OutBounds += FVector2D(FMath::RayPlaneIntersection(WorldLocation, WorldDirection, GroundPlane));
+			}
+		}
+	}
+
+	// no usable viewport, so assume a square the width of the ortho view under the camera
+	if (!OutBounds.bIsValid)
+	{
+		const float HalfWidth = Camera->OrthoWidth * 0.5f;
+		const FVector2D Center(Camera->GetComponentLocation());
+
+		OutBounds = FBox2D(Center - FVector2D(HalfWidth), Center + FVector2D(HalfWidth));
+	}
+}
@@ -38,4 +38,13 @@ public:
 
 	/** Returns the camera component */
 	UCameraComponent* GetCamera() const { return Camera; }
+
+	/**
+	 *  Returns the XY bounds of the ground area the camera currently sees
+	 *  Deprojects the viewport corners onto a horizontal plane; without a viewport (e.g. -nullrhi)
+	 *  falls back to a square one ortho width across, centered under the camera.
+	 *  @param PlaneHeight		height of the ground plane to project onto
+	 *  @param OutBounds		visible bounds on the plane
+	 */
+	void GetVisibleGroundBounds(float PlaneHeight, FBox2D& OutBounds) const;
 };
@@ -2,6 +2,7 @@
 
 
 #include "StrategyPlayerController.h"
+#include "CPP_TopDown.h"
 #include "EnhancedInputSubsystems.h"
 #include "Engine/LocalPlayer.h"
 #include "EnhancedInputComponent.h"
@@ -14,9 +15,15 @@
 #include "Engine/CollisionProfile.h"
 #include "Kismet/GameplayStatics.h"
 #include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyFlowField.h"
+#include "StrategyMoveOrder.h"
+#include "StrategyOrderReplay.h"
 #include "NavigationSystem.h"
 #include "Engine/OverlapResult.h"
 
+DECLARE_CYCLE_STAT(TEXT("StrategyPlayerController Orders"), STAT_WizardDungeon_StrategyOrders, STATGROUP_WizardDungeon);
+
 AStrategyPlayerController::AStrategyPlayerController()
 {
 	// mouse cursor should always be shown
@@ -69,7 +76,6 @@ void AStrategyPlayerController::SetupInputComponent()
 		EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractHoldStarted);
 		EnhancedInputComponent->BindAction(InteractHoldAction, ETriggerEvent::Triggered, this, &AStrategyPlayerController::InteractHoldTriggered);
 
-		EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Started, this, &AStrategyPlayerController::InteractClickStarted);
 		EnhancedInputComponent->BindAction(InteractClickAction, ETriggerEvent::Completed, this, &AStrategyPlayerController::InteractClickCompleted);
 
 		// Touch Interaction
@@ -101,6 +107,43 @@ void AStrategyPlayerController::OnPossess(APawn* InPawn)
 	// cast the HUD pointer
 	StrategyHUD = Cast<AStrategyHUD>(GetHUD());
 	check(StrategyHUD);
+
+	// get the unit registry
+	UnitRegistry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+	check(UnitRegistry);
+
+	// get the order replay, if this world has one
+	OrderReplay = GetWorld()->GetSubsystem<UStrategyOrderReplaySubsystem>();
+}
+
+void AStrategyPlayerController::PlayerTick(float DeltaTime)
+{
+	// input is processed at the start of the player tick, so this frame's orders are all queued by now
+	Super::PlayerTick(DeltaTime);
+
+	// orders need the pawn and registry set up on possession
+	if (!ControlledPawn)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_WizardDungeon_StrategyOrders);
+
+	OrderQueue.Flush(OrderBatch);
+
+	// let the replay record the batch, or swap it for the recorded one
+	if (OrderReplay)
+	{
+		OrderReplay->ProcessBatch(OrderBatch);
+	}
+
+	// execute the whole batch in the order it was given
+	for (const FStrategyOrder& Order : OrderBatch)
+	{
+		ExecuteOrder(Order);
+	}
+
+	OrderBatch.Reset();
 }
 
 void AStrategyPlayerController::DragSelectUnits(const TArray<AStrategyUnit*>& Units)
@@ -108,18 +151,26 @@ void AStrategyPlayerController::DragSelectUnits(const TArray<AStrategyUnit*>& Un
 	// do we have units in the list?
 	if (Units.Num() > 0)
 	{
-		// ensure any previous units are deselected
-		DoDeselectAllCommand();
+		// swap the selection on the registry and only notify the units whose state changed
+		TArray<AStrategyUnit*> NewlySelected;
+		TArray<AStrategyUnit*> NewlyDeselected;
 
-		// select each new unit
-		for (AStrategyUnit* CurrentUnit : Units)
+		UnitRegistry->SetSelection(Units, NewlySelected, NewlyDeselected);
+
+		// deselect units that left the box
+		for (AStrategyUnit* CurrentUnit : NewlyDeselected)
 		{
-			// add the unit to the selection list
-			ControlledUnits.Add(CurrentUnit);
+			CurrentUnit->UnitDeselected();
+		}
 
-			// select the unit
+		// select units that entered the box
+		for (AStrategyUnit* CurrentUnit : NewlySelected)
+		{
 			CurrentUnit->UnitSelected();
 		}
+
+		// the boxed units become the new selection
+		ControlledUnits = Units;
 	}
 }
 
@@ -190,6 +241,9 @@ void AStrategyPlayerController::SelectHoldTriggered(const FInputActionValue& Val
 
 	// update the selection box on the HUD
 	StrategyHUD->DragSelectUpdate(StartingSelectionPosition, SelectionSize, SelectionPosition, true);
+
+	// select the units inside the box with this frame's batch
+	QueueDragSelect(StartingSelectionPosition, SelectionPosition);
 }
 
 void AStrategyPlayerController::SelectHoldCompleted(const FInputActionValue& Value)
@@ -204,7 +258,7 @@ void AStrategyPlayerController::SelectClick(const FInputActionValue& Value)
 
 	if (GetLocationUnderCursor(CachedSelection))
 	{
-		DoSelectionCommand();
+		QueueOrder(EStrategyOrderType::Select, CachedSelection);
 	}
 }
 
@@ -226,14 +280,7 @@ void AStrategyPlayerController::InteractHoldTriggered(const FInputActionValue& V
 {
 
 	// do a drag scroll 
-	DoDragScrollCommand();
-}
-
-void AStrategyPlayerController::InteractClickStarted(const FInputActionValue& Value)
-{
-
-	// reset the interaction flag
-	ResetInteraction();
+	QueueDragScroll();
 }
 
 void AStrategyPlayerController::InteractClickCompleted(const FInputActionValue& Value)
@@ -242,19 +289,8 @@ void AStrategyPlayerController::InteractClickCompleted(const FInputActionValue&
 	// do we have any units in the control list and a valid interaction location under the cursor?
 	if (ControlledUnits.Num() > 0 && GetLocationUnderCursor(CachedInteraction))
 	{
-		// is double tap select all active?
-		if (bDoubleTapActive)
-		{
-			// release double tap select all
-			bDoubleTapActive = false;
-
-		}
-		else {
-
-			// move the selected units to the target location
-			DoMoveUnitsCommand();
-
-		}
+		// move the selected units to the target location
+		QueueOrder(EStrategyOrderType::MoveUnits, CachedInteraction);
 	}
 }
 
@@ -277,10 +313,13 @@ void AStrategyPlayerController::TouchPrimaryHoldTriggered(const FInputActionValu
 		// update the selection box on the HUD
 		StrategyHUD->DragSelectUpdate(StartingInteractionPosition, CurrentInteractionPosition - StartingSecondFingerPosition, CurrentInteractionPosition, true);
 
+		// select the units inside the box with this frame's batch
+		QueueDragSelect(StartingInteractionPosition, CurrentInteractionPosition);
+
 	} else {
 
 		// do a drag scroll instead
-		DoDragScrollCommand();
+		QueueDragScroll();
 
 	}
 }
@@ -292,7 +331,7 @@ void AStrategyPlayerController::TouchPrimaryTap(const FInputActionValue& Value)
 	CachedSelection = ProjectTouchPointToWorldSpace();
 
 	// do a selection action with the cached location
-	DoSelectionCommand();
+	QueueOrder(EStrategyOrderType::Select, CachedSelection);
 }
 
 void AStrategyPlayerController::TouchSecondaryStarted(const FInputActionValue& Value)
@@ -322,29 +361,126 @@ void AStrategyPlayerController::TouchSecondaryCompleted(const FInputActionValue&
 void AStrategyPlayerController::TouchDoubleTap(const FInputActionValue& Value)
 {
 
-	// raise the double tap flag
-	bDoubleTapActive = true;
+	// select or deselect everything, depending on the selection modifier
+	QueueOrder(EStrategyOrderType::DoubleTap);
+}
+
+void AStrategyPlayerController::QueueOrder(EStrategyOrderType Type, const FVector& Location)
+{
+	FStrategyOrder Order;
+	Order.Type = Type;
+	Order.bModifier = bSelectionModifier;
+	Order.Location = Location;
+
+	OrderQueue.Push(Order);
+}
+
+void AStrategyPlayerController::QueueDragSelect(const FVector2D& Start, const FVector2D& CurrentPosition)
+{
+	FStrategyOrder Order;
+	Order.Type = EStrategyOrderType::DragSelect;
+	Order.bModifier = bSelectionModifier;
 
-	// is the selection modifier mode active?
-	if (bSelectionModifier)
+	// project the selection box onto the ground, the order only needs its footprint
+	if (GetSelectionFootprint(Start, CurrentPosition, Order.Footprint))
 	{
-		// deselect all units
-		DoDeselectAllCommand();
+		OrderQueue.Push(Order);
+	}
+}
+
+void AStrategyPlayerController::QueueDragScroll()
+{
+
+	// choose the cursor position based on the input mode
+	FVector2D WorkingPosition;
+	
+	if (InputMode == EStrategyInputMode::SIM_Mouse)
+	{
+
+		// read the mouse position
+		bool bResult = GetMousePosition(WorkingPosition.X, WorkingPosition.Y);
 
 	} else {
 
-		// select all units on screen
-		DoSelectAllOnScreenCommand();
+		// read the touch 1 position
+		bool bPressed;
+		GetInputTouchState(ETouchIndex::Touch1, WorkingPosition.X, WorkingPosition.Y, bPressed);
+
+	}
+
+	// find the difference between the starting interaction position and current coords
+	const FVector2D InteractionDelta = StartingInteractionPosition - WorkingPosition;
+
+	const FRotator CameraRot(0.0f, -45.0f, 0.0f);
+
+	// rotate and scale the interaction delta
+	const FVector ScrollDelta = CameraRot.RotateVector(FVector(InteractionDelta.X, InteractionDelta.Y, 0.0f)) * DragMultiplier;
+
+	// queue the world offset. Scrolls given in the same frame add up into one
+	QueueOrder(EStrategyOrderType::DragScroll, ScrollDelta);
+}
+
+void AStrategyPlayerController::ExecuteOrder(const FStrategyOrder& Order)
+{
+	switch (Order.Type)
+	{
+	case EStrategyOrderType::Select:
+
+		DoSelectionCommand(Order.Location, Order.bModifier);
+		break;
+
+	case EStrategyOrderType::DoubleTap:
+
+		// raise the double tap flag
+		bDoubleTapActive = true;
+
+		// was the selection modifier active?
+		if (Order.bModifier)
+		{
+			// deselect all units
+			DoDeselectAllCommand();
+
+		} else {
+
+			// select all units on screen
+			DoSelectAllOnScreenCommand();
+		}
+		break;
+
+	case EStrategyOrderType::DragSelect:
+
+		DoDragSelectCommand(Order.Footprint);
+		break;
+
+	case EStrategyOrderType::DragScroll:
+
+		DoDragScrollCommand(Order.Location);
+		break;
+
+	case EStrategyOrderType::MoveUnits:
+
+		// is double tap select all active?
+		if (bDoubleTapActive)
+		{
+			// release double tap select all
+			bDoubleTapActive = false;
+
+		} else {
+
+			// move the selected units to the target location
+			DoMoveUnitsCommand(Order.Location);
+		}
+		break;
 	}
 }
 
-void AStrategyPlayerController::DoSelectionCommand()
+void AStrategyPlayerController::DoSelectionCommand(const FVector& Location, bool bModifier)
 {
 
 	// do a sphere sweep to look for actors to select
 	FHitResult OutHit;
 
-	const FVector Start = CachedSelection;
+	const FVector Start = Location;
 	const FVector End = Start + FVector::UpVector * 350.0f;
 
 	FCollisionShape InteractionSphere;
@@ -361,7 +497,7 @@ void AStrategyPlayerController::DoSelectionCommand()
 	GetWorld()->SweepSingleByObjectType(OutHit, Start, End, FQuat::Identity, ObjectParams, InteractionSphere, QueryParams);
 
 	// if we're using the mouse and are not holding the selection modifier key, deselect any units first
-	if (InputMode == SIM_Mouse && !bSelectionModifier)
+	if (InputMode == SIM_Mouse && !bModifier)
 	{
 
 		DoDeselectAllCommand();
@@ -378,11 +514,12 @@ void AStrategyPlayerController::DoSelectionCommand()
 		{
 
 			// is the unit already in the controlled list?
-			if (ControlledUnits.Contains(TargetUnit))
+			if (UnitRegistry->IsSelected(TargetUnit))
 			{
 
 				// remove the units from the controlled list
-				ControlledUnits.Remove(TargetUnit);
+				ControlledUnits.RemoveSingleSwap(TargetUnit);
+				UnitRegistry->SetSelected(TargetUnit, false);
 
 				// tell the unit it's been deselected
 				TargetUnit->UnitDeselected();
@@ -392,6 +529,7 @@ void AStrategyPlayerController::DoSelectionCommand()
 
 				// add the unit to the controlled list
 				ControlledUnits.Add(TargetUnit);
+				UnitRegistry->SetSelected(TargetUnit, true);
 
 				// tell the unit it's been selected
 				TargetUnit->UnitSelected();
@@ -414,7 +552,7 @@ void AStrategyPlayerController::DoSelectionCommand()
 			} else {
 
 				// move all selected units to the target location
-				DoMoveUnitsCommand();
+				DoMoveUnitsCommand(Location);
 
 			}
 		}
@@ -425,31 +563,18 @@ void AStrategyPlayerController::DoSelectionCommand()
 void AStrategyPlayerController::DoSelectAllOnScreenCommand()
 {
 
-	// find all NPCs currently on screen
-	TArray<AActor*> FoundActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AStrategyUnit::StaticClass(), FoundActors);
+	// flag every recently rendered unit that isn't selected yet
+	TArray<AStrategyUnit*> NewlySelected;
+	UnitRegistry->SelectRecentlyRendered(0.2f, NewlySelected);
 
-	// process each actor found
-	for (AActor* CurrentActor : FoundActors)
+	// process each newly selected unit
+	for (AStrategyUnit* CurrentUnit : NewlySelected)
 	{
-		// cast back to our unit class
-		if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentActor))
-		{
-			// has the actor been recently rendered?
-			if (CurrentActor->WasRecentlyRendered(0.2f))
-			{
+		// add it to the controlled units list
+		ControlledUnits.Add(CurrentUnit);
 
-				// is the actor not on our controlled units list?
-				if (!ControlledUnits.Contains(CurrentUnit))
-				{
-					// add it to the controlled units list
-					ControlledUnits.Add(CurrentUnit);
-
-					// notify it of selection
-					CurrentUnit->UnitSelected();
-				}
-			}
-		}		
+		// notify it of selection
+		CurrentUnit->UnitSelected();
 	}
 
 }
@@ -468,152 +593,192 @@ void AStrategyPlayerController::DoDeselectAllCommand()
 		}
 	}
 
-	// clear the controlled units list
+	// clear the controlled units list and the selection bits
 	ControlledUnits.Empty();
+	UnitRegistry->ClearSelection();
 }
 
-void AStrategyPlayerController::DoDragScrollCommand()
+void AStrategyPlayerController::DoDragSelectCommand(const FVector2D (&Footprint)[4])
 {
 
-	// choose the cursor position based on the input mode
-	FVector2D WorkingPosition;
-	
-	if (InputMode == EStrategyInputMode::SIM_Mouse)
-	{
-
-		// read the mouse position
-		bool bResult = GetMousePosition(WorkingPosition.X, WorkingPosition.Y);
-
-	} else {
-
-		// read the touch 1 position
-		bool bPressed;
-		GetInputTouchState(ETouchIndex::Touch1, WorkingPosition.X, WorkingPosition.Y, bPressed);
+	// get all the units in the selection box
+	BoxedUnits.Reset();
+	UnitRegistry->GetUnitsInFootprint(Footprint, BoxedUnits);
 
-	}
-
-	// find the difference between the starting interaction position and current coords
-	const FVector2D InteractionDelta = StartingInteractionPosition - WorkingPosition;
-
-	const FRotator CameraRot(0.0f, -45.0f, 0.0f);
+	// update the unit selection
+	DragSelectUnits(BoxedUnits);
+}
 
-	// rotate and scale the interaction delta
-	const FVector ScrollDelta = CameraRot.RotateVector(FVector(InteractionDelta.X, InteractionDelta.Y, 0.0f)) * DragMultiplier;
+void AStrategyPlayerController::DoDragScrollCommand(const FVector& ScrollDelta)
+{
 
 	// apply the world offset to the controlled pawn
 	ControlledPawn->AddActorWorldOffset(ScrollDelta);
 }
 
-void AStrategyPlayerController::DoMoveUnitsCommand()
+void AStrategyPlayerController::DoMoveUnitsCommand(const FVector& Goal)
 {
 
-	// set the movement goal
-	FVector CurrentMoveGoal;
+	// gather the units that will take part in the move
+	TArray<AStrategyUnit*> MovingUnits;
+	TArray<FVector> UnitLocations;
+	FVector Centroid = FVector::ZeroVector;
 
-	if (InputMode == EStrategyInputMode::SIM_Mouse)
+	for (AStrategyUnit* CurrentUnit : ControlledUnits)
 	{
+		if (IsValid(CurrentUnit))
+		{
+			MovingUnits.Add(CurrentUnit);
+			UnitLocations.Add(CurrentUnit->GetActorLocation());
+			Centroid += UnitLocations.Last();
+		}
+	}
 
-		// set the cached interaction point as our move goal
-		CurrentMoveGoal = CachedInteraction;
-
+	if (MovingUnits.Num() == 0)
+	{
+		return;
 	}
-	else {
 
-		// set the cached selection as our move goal
-		CurrentMoveGoal = CachedSelection;
+	Centroid /= MovingUnits.Num();
 
-	}
+	// lay out the formation facing away from the group, project it to the navmesh and hand out the slots
+	const FVector Facing = Goal - Centroid;
 
-	// get the closest selected unit to the move goal. This will be our lead unit
-	AStrategyUnit* Closest = GetClosestSelectedUnitToLocation(CurrentMoveGoal);
+	TArray<FVector> Slots;
+	FStrategyFormation::ComputeSlots(FormationShape, Goal, Facing, MovingUnits.Num(), FormationSpacing, Slots);
 
 	// this will be set to true if any of the move requests fail
-	bool bInteractionFailed = false;
+	bool bInteractionFailed = !FStrategyFormation::ProjectSlots(GetWorld(), Goal, FormationSpacing, Slots);
 
-	// process each unit in the controlled list
-	for (AStrategyUnit* CurrentUnit : ControlledUnits)
+	if (!bInteractionFailed)
 	{
-		if (IsValid(CurrentUnit))
+		TArray<int32> SlotForUnit;
+		FStrategyFormation::AssignSlots(UnitLocations, Slots, Facing, SlotForUnit);
+
+		// large groups share one flow field towards the goal instead of searching a path each
+		TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe> FlowField;
+		float HandoffDistance = 0.0f;
+
+		if (MovingUnits.Num() >= FlowFieldMinGroupSize)
+		{
+			if (UStrategyFlowFieldSubsystem* FlowFields = GetWorld()->GetSubsystem<UStrategyFlowFieldSubsystem>())
+			{
+				FlowField = FlowFields->RequestField(Goal);
+			}
+
+			// units leave the field once they're about as close as the far edge of the formation
+			for (const FVector& Slot : Slots)
+			{
+				HandoffDistance = FMath::Max(HandoffDistance, float(FVector::Dist2D(Slot, Goal)));
+			}
+
+			HandoffDistance += FormationSpacing;
+		}
+
+		// one order for the whole group. Units report back to it, so we only bind a single delegate
+		TSharedPtr<FStrategyMoveOrder> MoveOrder = MakeShared<FStrategyMoveOrder>();
+		MoveOrder->OrderId = ++LastMoveOrderId;
+		MoveOrder->Goal = Goal;
+		MoveOrder->OnUnitArrived.BindUObject(this, &AStrategyPlayerController::OnOrderUnitArrived);
+		MoveOrder->OnCompleted.BindUObject(this, &AStrategyPlayerController::OnMoveOrderCompleted);
+
+		// process each moving unit
+		for (int32 i = 0; i < MovingUnits.Num(); ++i)
 		{
+			AStrategyUnit* CurrentUnit = MovingUnits[i];
+			const FVector& Slot = Slots[SlotForUnit[i]];
 
 			// stop the unit
 			CurrentUnit->StopMoving();
 
-			// move the lead unit to the goal, all other units to random navigable points around it
-			FVector MoveGoal = CurrentMoveGoal;
+			// large groups follow the flow field, small groups (or no field available) queue an async path to the unit's slot
+			bool bMoveIssued = true;
 
-			if (CurrentUnit != Closest)
+			if (FlowField.IsValid())
 			{
-
-				UNavigationSystemV1::K2_GetRandomLocationInNavigableRadius(GetWorld(), CurrentMoveGoal, MoveGoal, InteractionRadius * 0.66f);
+				CurrentUnit->MoveAlongFlowField(FlowField, Slot, SlotAcceptanceRadius, HandoffDistance);
+			}
+			else
+			{
+				bMoveIssued = CurrentUnit->MoveToLocationAsync(Slot, SlotAcceptanceRadius);
 			}
 
-			// subscribe to the unit's move completed delegate
-			CurrentUnit->OnMoveCompleted.AddDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-
-			// set up movement to the goal location
-			if (!CurrentUnit->MoveToLocation(MoveGoal, InteractionRadius * 0.66f))
+			if (bMoveIssued)
 			{
+				// add the unit to the order
+				CurrentUnit->SetMoveOrder(MoveOrder);
+				MoveOrder->AddUnit();
+
+			} else {
+
 				// the move request failed, so flag it
 				bInteractionFailed = true;
 			}
 		}
-
 	}
 
 	// play the cursor feedback depending on whether our move succeeded or not
-	BP_CursorFeedback(CachedInteraction, !bInteractionFailed);
+	BP_CursorFeedback(Goal, !bInteractionFailed);
 
 }
 
-void AStrategyPlayerController::OnMoveCompleted(AStrategyUnit* MovedUnit)
+void AStrategyPlayerController::OnOrderUnitArrived(FStrategyMoveOrder& Order, AStrategyUnit* MovedUnit)
 {
-	// is the unit valid?
-	if (IsValid(MovedUnit))
+	// is the unit valid, and hasn't this order interacted yet?
+	if (IsValid(MovedUnit) && !Order.bInteractionHandled)
 	{
-		// unsubscribe from the delegate
-		MovedUnit->OnMoveCompleted.RemoveDynamic(this, &AStrategyPlayerController::OnMoveCompleted);
-		
-		// skip if interactions are locked
-		if (!bAllowInteraction)
+		const float DistanceSquared = FVector::DistSquared2D(Order.Goal, MovedUnit->GetActorLocation());
+
+		// is the unit close enough to the order's interaction location?
+		if (DistanceSquared < FMath::Square(InteractionRadius))
 		{
-			return;
+			DoOrderInteraction(Order, MovedUnit);
 		}
+		else if (DistanceSquared < Order.ClosestDistanceSquared && DistanceSquared < FMath::Square(InteractionRadius + FormationSpacing))
+		{
+			// the formation may have kept everyone just out of range, so remember who got closest
+			Order.ClosestUnit = MovedUnit;
+			Order.ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+}
 
-		// disallow additional interactions until we reset
-		bAllowInteraction = false;
+void AStrategyPlayerController::OnMoveOrderCompleted(FStrategyMoveOrder& Order)
+{
+	// the whole group is in. If nobody stopped within interaction range, e.g. because the goal is an obstacle
+	// the slots were projected around, let the unit that got closest do the interaction
+	if (!Order.bInteractionHandled && Order.ClosestUnit.IsValid())
+	{
+		DoOrderInteraction(Order, Order.ClosestUnit.Get());
+	}
+}
 
-		// is the unit close enough to the cached interaction location?
-		if(FVector::Dist2D(CachedInteraction, MovedUnit->GetActorLocation()) < InteractionRadius)
-		{
+void AStrategyPlayerController::DoOrderInteraction(FStrategyMoveOrder& Order, AStrategyUnit* Interactor)
+{
+	// only one interaction per order
+	Order.bInteractionHandled = true;
 
-			// do an overlap test to find nearby interactive objects
-			TArray<FOverlapResult> OutOverlaps;
+	// do an overlap test to find nearby interactive objects
+	TArray<FOverlapResult> OutOverlaps;
 
-			FCollisionShape CollisionSphere;
-			CollisionSphere.SetSphere(InteractionRadius);
+	FCollisionShape CollisionSphere;
+	CollisionSphere.SetSphere(InteractionRadius);
 
-			FCollisionObjectQueryParams ObjectParams;
-			ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
-			
-			FCollisionQueryParams QueryParams;
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
 
-			QueryParams.AddIgnoredActor(MovedUnit);
+	FCollisionQueryParams QueryParams;
 
-			for(const AStrategyUnit* CurSelected : ControlledUnits)
-			{
-				QueryParams.AddIgnoredActor(CurSelected);
-			}
+	if (GetWorld()->OverlapMultiByObjectType(OutOverlaps, Order.Goal, FQuat::Identity, ObjectParams, CollisionSphere, QueryParams))
+	{
+		for (const FOverlapResult& CurrentOverlap : OutOverlaps)
+		{
+			// skip units that are part of this order. The order id identifies the whole group
+			AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentOverlap.GetActor());
 
-			if (GetWorld()->OverlapMultiByObjectType(OutOverlaps, CachedInteraction, FQuat::Identity, ObjectParams, CollisionSphere, QueryParams))
+			if (CurrentUnit && CurrentUnit->GetMoveOrderId() != Order.OrderId)
 			{
-				for (const FOverlapResult& CurrentOverlap : OutOverlaps)
-				{
-					if (AStrategyUnit* CurrentUnit = Cast<AStrategyUnit>(CurrentOverlap.GetActor()))
-					{
-						CurrentUnit->Interact(MovedUnit);
-					}
-				}
+				CurrentUnit->Interact(Interactor);
 			}
 		}
 	}
@@ -715,7 +880,36 @@ FVector AStrategyPlayerController::ProjectTouchPointToWorldSpace()
 	return FVector::ZeroVector;
 }
 
-void AStrategyPlayerController::ResetInteraction()
+bool AStrategyPlayerController::GetSelectionFootprint(const FVector2D& Start, const FVector2D& CurrentPosition, FVector2D (&OutFootprint)[4]) const
 {
-	bAllowInteraction = true;
+	// corners of the selection box in screen space, in winding order
+	const FVector2D ScreenCorners[4] = {
+		FVector2D(Start.X, Start.Y),
+		FVector2D(CurrentPosition.X, Start.Y),
+		FVector2D(CurrentPosition.X, CurrentPosition.Y),
+		FVector2D(Start.X, CurrentPosition.Y)
+	};
+
+	const FPlane SelectionPlane(FVector(0.0f, 0.0f, SelectionPlaneHeight), FVector::UpVector);
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		FVector WorldLocation, WorldDirection;
+
+		// deproject the corner and intersect its ray with the selection plane
+		if (!DeprojectScreenPositionToWorld(ScreenCorners[i].X, ScreenCorners[i].Y, WorldLocation, WorldDirection))
+		{
+			return false;
+		}
+
+		// reject rays that never reach the plane
+		if (FMath::IsNearlyZero(WorldDirection.Z))
+		{
+			return false;
+		}
+
+		OutFootprint[i] = FVector2D(FMath::RayPlaneIntersection(WorldLocation, WorldDirection, SelectionPlane));
+	}
+
+	return true;
 }
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
+#include "StrategyFormation.h"
+#include "StrategyOrderQueue.h"
 #include "StrategyPlayerController.generated.h"
 
 class AStrategyPawn;
@@ -12,6 +14,9 @@ class UNiagaraSystem;
 struct FInputActionValue;
 class AStrategyHUD;
 class AStrategyNPC;
+class UStrategyUnitRegistry;
+class UStrategyOrderReplaySubsystem;
+struct FStrategyMoveOrder;
 class UInputAction;
 
 UENUM(BlueprintType)
@@ -37,6 +42,21 @@ protected:
 	/** Strategy HUD associated with this controller */
 	TObjectPtr<AStrategyHUD> StrategyHUD;
 
+	/** Registry of all units in the world. Also tracks which of them are selected */
+	TObjectPtr<UStrategyUnitRegistry> UnitRegistry;
+
+	/** Records or plays back the orders this controller executes */
+	TObjectPtr<UStrategyOrderReplaySubsystem> OrderReplay;
+
+	/** Orders given by input handlers this frame, waiting to be executed */
+	FStrategyOrderQueue OrderQueue;
+
+	/** Batch of orders being executed. Kept around so we don't reallocate every frame */
+	TArray<FStrategyOrder> OrderBatch;
+
+	/** Units found inside the drag select footprint. Kept around so we don't reallocate every frame */
+	TArray<AStrategyUnit*> BoxedUnits;
+
 	/** Determines the chosen input type */
 	UPROPERTY(EditAnywhere, Category = "Input")
 	TEnumAsByte<EStrategyInputMode> InputMode = SIM_Mouse;
@@ -55,8 +75,8 @@ protected:
 	/** If true, double-tap touch select all mode is active */
 	bool bDoubleTapActive = false;
 
-	/** If true, allow the player to interact with game objects */
-	bool bAllowInteraction = true;
+	/** Id of the last move order issued by this controller */
+	uint32 LastMoveOrderId = 0;
 
 	/** Input Action for moving the camera */
 	UPROPERTY(EditAnywhere, Category = "Input")
@@ -157,6 +177,26 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Camera", meta = (ClampMin = 0, ClampMax = 10000))
 	float DragMultiplier = 0.1f;
 
+	/** Shape the selected units arrange into when given a move order */
+	UPROPERTY(EditAnywhere, Category = "Formation")
+	TEnumAsByte<EStrategyFormationShape> FormationShape = SFS_Grid;
+
+	/** Distance between neighbouring formation slots */
+	UPROPERTY(EditAnywhere, Category = "Formation", meta = (ClampMin = 10, ClampMax = 1000, Units = "cm"))
+	float FormationSpacing = 150.0f;
+
+	/** How close a unit needs to get to its formation slot to finish its move */
+	UPROPERTY(EditAnywhere, Category = "Formation", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
+	float SlotAcceptanceRadius = 50.0f;
+
+	/** Groups at least this large steer along a shared flow field instead of pathfinding individually */
+	UPROPERTY(EditAnywhere, Category = "Formation", meta = (ClampMin = 1))
+	int32 FlowFieldMinGroupSize = 32;
+
+	/** World height the selection box is projected onto. Should roughly match the height of a unit's actor location */
+	UPROPERTY(EditAnywhere, Category = "Selection", meta = (Units = "cm"))
+	float SelectionPlaneHeight = 90.0f;
+
 	/** Trace channel to use for selection trace checks */
 	UPROPERTY(EditAnywhere, Category = "Selection")
 	TEnumAsByte<ETraceTypeQuery> SelectionTraceChannel;
@@ -178,9 +218,12 @@ public:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn);
 
+	/** Executes the orders queued up by this frame's input */
+	virtual void PlayerTick(float DeltaTime) override;
+
 public:
 
-	/** Updates selected units from the HUD's drag select box */
+	/** Updates selected units from a drag select box */
 	void DragSelectUnits(const TArray<AStrategyUnit*>& Units);
 
 	/** Passes the list of selected units */
@@ -218,9 +261,6 @@ protected:
 	/** Interaction hold input triggered */
 	void InteractHoldTriggered(const FInputActionValue& Value);
 
-	/** Interaction click input started */
-	void InteractClickStarted(const FInputActionValue& Value);
-
 	/** Interaction click input completed */
 	void InteractClickCompleted(const FInputActionValue& Value);
 
@@ -245,8 +285,20 @@ protected:
 	/** Touch primary finger double tap triggered */
 	void TouchDoubleTap(const FInputActionValue& Value);
 
-	/** Attempt to select or deselect units at the cached location */
-	void DoSelectionCommand();
+	/** Adds an order to this frame's batch */
+	void QueueOrder(EStrategyOrderType Type, const FVector& Location = FVector::ZeroVector);
+
+	/** Queues a drag select with the selection box between the given screen positions */
+	void QueueDragSelect(const FVector2D& Start, const FVector2D& CurrentPosition);
+
+	/** Queues a drag scroll from the current cursor or touch position */
+	void QueueDragScroll();
+
+	/** Executes a single order from the frame's batch */
+	void ExecuteOrder(const FStrategyOrder& Order);
+
+	/** Attempt to select or deselect units at the given location */
+	void DoSelectionCommand(const FVector& Location, bool bModifier);
 
 	/** Select all units currently on screen */
 	void DoSelectAllOnScreenCommand();
@@ -254,15 +306,23 @@ protected:
 	/** Deselect all controlled units */
 	void DoDeselectAllCommand();
 
-	/** Drag scroll the camera */
-	void DoDragScrollCommand();
+	/** Select the units inside the given ground footprint */
+	void DoDragSelectCommand(const FVector2D (&Footprint)[4]);
 
-	/** Move all selected units */
-	void DoMoveUnitsCommand();
+	/** Drag scroll the camera by the given world offset */
+	void DoDragScrollCommand(const FVector& ScrollDelta);
 
-	/** Called when a unit move is completed */
-	UFUNCTION()
-	void OnMoveCompleted(AStrategyUnit* MovedUnit);
+	/** Move all selected units to the given location */
+	void DoMoveUnitsCommand(const FVector& Goal);
+
+	/** Called when a unit taking part in a move order finishes its move */
+	void OnOrderUnitArrived(FStrategyMoveOrder& Order, AStrategyUnit* MovedUnit);
+
+	/** Called once every unit of a move order has arrived or left it */
+	void OnMoveOrderCompleted(FStrategyMoveOrder& Order);
+
+	/** Has the interactor interact with the objects around the order's goal, once per order */
+	void DoOrderInteraction(FStrategyMoveOrder& Order, AStrategyUnit* Interactor);
 
 	/** Sorts all controlled units based on their distance to the provided world location */
 	AStrategyUnit* GetClosestSelectedUnitToLocation(FVector TargetLocation);
@@ -276,10 +336,10 @@ protected:
 	/** Projects the current touch location into world space */
 	FVector ProjectTouchPointToWorldSpace();
 
+	/** Projects the selection box corners onto the selection plane. Returns false if any corner can't be projected */
+	bool GetSelectionFootprint(const FVector2D& Start, const FVector2D& CurrentPosition, FVector2D (&OutFootprint)[4]) const;
+
 	/** Spawns the positive cursor effect */
 	UFUNCTION(BlueprintImplementableEvent, Category="Cursor", meta=(DisplayName="Cursor Feedback"))
 	void BP_CursorFeedback(FVector Location, bool bPositive);
-
-	/** Resets the interaction flag */
-	void ResetInteraction();
 };
@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategySelectionMarkers.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "UObject/ConstructorHelpers.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+
+AStrategySelectionMarkers::AStrategySelectionMarkers()
+{
+	// update after units have moved this frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// create the marker instances component
+	Markers = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Markers"));
+	RootComponent = Markers;
+
+	// markers are purely visual
+	Markers->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Markers->SetCanEverAffectNavigation(false);
+	Markers->SetCastShadow(false);
+
+	// default to a flattened cylinder, Blueprint subclasses can pick their own mesh
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> MarkerMesh(TEXT("/Engine/BasicShapes/Cylinder.Cylinder"));
+
+	if (MarkerMesh.Succeeded())
+	{
+		Markers->SetStaticMesh(MarkerMesh.Object);
+	}
+}
+
+void AStrategySelectionMarkers::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+
+	if (!Registry)
+	{
+		return;
+	}
+
+	// one transform per selected unit, read straight from the registry's selection
+	MarkerTransforms.Reset();
+
+	Registry->ForEachSelectedUnit([this](const AStrategyUnit* Unit)
+	{
+		const FVector Feet = Unit->GetActorLocation() - FVector(0.0f, 0.0f, Unit->GetSimpleCollisionHalfHeight());
+		MarkerTransforms.Emplace(FQuat::Identity, Feet + MarkerOffset, MarkerScale);
+	});
+
+	// only rebuild the instance list when the selection count changes, otherwise update in place
+	if (MarkerTransforms.Num() != Markers->GetInstanceCount())
+	{
+		Markers->ClearInstances();
+		Markers->AddInstances(MarkerTransforms, false, true, false);
+	}
+	else if (MarkerTransforms.Num() > 0)
+	{
+		Markers->BatchUpdateInstancesTransforms(0, MarkerTransforms, true, true);
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "StrategySelectionMarkers.generated.h"
+
+class UInstancedStaticMeshComponent;
+
+/**
+ *  Draws a marker under every selected strategy unit
+ *  All markers are instances of a single instanced static mesh, repositioned once per frame
+ *  from the unit registry's selection, so the cost stays flat no matter how many units are selected.
+ */
+UCLASS()
+class AStrategySelectionMarkers : public AActor
+{
+	GENERATED_BODY()
+
+private:
+
+	/** Marker instances, one per selected unit */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* Markers;
+
+protected:
+
+	/** Offset from the unit's feet to the marker */
+	UPROPERTY(EditAnywhere, Category = "Selection")
+	FVector MarkerOffset = FVector(0.0f, 0.0f, 2.0f);
+
+	/** Scale applied to each marker instance */
+	UPROPERTY(EditAnywhere, Category = "Selection")
+	FVector MarkerScale = FVector(1.2f, 1.2f, 0.02f);
+
+	/** Instance transforms, kept around so we don't reallocate every frame */
+	TArray<FTransform> MarkerTransforms;
+
+public:
+
+	/** Constructor */
+	AStrategySelectionMarkers();
+
+	/** Moves the marker instances to the currently selected units */
+	virtual void Tick(float DeltaSeconds) override;
+};
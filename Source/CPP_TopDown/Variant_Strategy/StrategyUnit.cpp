@@ -2,13 +2,20 @@
 
 
 #include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "StrategyFlowField.h"
+#include "StrategyMoveOrder.h"
 #include "AIController.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "CrowdAvoidanceMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Components/SphereComponent.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "NavigationSystem.h"
+#include "NavFilters/NavigationQueryFilter.h"
 
-AStrategyUnit::AStrategyUnit()
+AStrategyUnit::AStrategyUnit(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -31,6 +38,7 @@ AStrategyUnit::AStrategyUnit()
 	GetCharacterMovement()->bUseFlatBaseForFloorChecks = true;
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 640.0f, 0.0f);
 	GetCharacterMovement()->bOrientRotationToMovement = true;
+	// local avoidance is solved for the whole crowd by the crowd avoidance subsystem
 	GetCharacterMovement()->AvoidanceConsiderationRadius = 150.0f;
 	GetCharacterMovement()->AvoidanceWeight = 1.0f;
 	GetCharacterMovement()->bConstrainToPlane = true;
@@ -39,6 +47,46 @@ AStrategyUnit::AStrategyUnit()
 	GetCharacterMovement()->SetFixedBrakingDistance(true);
 }
 
+void AStrategyUnit::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// join the unit registry so selection queries can find us
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		Registry->RegisterUnit(this);
+	}
+}
+
+void AStrategyUnit::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// don't keep our order waiting on an arrival that will never come
+	if (MoveOrder.IsValid())
+	{
+		TSharedPtr<FStrategyMoveOrder> Order = MoveTemp(MoveOrder);
+		Order->NotifyUnitDropped();
+	}
+
+	// leave the unit registry
+	if (UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		Registry->UnregisterUnit(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AStrategyUnit::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// steer along the flow field if we're on a flow field move
+	if (FlowField.IsValid())
+	{
+		UpdateFlowFieldMove();
+	}
+}
+
 void AStrategyUnit::NotifyControllerChanged()
 {
 	// validate and save a copy of the AI controller reference
@@ -57,10 +105,65 @@ void AStrategyUnit::NotifyControllerChanged()
 
 void AStrategyUnit::StopMoving()
 {
-	// use the character movement component to stop movement
+	// drop any path we're still waiting on, any flow field we're following and the order we were part of.
+	// Forgetting the active request means the abort it's about to report isn't taken for an arrival
+	PendingPathQuery = INVALID_NAVQUERYID;
+	ActiveMoveRequest = FAIRequestID::InvalidRequest;
+	FlowField.Reset();
+
+	if (MoveOrder.IsValid())
+	{
+		TSharedPtr<FStrategyMoveOrder> Order = MoveTemp(MoveOrder);
+		Order->NotifyUnitDropped();
+	}
+
+	// stop following the path, then kill any velocity left over
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
+
 	GetCharacterMovement()->StopMovementImmediately();
 }
 
+void AStrategyUnit::SetSimulationLOD(EStrategyUnitLOD NewLOD, float TickInterval)
+{
+	if (NewLOD == SimulationLOD)
+	{
+		return;
+	}
+
+	SimulationLOD = NewLOD;
+
+	const bool bFullFidelity = NewLOD == SUL_Full;
+	const float Interval = bFullFidelity ? 0.0f : TickInterval;
+
+	// tick ourselves, our movement and our path following less often. Ticks still get the full elapsed time, so we cover the same ground
+	SetActorTickInterval(Interval);
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	Movement->SetComponentTickInterval(Interval);
+
+	if (AIController)
+	{
+		if (UPathFollowingComponent* PFComp = AIController->GetPathFollowingComponent())
+		{
+			PFComp->SetComponentTickInterval(Interval);
+		}
+	}
+
+	// walking on the navmesh skips the floor sweeps
+	Movement->DefaultLandMovementMode = bFullFidelity ? MOVE_Walking : MOVE_NavWalking;
+
+	if (Movement->IsMovingOnGround())
+	{
+		Movement->SetMovementMode(Movement->DefaultLandMovementMode);
+	}
+
+	// nobody sees the animation, so don't evaluate it
+	GetMesh()->bPauseAnims = !bFullFidelity;
+}
+
 void AStrategyUnit::UnitSelected()
 {
 	// pass control to BP
@@ -109,6 +212,8 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 
 		// request a move to the AI Controller
 		FNavPathSharedPtr FollowedPath;
+		ActiveMoveRequest = FAIRequestID::InvalidRequest;
+		MoveDestination = Location;
 		const FPathFollowingRequestResult ResultData = AIController->MoveTo(MoveReq, &FollowedPath);
 		
 		// check the move result
@@ -123,13 +228,14 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 			// already at goal. Return true and call the move completed delegate
 			case EPathFollowingRequestResult::AlreadyAtGoal:
 
-				OnMoveCompleted.Broadcast(this);
+				FinishMove();
 				return true;
 				break;
 
 			// move successfully scheduled. Return true
 			case EPathFollowingRequestResult::RequestSuccessful:
 
+				ActiveMoveRequest = ResultData.MoveId;
 				return true;
 				break;
 		}
@@ -139,8 +245,186 @@ bool AStrategyUnit::MoveToLocation(const FVector& Location, float AcceptanceRadi
 	return false;
 }
 
+bool AStrategyUnit::MoveToLocationAsync(const FVector& Location, float AcceptanceRadius)
+{
+	// ensure we have a valid AI Controller
+	if (!AIController)
+	{
+		return false;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetNavDataForProps(GetNavAgentPropertiesRef(), GetNavAgentLocation()) : nullptr;
+
+	if (!NavData)
+	{
+		return false;
+	}
+
+	// set up the path query with the same filter the regular move uses
+	FPathFindingQuery Query(this, *NavData, GetNavAgentLocation(), Location,
+		UNavigationQueryFilter::GetQueryFilter(*NavData, this, AIController->GetDefaultNavigationFilterClass()));
+
+	Query.SetAllowPartialPaths(true);
+
+	// queue the query. Issuing a new one supersedes any query still in flight
+	MoveDestination = Location;
+	PendingAcceptanceRadius = AcceptanceRadius;
+	PendingPathQuery = NavSys->FindPathAsync(GetNavAgentPropertiesRef(), Query,
+		FNavPathQueryDelegate::CreateUObject(this, &AStrategyUnit::OnAsyncPathFound));
+
+	return PendingPathQuery != INVALID_NAVQUERYID;
+}
+
+void AStrategyUnit::MoveAlongFlowField(const TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe>& Field, const FVector& Location, float AcceptanceRadius, float HandoffDistance)
+{
+	// the flow field replaces any path following
+	ActiveMoveRequest = FAIRequestID::InvalidRequest;
+
+	if (AIController)
+	{
+		AIController->StopMovement();
+	}
+
+	PendingPathQuery = INVALID_NAVQUERYID;
+
+	FlowField = Field;
+	FlowTarget = Location;
+	MoveDestination = Location;
+	FlowAcceptanceRadius = AcceptanceRadius;
+	FlowHandoffDistance = HandoffDistance;
+
+	// progress is tracked from the first sample, so time spent waiting on the field build doesn't count
+	FlowBestDistance = MAX_flt;
+	FlowBestTime = 0.0;
+}
+
+void AStrategyUnit::UpdateFlowFieldMove()
+{
+	// the field may still be building on a worker thread
+	if (!FlowField->IsReady())
+	{
+		return;
+	}
+
+	const FVector Location = GetActorLocation();
+
+	// have we arrived?
+	if (FVector::DistSquared2D(Location, FlowTarget) <= FMath::Square(FlowAcceptanceRadius))
+	{
+		FlowField.Reset();
+		FinishMove();
+		return;
+	}
+
+	FVector Direction;
+	float Distance;
+
+	if (!FlowField->Sample(Location, Direction, Distance))
+	{
+		// off the field or cut off from the goal
+		FallBackFromFlowField();
+		return;
+	}
+
+	// close to the goal the field converges on one cell, so head for our own target instead
+	const bool bHandedOff = Distance <= FlowHandoffDistance;
+	if (bHandedOff)
+	{
+		Direction = (FlowTarget - Location).GetSafeNormal2D();
+	}
+
+	// the coarse grid can steer into geometry it doesn't know about. If we stop getting closer, let the navmesh path us out
+	const float Remaining = bHandedOff ? FVector::Dist2D(Location, FlowTarget) : Distance;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (Remaining < FlowBestDistance - FlowStuckMinProgress || FlowBestDistance == MAX_flt)
+	{
+		FlowBestDistance = Remaining;
+		FlowBestTime = Now;
+	}
+	else if (Now - FlowBestTime > FlowStuckTime)
+	{
+		FallBackFromFlowField();
+		return;
+	}
+
+	AddMovementInput(Direction);
+}
+
+void AStrategyUnit::FallBackFromFlowField()
+{
+	FlowField.Reset();
+
+	if (!MoveToLocationAsync(FlowTarget, FlowAcceptanceRadius))
+	{
+		FinishMove();
+	}
+}
+
+void AStrategyUnit::OnAsyncPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path)
+{
+	// ignore results for queries that were superseded or cancelled
+	if (QueryID != PendingPathQuery)
+	{
+		return;
+	}
+
+	PendingPathQuery = INVALID_NAVQUERYID;
+
+	if (AIController && Result == ENavigationQueryResult::Success && Path.IsValid())
+	{
+		// follow the path we were given instead of having the controller search again
+		FAIMoveRequest MoveReq;
+
+		MoveReq.SetGoalLocation(Path->GetEndLocation());
+		MoveReq.SetAcceptanceRadius(PendingAcceptanceRadius);
+		MoveReq.SetAllowPartialPath(true);
+		MoveReq.SetUsePathfinding(true);
+		MoveReq.SetCanStrafe(false);
+
+		// RequestMove aborts any previous move first, which must not count as an arrival
+		ActiveMoveRequest = FAIRequestID::InvalidRequest;
+		ActiveMoveRequest = AIController->RequestMove(MoveReq, Path);
+
+		if (ActiveMoveRequest.IsValid())
+		{
+			return;
+		}
+	}
+
+	// no path to follow, so the move is over
+	FinishMove();
+}
+
 void AStrategyUnit::OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result)
 {
+	// ignore requests we've already replaced or dropped
+	if (!ActiveMoveRequest.IsValid() || RequestID != ActiveMoveRequest)
+	{
+		return;
+	}
+
+	FinishMove();
+}
+
+void AStrategyUnit::SetMoveOrder(const TSharedPtr<FStrategyMoveOrder>& Order)
+{
+	MoveOrder = Order;
+	MoveOrderId = Order.IsValid() ? Order->OrderId : 0;
+}
+
+void AStrategyUnit::FinishMove()
+{
+	ActiveMoveRequest = FAIRequestID::InvalidRequest;
+
 	// call the delegate
 	OnMoveCompleted.Broadcast(this);
+
+	// report to our move order, once
+	if (MoveOrder.IsValid())
+	{
+		TSharedPtr<FStrategyMoveOrder> Order = MoveTemp(MoveOrder);
+		Order->NotifyUnitArrived(this);
+	}
 }
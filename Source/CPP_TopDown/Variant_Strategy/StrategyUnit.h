@@ -5,9 +5,21 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AIController.h"
+#include "AI/Navigation/NavigationTypes.h"
 #include "StrategyUnit.generated.h"
 
 class USphereComponent;
+struct FStrategyFlowField;
+struct FStrategyMoveOrder;
+
+/** How much simulation work a unit gets, picked by the unit LOD subsystem from the camera view */
+UENUM(BlueprintType)
+enum EStrategyUnitLOD : uint8
+{
+	SUL_Full		UMETA(DisplayName = "Full"),
+	SUL_Reduced		UMETA(DisplayName = "Reduced"),
+	SUL_Minimal		UMETA(DisplayName = "Minimal")
+};
 
 /** Delegate to report that this unit has finished moving */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnUnitMoveCompletedDelegate, AStrategyUnit*, Unit);
@@ -21,6 +33,8 @@ class AStrategyUnit : public ACharacter
 {
 	GENERATED_BODY()
 
+	friend class UStrategyUnitRegistry;
+
 private:
 
 	/** Interaction range sphere */
@@ -32,13 +46,70 @@ protected:
 	/** Cast reference to the AI Controlling this unit */
 	TObjectPtr<AAIController> AIController;
 
+	/** Path query we're waiting on, INVALID_NAVQUERYID if none */
+	uint32 PendingPathQuery = INVALID_NAVQUERYID;
+
+	/** Acceptance radius for the move waiting on the pending path query */
+	float PendingAcceptanceRadius = 0.0f;
+
+	/** Move request the AI controller is currently following for us */
+	FAIRequestID ActiveMoveRequest;
+
+	/** Move order this unit is taking part in, released once the unit reports its arrival */
+	TSharedPtr<FStrategyMoveOrder> MoveOrder;
+
+	/** Id of the last move order this unit was given, 0 if none */
+	uint32 MoveOrderId = 0;
+
+	/** Destination of the current or last move */
+	FVector MoveDestination = FVector::ZeroVector;
+
+	/** Flow field this unit is steering along, if any */
+	TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe> FlowField;
+
+	/** Final destination of the flow field move */
+	FVector FlowTarget = FVector::ZeroVector;
+
+	/** Acceptance radius of the flow field move */
+	float FlowAcceptanceRadius = 0.0f;
+
+	/** Remaining path distance at which the unit stops following the field and heads straight for its target */
+	float FlowHandoffDistance = 0.0f;
+
+	/** Smallest remaining distance reached on the flow field move so far, and when */
+	float FlowBestDistance = MAX_flt;
+	double FlowBestTime = 0.0;
+
+	/** How long a flow field move may go without getting closer to its target before falling back to pathfinding */
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = 0, Units = "s"))
+	float FlowStuckTime = 1.5f;
+
+	/** How much closer the unit has to get within FlowStuckTime to count as making progress */
+	UPROPERTY(EditAnywhere, Category = "Movement", meta = (ClampMin = 0, Units = "cm"))
+	float FlowStuckMinProgress = 50.0f;
+
+	/** Index of this unit in the unit registry, INDEX_NONE while unregistered */
+	int32 RegistryIndex = INDEX_NONE;
+
+	/** Current simulation LOD */
+	TEnumAsByte<EStrategyUnitLOD> SimulationLOD = SUL_Full;
+
 public:
 
 	/** Constructor */
-	AStrategyUnit();
+	AStrategyUnit(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
+	/** Registers this unit with the unit registry */
+	virtual void BeginPlay() override;
+
+	/** Removes this unit from the unit registry */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Steers along the current flow field, if any */
+	virtual void Tick(float DeltaSeconds) override;
+
 	virtual void NotifyControllerChanged() override;
 
 public:
@@ -58,11 +129,59 @@ public:
 	/** Attempts to move this unit to its */
 	bool MoveToLocation(const FVector& Location, float AcceptanceRadius);
 
+	/** Requests a path to the location on the navigation worker and starts following it once it's found. Returns false if the query couldn't be issued */
+	bool MoveToLocationAsync(const FVector& Location, float AcceptanceRadius);
+
+	/** Makes this unit part of a group move order. Set after issuing the move */
+	void SetMoveOrder(const TSharedPtr<FStrategyMoveOrder>& Order);
+
+	/** Returns the id of the last move order this unit was given */
+	uint32 GetMoveOrderId() const { return MoveOrderId; }
+
+	/** Returns true while the unit is waiting on a path, following one or steering along a flow field */
+	bool IsMoving() const { return PendingPathQuery != INVALID_NAVQUERYID || ActiveMoveRequest.IsValid() || FlowField.IsValid(); }
+
+	/** Returns the destination of the current or last move */
+	const FVector& GetMoveDestination() const { return MoveDestination; }
+
+	/**
+	 *  Switches how much simulation work this unit gets
+	 *  Below full fidelity the unit, its movement and its path following tick at the given interval,
+	 *  it walks on the navmesh instead of sweeping for the floor and its animation is paused.
+	 *  @param NewLOD			the new simulation LOD
+	 *  @param TickInterval		tick interval to use below full fidelity
+	 */
+	void SetSimulationLOD(EStrategyUnitLOD NewLOD, float TickInterval);
+
+	/** Returns the current simulation LOD */
+	EStrategyUnitLOD GetSimulationLOD() const { return SimulationLOD; }
+
+	/**
+	 *  Moves this unit by steering along a shared flow field instead of following its own path
+	 *  @param Field				flow field towards the group's destination
+	 *  @param Location				this unit's own target location near the field's goal
+	 *  @param AcceptanceRadius		how close to the target location the move completes
+	 *  @param HandoffDistance		remaining path distance at which the unit leaves the field and heads straight for its target
+	 */
+	void MoveAlongFlowField(const TSharedPtr<const FStrategyFlowField, ESPMode::ThreadSafe>& Field, const FVector& Location, float AcceptanceRadius, float HandoffDistance);
+
 protected:
 
 	/** called by the AI controller when this unit has finished moving */
 	void OnMoveFinished(FAIRequestID RequestID, const FPathFollowingResult& Result);
 
+	/** Ends the current move: notifies listeners and reports the arrival to the move order */
+	void FinishMove();
+
+	/** Samples the flow field and applies this frame's steering input */
+	void UpdateFlowFieldMove();
+
+	/** Leaves the flow field and requests a regular path to the flow target instead */
+	void FallBackFromFlowField();
+
+	/** called by the navigation system when an async path query completes */
+	void OnAsyncPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path);
+
 protected:
 
 	/** Blueprint handler for strategy game selection */
@@ -0,0 +1,156 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitLOD.h"
+#include "StrategyPawn.h"
+#include "StrategyUnit.h"
+#include "StrategyUnitRegistry.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+namespace StrategyUnitLOD
+{
+	static bool bEnabled = true;
+	static FAutoConsoleVariableRef CVarEnabled(
+		TEXT("ai.StrategyLOD.Enable"),
+		bEnabled,
+		TEXT("Lower the simulation fidelity of strategy units outside the camera view"));
+
+	static float EnterMargin = 0.15f;
+	static FAutoConsoleVariableRef CVarEnterMargin(
+		TEXT("ai.StrategyLOD.EnterMargin"),
+		EnterMargin,
+		TEXT("Distance outside the view, in camera ortho widths, at which units return to full fidelity"));
+
+	static float ExitMargin = 0.3f;
+	static FAutoConsoleVariableRef CVarExitMargin(
+		TEXT("ai.StrategyLOD.ExitMargin"),
+		ExitMargin,
+		TEXT("Distance outside the view, in camera ortho widths, beyond which units drop below full fidelity. Keep it above ai.StrategyLOD.EnterMargin"));
+
+	static float FarMargin = 1.5f;
+	static FAutoConsoleVariableRef CVarFarMargin(
+		TEXT("ai.StrategyLOD.FarMargin"),
+		FarMargin,
+		TEXT("Distance outside the view, in camera ortho widths, beyond which units drop to minimal fidelity"));
+
+	static float ReducedTickInterval = 0.1f;
+	static FAutoConsoleVariableRef CVarReducedTickInterval(
+		TEXT("ai.StrategyLOD.ReducedTickInterval"),
+		ReducedTickInterval,
+		TEXT("Tick interval in seconds of off-screen units near the view"));
+
+	static float MinimalTickInterval = 0.25f;
+	static FAutoConsoleVariableRef CVarMinimalTickInterval(
+		TEXT("ai.StrategyLOD.MinimalTickInterval"),
+		MinimalTickInterval,
+		TEXT("Tick interval in seconds of units far off-screen"));
+
+	static FAutoConsoleCommandWithWorldAndArgs StatsCommand(
+		TEXT("ai.StrategyLOD.Stats"),
+		TEXT("Logs how many strategy units are at each simulation LOD."),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UStrategyUnitLODSubsystem* LOD = World ? World->GetSubsystem<UStrategyUnitLODSubsystem>() : nullptr)
+			{
+				LOD->LogStats();
+			}
+		}));
+}
+
+bool UStrategyUnitLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UStrategyUnitLODSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UStrategyUnitLODSubsystem, STATGROUP_Tickables);
+}
+
+AStrategyPawn* UStrategyUnitLODSubsystem::GetViewPawn() const
+{
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	return PC ? Cast<AStrategyPawn>(PC->GetPawn()) : nullptr;
+}
+
+void UStrategyUnitLODSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>();
+	const AStrategyPawn* Pawn = GetViewPawn();
+
+	// without a strategy camera there's no view to key the LOD to
+	if (!StrategyUnitLOD::bEnabled || !Registry || !Pawn)
+	{
+		if (bApplied)
+		{
+			RestoreFullFidelity();
+		}
+		return;
+	}
+
+	FBox2D ViewBounds;
+	Pawn->GetVisibleGroundBounds(0.0f, ViewBounds);
+
+	// margins are in ortho widths, so they grow and shrink with the zoom
+	const float OrthoWidth = Pawn->GetCamera()->OrthoWidth;
+
+	const FBox2D EnterBounds = ViewBounds.ExpandBy(OrthoWidth * StrategyUnitLOD::EnterMargin);
+	const FBox2D ExitBounds = ViewBounds.ExpandBy(OrthoWidth * FMath::Max(StrategyUnitLOD::ExitMargin, StrategyUnitLOD::EnterMargin));
+	const FBox2D FarBounds = ViewBounds.ExpandBy(OrthoWidth * FMath::Max(StrategyUnitLOD::FarMargin, StrategyUnitLOD::ExitMargin));
+
+	NumUnitsPerLOD[SUL_Full] = NumUnitsPerLOD[SUL_Reduced] = NumUnitsPerLOD[SUL_Minimal] = 0;
+
+	for (AStrategyUnit* Unit : Registry->GetUnits())
+	{
+		const FVector2D Location(Unit->GetActorLocation());
+
+		// full fidelity units keep it until they're past the exit margin, everyone else needs to come within the enter margin
+		const FBox2D& FullBounds = Unit->GetSimulationLOD() == SUL_Full ? ExitBounds : EnterBounds;
+
+		EStrategyUnitLOD LOD = SUL_Minimal;
+		float TickInterval = StrategyUnitLOD::MinimalTickInterval;
+
+		if (FullBounds.IsInside(Location))
+		{
+			LOD = SUL_Full;
+		}
+		else if (FarBounds.IsInside(Location))
+		{
+			LOD = SUL_Reduced;
+			TickInterval = StrategyUnitLOD::ReducedTickInterval;
+		}
+
+		// only transitions touch the unit's components
+		Unit->SetSimulationLOD(LOD, TickInterval);
+		++NumUnitsPerLOD[LOD];
+	}
+
+	bApplied = true;
+}
+
+void UStrategyUnitLODSubsystem::RestoreFullFidelity()
+{
+	if (const UStrategyUnitRegistry* Registry = GetWorld()->GetSubsystem<UStrategyUnitRegistry>())
+	{
+		for (AStrategyUnit* Unit : Registry->GetUnits())
+		{
+			Unit->SetSimulationLOD(SUL_Full, 0.0f);
+		}
+
+		NumUnitsPerLOD[SUL_Full] = Registry->GetNumUnits();
+		NumUnitsPerLOD[SUL_Reduced] = NumUnitsPerLOD[SUL_Minimal] = 0;
+	}
+
+	bApplied = false;
+}
+
+void UStrategyUnitLODSubsystem::LogStats() const
+{
+	UE_LOG(LogTemp, Display, TEXT("[StrategyLOD] full %d, reduced %d, minimal %d"),
+		NumUnitsPerLOD[SUL_Full], NumUnitsPerLOD[SUL_Reduced], NumUnitsPerLOD[SUL_Minimal]);
+}
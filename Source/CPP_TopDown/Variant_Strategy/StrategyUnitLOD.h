@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "StrategyUnitLOD.generated.h"
+
+class AStrategyPawn;
+
+/**
+ *  Picks a simulation LOD for every strategy unit from the local player's camera
+ *  Units in or near the visible rectangle get full fidelity. Units off-screen tick less often, walk
+ *  on the navmesh and stop animating, and units far off-screen tick least. All margins scale with
+ *  the camera's ortho width, so zooming out widens the full fidelity band along with the view.
+ *
+ *  Units are switched back to full fidelity a margin before they come into view and only drop
+ *  out of it a wider margin after they leave, so nothing the player can see, drag-select or
+ *  select by rendering ever runs at reduced fidelity, and units on the edge don't flip back and forth.
+ */
+UCLASS()
+class UStrategyUnitLODSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Number of units at each LOD after the last update */
+	int32 NumUnitsPerLOD[3] = { 0, 0, 0 };
+
+	/** True if the last update applied LODs, so turning the system off can restore full fidelity once */
+	bool bApplied = false;
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Logs how many units are at each LOD */
+	void LogStats() const;
+
+protected:
+
+	/** Returns the local player's strategy pawn, if any */
+	AStrategyPawn* GetViewPawn() const;
+
+	/** Puts every unit back at full fidelity */
+	void RestoreFullFidelity();
+};
@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "StrategyUnitRegistry.h"
+#include "StrategyUnit.h"
+
+bool UStrategyUnitRegistry::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UStrategyUnitRegistry::Deinitialize()
+{
+	Units.Empty();
+	SelectedBits.Empty();
+	ScratchBits.Empty();
+	UnitGrid.Reset();
+
+	Super::Deinitialize();
+}
+
+void UStrategyUnitRegistry::RegisterUnit(AStrategyUnit* Unit)
+{
+	// ignore invalid or already registered units
+	if (!IsValid(Unit) || Unit->RegistryIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	Unit->RegistryIndex = Units.Add(Unit);
+	SelectedBits.Add(false);
+
+	// force a rebuild so the new unit shows up in this frame's queries
+	GridBuildFrame = MAX_uint64;
+}
+
+void UStrategyUnitRegistry::UnregisterUnit(AStrategyUnit* Unit)
+{
+	if (!Unit || !Units.IsValidIndex(Unit->RegistryIndex) || Units[Unit->RegistryIndex] != Unit)
+	{
+		return;
+	}
+
+	const int32 Index = Unit->RegistryIndex;
+	Unit->RegistryIndex = INDEX_NONE;
+
+	Units.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	// mirror the swap on the selection bits
+	const int32 LastIndex = SelectedBits.Num() - 1;
+	SelectedBits[Index] = SelectedBits[LastIndex];
+	SelectedBits.RemoveAt(LastIndex);
+
+	// fix up the index of the unit that was swapped into this slot
+	if (Units.IsValidIndex(Index))
+	{
+		Units[Index]->RegistryIndex = Index;
+	}
+
+	GridBuildFrame = MAX_uint64;
+}
+
+void UStrategyUnitRegistry::GetUnitsInFootprint(TConstArrayView<FVector2D> Footprint, TArray<AStrategyUnit*>& OutUnits)
+{
+	if (Footprint.Num() < 3 || Units.Num() == 0)
+	{
+		return;
+	}
+
+	UpdateGrid();
+
+	// the grid is queried with the footprint bounds, then each candidate is tested against the edges
+	const FBox2D Bounds(Footprint.GetData(), Footprint.Num());
+
+	UnitGrid.ForEachInBox(Bounds, [&](int32 Index, const FVector2D& Location)
+	{
+		bool bHasPositive = false;
+		bool bHasNegative = false;
+
+		for (int32 i = 0; i < Footprint.Num(); ++i)
+		{
+			const FVector2D& A = Footprint[i];
+			const FVector2D& B = Footprint[(i + 1) % Footprint.Num()];
+
+			const double Side = FVector2D::CrossProduct(B - A, Location - A);
+			bHasPositive |= Side > 0.0;
+			bHasNegative |= Side < 0.0;
+		}
+
+		// inside a convex polygon, the point is on the same side of every edge
+		if (!(bHasPositive && bHasNegative))
+		{
+			OutUnits.Add(Units[Index]);
+		}
+	});
+}
+
+bool UStrategyUnitRegistry::IsSelected(const AStrategyUnit* Unit) const
+{
+	return Unit && SelectedBits.IsValidIndex(Unit->RegistryIndex) && SelectedBits[Unit->RegistryIndex];
+}
+
+void UStrategyUnitRegistry::SetSelected(AStrategyUnit* Unit, bool bSelected)
+{
+	if (Unit && SelectedBits.IsValidIndex(Unit->RegistryIndex))
+	{
+		SelectedBits[Unit->RegistryIndex] = bSelected;
+	}
+}
+
+void UStrategyUnitRegistry::SetSelection(const TArray<AStrategyUnit*>& NewUnits, TArray<AStrategyUnit*>& OutSelected, TArray<AStrategyUnit*>& OutDeselected)
+{
+	// flag the new selection
+	ScratchBits.Init(false, Units.Num());
+
+	for (const AStrategyUnit* Unit : NewUnits)
+	{
+		if (Unit && ScratchBits.IsValidIndex(Unit->RegistryIndex))
+		{
+			ScratchBits[Unit->RegistryIndex] = true;
+		}
+	}
+
+	// report the bits that flipped in either direction
+	for (TConstSetBitIterator<> It(SelectedBits); It; ++It)
+	{
+		if (!ScratchBits[It.GetIndex()])
+		{
+			OutDeselected.Add(Units[It.GetIndex()]);
+		}
+	}
+
+	for (TConstSetBitIterator<> It(ScratchBits); It; ++It)
+	{
+		if (!SelectedBits[It.GetIndex()])
+		{
+			OutSelected.Add(Units[It.GetIndex()]);
+		}
+	}
+
+	Swap(SelectedBits, ScratchBits);
+}
+
+void UStrategyUnitRegistry::SelectRecentlyRendered(float Tolerance, TArray<AStrategyUnit*>& OutSelected)
+{
+	for (int32 i = 0; i < Units.Num(); ++i)
+	{
+		if (!SelectedBits[i] && Units[i]->WasRecentlyRendered(Tolerance))
+		{
+			SelectedBits[i] = true;
+			OutSelected.Add(Units[i]);
+		}
+	}
+}
+
+void UStrategyUnitRegistry::ClearSelection()
+{
+	SelectedBits.SetRange(0, SelectedBits.Num(), false);
+}
+
+void UStrategyUnitRegistry::UpdateGrid()
+{
+	if (GridBuildFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	GridBuildFrame = GFrameCounter;
+
+	UnitGrid.Reset();
+
+	for (int32 i = 0; i < Units.Num(); ++i)
+	{
+		UnitGrid.Add(i, Units[i]->GetActorLocation());
+	}
+
+	UnitGrid.Build();
+}
@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UniformGrid2D.h"
+#include "StrategyUnitRegistry.generated.h"
+
+class AStrategyUnit;
+
+/**
+ *  Keeps track of every live strategy unit
+ *  Units join at BeginPlay and leave at EndPlay. Their positions are bucketed into a uniform
+ *  2D grid on demand (at most once per frame) so area queries like drag selection only touch
+ *  the units near the queried footprint instead of every actor in the level.
+ *  The local player's selection is a bitset parallel to the unit list, so membership tests and
+ *  select/deselect all are linear passes over bits rather than searches through actor lists.
+ */
+UCLASS()
+class UStrategyUnitRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Dense list of registered units. Each unit caches its own index for O(1) removal */
+	UPROPERTY()
+	TArray<TObjectPtr<AStrategyUnit>> Units;
+
+	/** Selection flag per unit, parallel to Units */
+	TBitArray<> SelectedBits;
+
+	/** Scratch bitset for selection updates, kept around so we don't reallocate */
+	TBitArray<> ScratchBits;
+
+	/** Unit positions, indexed by the unit's registry index */
+	FUniformGrid2D UnitGrid { 500.0f };
+
+	/** Frame the grid was last rebuilt on */
+	uint64 GridBuildFrame = MAX_uint64;
+
+public:
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	/** Adds a unit to the registry */
+	void RegisterUnit(AStrategyUnit* Unit);
+
+	/** Removes a unit from the registry */
+	void UnregisterUnit(AStrategyUnit* Unit);
+
+	/** Returns the number of registered units */
+	int32 GetNumUnits() const { return Units.Num(); }
+
+	/** Returns every registered unit */
+	TConstArrayView<TObjectPtr<AStrategyUnit>> GetUnits() const { return Units; }
+
+	/**
+	 *  Adds every unit whose location falls inside a convex XY footprint to the output list
+	 *  @param Footprint	corners of the convex footprint, in either winding order
+	 *  @param OutUnits		list the found units are appended to
+	 */
+	void GetUnitsInFootprint(TConstArrayView<FVector2D> Footprint, TArray<AStrategyUnit*>& OutUnits);
+
+	/** Returns true if the unit is part of the current selection */
+	bool IsSelected(const AStrategyUnit* Unit) const;
+
+	/** Adds or removes a single unit from the current selection */
+	void SetSelected(AStrategyUnit* Unit, bool bSelected);
+
+	/**
+	 *  Replaces the current selection with the given units
+	 *  @param NewUnits		the new selection
+	 *  @param OutSelected		units that were not selected before
+	 *  @param OutDeselected	units that are no longer selected
+	 */
+	void SetSelection(const TArray<AStrategyUnit*>& NewUnits, TArray<AStrategyUnit*>& OutSelected, TArray<AStrategyUnit*>& OutDeselected);
+
+	/**
+	 *  Adds every unit rendered within the tolerance to the current selection
+	 *  @param Tolerance		how recently the unit must have been rendered, in seconds
+	 *  @param OutSelected		units that were not selected before
+	 */
+	void SelectRecentlyRendered(float Tolerance, TArray<AStrategyUnit*>& OutSelected);
+
+	/** Clears the current selection */
+	void ClearSelection();
+
+	/** Calls Visit(Unit) for every selected unit */
+	template<typename FuncType>
+	void ForEachSelectedUnit(FuncType&& Visit) const
+	{
+		for (TConstSetBitIterator<> It(SelectedBits); It; ++It)
+		{
+			Visit(Units[It.GetIndex()].Get());
+		}
+	}
+
+protected:
+
+	/** Rebuilds the position grid if it hasn't been built yet this frame */
+	void UpdateGrid();
+};
@@ -5,14 +5,15 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "TwinStickCharacter.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "CrowdAvoidanceMovementComponent.h"
 #include "TwinStickGameMode.h"
 #include "TwinStickPickup.h"
 #include "Engine/World.h"
 #include "TwinStickNPCDestruction.h"
 #include "TimerManager.h"
 
-ATwinStickNPC::ATwinStickNPC()
+ATwinStickNPC::ATwinStickNPC(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UCrowdAvoidanceMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -32,7 +33,7 @@ ATwinStickNPC::ATwinStickNPC()
 	GetCharacterMovement()->MaxWalkSpeedCrouched = 100.0f;
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 640.0f, 0.0f);
 	GetCharacterMovement()->bOrientRotationToMovement = true;
-	GetCharacterMovement()->bUseRVOAvoidance = true;
+	// local avoidance is solved for the whole crowd by the crowd avoidance subsystem
 	GetCharacterMovement()->AvoidanceConsiderationRadius = 250.0f;
 	GetCharacterMovement()->AvoidanceWeight = 1.0f;
 	GetCharacterMovement()->bConstrainToPlane = true;
@@ -53,7 +53,7 @@ public:
 public:
 
 	/** Constructor */
-	ATwinStickNPC();
+	ATwinStickNPC(const FObjectInitializer& ObjectInitializer);
 
 protected:
 